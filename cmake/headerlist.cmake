@@ -19,17 +19,26 @@ set(headers
     src/Config/Slots.h
     src/Config/EquipSlots.h
     src/Config/SpellType.h
+    src/Diagnostics/Latency.h
+    src/Diagnostics/FlightRecorder.h
+    src/Diagnostics/Trace.h
     src/Persistence/SpellSettingsDB.h
     src/Persistence/SaveSpellDB.h
     src/Input/Input.h
+    src/Input/Chordmachine.h
+    src/Input/Chordtiming.h
     src/Input/Eventfilter.h
     src/Input/Exclusivepending.h
     src/Input/Hotkeycache.h
     src/Input/Hudtoggle.h
     src/Input/Inputinternal.h
     src/Input/Inputstate.h
+    src/Input/Inputtrace.h
+    src/Input/Inputtraceformat.h
+    src/Input/Osevents.h
     src/Input/Replaysystem.h
     src/State/State.h
+    src/State/HandMachine.h
     src/State/Action.h
     src/State/AnimListener.h
     src/State/CastGuardEvents.h
@@ -37,5 +46,8 @@ set(headers
     src/State/SyntheticInput.h
     src/State/Assign.h
     src/State/Spellclassify.h
+    src/State/FormTraits.h
     src/State/Equipsink.h
+    src/State/MenuState.h
+    src/State/Timers.h
 )
\ No newline at end of file
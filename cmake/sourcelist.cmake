@@ -12,24 +12,35 @@ set(sources
     src/Config/Config.cpp
     src/Config/Slots.cpp
     src/Config/SpellType.cpp
+    src/Diagnostics/Latency.cpp
+    src/Diagnostics/FlightRecorder.cpp
+    src/Diagnostics/FlightDecode.cpp
+    src/Diagnostics/Trace.cpp
     src/Persistence/SpellSettingsDB.cpp
     src/Persistence/SaveSpellDB.cpp
     src/Input/Input.cpp
+    src/Input/Chordmachine.cpp
+    src/Input/Chordtiming.cpp
     src/Input/Eventfilter.cpp
     src/Input/Exclusivepending.cpp
     src/Input/Hotkeycache.cpp
     src/Input/Hudtoggle.cpp
     src/Input/Inputstate.cpp
+    src/Input/Inputtrace.cpp
+    src/Input/Osevents.cpp
     src/Input/Replaysystem.cpp
     src/State/Action.cpp
     src/State/AnimListener.cpp
     src/State/InventoryUtil.cpp
+    src/State/FormTraits.cpp
     src/State/SyntheticInput.cpp
     src/State/MagicStateLifecycle.cpp
     src/State/MagicStatePump.cpp
     src/State/MagicStateSlot.cpp
     src/State/Assign.cpp
     src/State/Equipsink.cpp
+    src/State/MenuState.cpp
+    src/State/Timers.cpp
     src/Detours/detours.cpp
     src/Detours/disasm.cpp
     src/Detours/disolx64.cpp
@@ -7,6 +7,7 @@
 #include <string>
 
 #include "ConfigPath.h"
+#include "Diagnostics/Trace.h"
 #include "PCH.h"
 
 using namespace std::string_literals;
@@ -61,6 +62,7 @@ namespace {
         out.GamepadButton1.store(_getInt(ini, sec, "GamepadButton1", -1), std::memory_order_relaxed);
         out.GamepadButton2.store(_getInt(ini, sec, "GamepadButton2", -1), std::memory_order_relaxed);
         out.GamepadButton3.store(_getInt(ini, sec, "GamepadButton3", -1), std::memory_order_relaxed);
+        out.Trigger.store(std::clamp(_getInt(ini, sec, "Trigger", 0), 0, 3), std::memory_order_relaxed);
     }
 
     void _saveInput(CSimpleIniA& ini, const char* sec, const IntegratedMagic::InputConfig& in) {
@@ -70,14 +72,13 @@ namespace {
         ini.SetLongValue(sec, "GamepadButton1", in.GamepadButton1.load(std::memory_order_relaxed));
         ini.SetLongValue(sec, "GamepadButton2", in.GamepadButton2.load(std::memory_order_relaxed));
         ini.SetLongValue(sec, "GamepadButton3", in.GamepadButton3.load(std::memory_order_relaxed));
+        ini.SetLongValue(sec, "Trigger", in.Trigger.load(std::memory_order_relaxed));
     }
 }
 
 namespace IntegratedMagic {
 
     MagicConfig::MagicConfig() {
-        for (auto& a : slotSpellFormIDLeft) a.store(0u, std::memory_order_relaxed);
-        for (auto& a : slotSpellFormIDRight) a.store(0u, std::memory_order_relaxed);
         using ST = SpellType;
         spellTypeDefaults[static_cast<int>(ST::Concentration)] = {ActivationMode::Hold, true};
         spellTypeDefaults[static_cast<int>(ST::Cast)] = {ActivationMode::Automatic, true};
@@ -102,6 +103,21 @@ namespace IntegratedMagic {
         return v;
     }
 
+    std::uint32_t MagicConfig::BankCount() const noexcept {
+        return std::clamp(bankCount.load(std::memory_order_relaxed), 1u, kMaxBanks);
+    }
+
+    std::uint32_t MagicConfig::ActiveBankIndex() const noexcept {
+        return static_cast<std::uint32_t>(&Bank() - banks.data());
+    }
+
+    bool MagicConfig::SetActiveBank(std::uint32_t index) noexcept {
+        if (index >= BankCount()) return false;
+        _activeBank.store(&banks[index], std::memory_order_release);
+        TouchSlots();
+        return true;
+    }
+
     void MagicConfig::Load() {
         CSimpleIniA ini;
         ini.SetUnicode();
@@ -128,10 +144,34 @@ namespace IntegratedMagic {
             _loadInput(ini, sec.c_str(), slotInput[i]);
         }
         _loadInput(ini, "HudPopup", hudPopupInput);
+        _loadInput(ini, "BankCycle", bankCycleInput);
+        bankCount.store(static_cast<std::uint32_t>(std::clamp(_getInt(ini, "Banks", "Count", 1), 1,
+                                                              static_cast<int>(kMaxBanks))),
+                        std::memory_order_relaxed);
+        for (std::uint32_t b = 0; b < kMaxBanks; ++b) {
+            const auto key = std::format("Name{}", b + 1);
+            banks[b].name = ini.GetValue("Banks", key.c_str(), "");
+        }
+        if (ActiveBankIndex() >= BankCount()) SetActiveBank(0);
+        TouchSlots();
         skipEquipAnimationPatch = _getBool(ini, "Patches", "SkipEquipAnimationPatch", false);
         skipEquipAnimationOnReturnPatch = _getBool(ini, "Patches", "SkipEquipAnimationOnReturn", false);
         requireExclusiveHotkeyPatch = _getBool(ini, "Patches", "RequireExclusiveHotkeyPatch", false);
         pressBothAtSamePatch = _getBool(ini, "Patches", "PressBothAtSamePatch", false);
+        speculativePreEquipPatch = _getBool(ini, "Patches", "SpeculativePreEquipPatch", false);
+        adaptiveInputWindowsPatch = _getBool(ini, "Patches", "AdaptiveInputWindowsPatch", false);
+        adaptiveWindowPercentile = std::clamp(_getInt(ini, "Patches", "AdaptiveWindowPercentile", 90), 50, 99);
+        recordInputTrace = _getBool(ini, "Debug", "RecordInputTrace", false);
+        traceCategories = 0;
+        for (std::size_t c = 0; c < Trace::kCategoryCount; ++c) {
+            const auto key = std::format("Trace{}", Trace::CategoryName(static_cast<Trace::Category>(c)));
+            if (_getBool(ini, "Debug", key.c_str(), false)) traceCategories |= 1u << c;
+        }
+        Trace::SetMask(traceCategories);
+        inputBlockedMenus = ini.GetValue("Menus", "InputBlocked", "");
+        hudSoftBlockedMenus = ini.GetValue("Menus", "HudSoftBlocked", "");
+        hudHardBlockedMenus = ini.GetValue("Menus", "HudHardBlocked", "");
+        castInterruptMenus = ini.GetValue("Menus", "CastInterrupt", "");
 
         modifierKeyboardPosition = std::clamp(_getInt(ini, "Modifier", "KeyboardPosition", 0), 0, 3);
         modifierGamepadPosition = std::clamp(_getInt(ini, "Modifier", "GamepadPosition", 0), 0, 3);
@@ -204,10 +244,24 @@ namespace IntegratedMagic {
             _saveInput(ini, sec.c_str(), slotInput[i]);
         }
         _saveInput(ini, "HudPopup", hudPopupInput);
+        _saveInput(ini, "BankCycle", bankCycleInput);
+        ini.SetLongValue("Banks", "Count", static_cast<long>(BankCount()));
+        for (std::uint32_t b = 0; b < BankCount(); ++b) {
+            const auto key = std::format("Name{}", b + 1);
+            ini.SetValue("Banks", key.c_str(), banks[b].name.c_str());
+        }
         ini.SetBoolValue("Patches", "SkipEquipAnimationPatch", skipEquipAnimationPatch);
         ini.SetBoolValue("Patches", "SkipEquipAnimationOnReturn", skipEquipAnimationOnReturnPatch);
         ini.SetBoolValue("Patches", "RequireExclusiveHotkeyPatch", requireExclusiveHotkeyPatch);
         ini.SetBoolValue("Patches", "PressBothAtSamePatch", pressBothAtSamePatch);
+        ini.SetBoolValue("Patches", "SpeculativePreEquipPatch", speculativePreEquipPatch);
+        ini.SetBoolValue("Patches", "AdaptiveInputWindowsPatch", adaptiveInputWindowsPatch);
+        ini.SetLongValue("Patches", "AdaptiveWindowPercentile", adaptiveWindowPercentile);
+        ini.SetBoolValue("Debug", "RecordInputTrace", recordInputTrace);
+        for (std::size_t c = 0; c < Trace::kCategoryCount; ++c) {
+            const auto key = std::format("Trace{}", Trace::CategoryName(static_cast<Trace::Category>(c)));
+            ini.SetBoolValue("Debug", key.c_str(), (traceCategories >> c) & 1u);
+        }
         ini.SetLongValue("Modifier", "KeyboardPosition", modifierKeyboardPosition);
         ini.SetLongValue("Modifier", "GamepadPosition", modifierGamepadPosition);
 
@@ -4,12 +4,15 @@
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <string>
 
 #include "Persistence/SpellSettingsDB.h"
 #include "SpellType.h"
 
 namespace IntegratedMagic {
 
+    enum class HotkeyTrigger : std::uint8_t { Chord = 0, Sequence = 1, DoubleTap = 2, Hold = 3 };
+
     struct InputConfig {
         std::atomic<int> KeyboardScanCode1{-1};
         std::atomic<int> KeyboardScanCode2{-1};
@@ -17,6 +20,7 @@ namespace IntegratedMagic {
         std::atomic<int> GamepadButton1{-1};
         std::atomic<int> GamepadButton2{-1};
         std::atomic<int> GamepadButton3{-1};
+        std::atomic<int> Trigger{0};
     };
 
     struct SpellTypeDefaults {
@@ -32,27 +36,61 @@ namespace IntegratedMagic {
         Always = 1 << 3,
     };
 
-    struct MagicConfig {
+    struct SlotBank {
         static constexpr std::uint32_t kMaxSlots = 64;
+        std::array<std::atomic<std::uint32_t>, kMaxSlots> spellLeft{};
+        std::array<std::atomic<std::uint32_t>, kMaxSlots> spellRight{};
+        std::array<std::atomic<std::uint32_t>, kMaxSlots> shout{};
+        std::string name;
+
+        void Clear(std::size_t slot) noexcept {
+            spellLeft[slot].store(0u, std::memory_order_relaxed);
+            spellRight[slot].store(0u, std::memory_order_relaxed);
+            shout[slot].store(0u, std::memory_order_relaxed);
+        }
+    };
+
+    struct MagicConfig {
+        static constexpr std::uint32_t kMaxSlots = SlotBank::kMaxSlots;
+        static constexpr std::uint32_t kMaxBanks = 8;
         std::atomic<std::uint32_t> slotCount{4};
-        std::array<std::atomic<std::uint32_t>, kMaxSlots> slotSpellFormIDLeft;
-        std::array<std::atomic<std::uint32_t>, kMaxSlots> slotSpellFormIDRight;
-        std::array<std::atomic<std::uint32_t>, kMaxSlots> slotShoutFormID;
+        std::atomic<std::uint32_t> bankCount{1};
+        std::array<SlotBank, kMaxBanks> banks;
         std::array<InputConfig, kMaxSlots> slotInput;
         InputConfig hudPopupInput;
+        InputConfig bankCycleInput;
         std::array<SpellTypeDefaults, static_cast<std::size_t>(SpellType::Shout) + 1> spellTypeDefaults{};
         std::uint8_t hudVisibilityFlags{static_cast<std::uint8_t>(HudVisibilityFlag::Always)};
         bool skipEquipAnimationPatch = false;
         bool skipEquipAnimationOnReturnPatch = false;
         bool requireExclusiveHotkeyPatch = false;
         bool pressBothAtSamePatch = false;
+        bool speculativePreEquipPatch = false;
+        bool adaptiveInputWindowsPatch = false;
+        bool recordInputTrace = false;
+        std::uint32_t traceCategories{0};
+
+        std::string inputBlockedMenus;
+        std::string hudSoftBlockedMenus;
+        std::string hudHardBlockedMenus;
+        std::string castInterruptMenus;
 
         int modifierKeyboardPosition{0};
         int modifierGamepadPosition{0};
+        int adaptiveWindowPercentile{90};
         MagicConfig();
         void Load();
         void Save() const;
         std::uint32_t SlotCount() const noexcept;
+        std::uint32_t BankCount() const noexcept;
+
+        SlotBank& Bank() noexcept { return *_activeBank.load(std::memory_order_acquire); }
+        const SlotBank& Bank() const noexcept { return *_activeBank.load(std::memory_order_acquire); }
+        std::uint32_t ActiveBankIndex() const noexcept;
+        bool SetActiveBank(std::uint32_t index) noexcept;
+
+        std::uint32_t SlotVersion() const noexcept { return _slotVersion.load(std::memory_order_acquire); }
+        void TouchSlots() noexcept { _slotVersion.fetch_add(1, std::memory_order_release); }
 
         bool HudFlagSet(HudVisibilityFlag f) const noexcept {
             return (hudVisibilityFlags & static_cast<std::uint8_t>(f)) != 0;
@@ -60,6 +98,8 @@ namespace IntegratedMagic {
 
     private:
         static std::filesystem::path IniPath();
+        std::atomic<SlotBank*> _activeBank{&banks[0]};
+        std::atomic<std::uint32_t> _slotVersion{0};
     };
 
     MagicConfig& GetMagicConfig();
@@ -1,13 +1,15 @@
 #include "Slots.h"
 
 #include "Config.h"
+#include "Diagnostics/Trace.h"
 #include "PCH.h"
 #include "Persistence/SpellSettingsDB.h"
+#include "State/State.h"
 
 namespace IntegratedMagic::Slots {
     namespace {
-        inline auto& SlotArrForHand(MagicConfig& cfg, Hand hand) {
-            return (hand == Hand::Left) ? cfg.slotSpellFormIDLeft : cfg.slotSpellFormIDRight;
+        inline auto& SlotArrForHand(SlotBank& bank, Hand hand) {
+            return (hand == Hand::Left) ? bank.spellLeft : bank.spellRight;
         }
     }
     std::uint32_t GetSlotCount() { return IntegratedMagic::GetMagicConfig().SlotCount(); }
@@ -25,7 +27,7 @@ namespace IntegratedMagic::Slots {
         if (const auto n = cfg.SlotCount(); slot < 0 || static_cast<std::uint32_t>(slot) >= n) {
             return 0u;
         }
-        auto& arr = SlotArrForHand(cfg, hand);
+        auto& arr = SlotArrForHand(cfg.Bank(), hand);
         return arr[static_cast<std::size_t>(slot)].load(std::memory_order_relaxed);
     }
 
@@ -34,13 +36,14 @@ namespace IntegratedMagic::Slots {
         if (const auto n = cfg.SlotCount(); slot < 0 || static_cast<std::uint32_t>(slot) >= n) {
             return;
         }
-        auto& arr = SlotArrForHand(cfg, hand);
+        auto& arr = SlotArrForHand(cfg.Bank(), hand);
         arr[static_cast<std::size_t>(slot)].store(spellFormID, std::memory_order_relaxed);
         if (spellFormID != 0u) {
-            cfg.slotShoutFormID[static_cast<std::size_t>(slot)].store(0u, std::memory_order_relaxed);
+            cfg.Bank().shout[static_cast<std::size_t>(slot)].store(0u, std::memory_order_relaxed);
             auto* form = RE::TESForm::LookupByID(spellFormID);
             (void)IntegratedMagic::SpellSettingsDB::Get().GetOrCreate(spellFormID, form);
         }
+        cfg.TouchSlots();
         if (saveNow) {
             cfg.Save();
             if (IntegratedMagic::SpellSettingsDB::Get().IsDirty()) {
@@ -53,7 +56,7 @@ namespace IntegratedMagic::Slots {
     std::uint32_t GetSlotShout(int slot) {
         auto& cfg = IntegratedMagic::GetMagicConfig();
         if (slot < 0 || static_cast<std::uint32_t>(slot) >= cfg.SlotCount()) return 0u;
-        return cfg.slotShoutFormID[static_cast<std::size_t>(slot)].load(std::memory_order_relaxed);
+        return cfg.Bank().shout[static_cast<std::size_t>(slot)].load(std::memory_order_relaxed);
     }
 
     void SetSlotShout(int slot, std::uint32_t shoutFormID, bool saveNow) {
@@ -61,17 +64,19 @@ namespace IntegratedMagic::Slots {
         if (slot < 0 || static_cast<std::uint32_t>(slot) >= cfg.SlotCount()) return;
 
         const auto idx = static_cast<std::size_t>(slot);
-        cfg.slotShoutFormID[idx].store(shoutFormID, std::memory_order_relaxed);
+        auto& bank = cfg.Bank();
+        bank.shout[idx].store(shoutFormID, std::memory_order_relaxed);
 
         if (shoutFormID != 0u) {
-            cfg.slotSpellFormIDLeft[idx].store(0u, std::memory_order_relaxed);
-            cfg.slotSpellFormIDRight[idx].store(0u, std::memory_order_relaxed);
+            bank.spellLeft[idx].store(0u, std::memory_order_relaxed);
+            bank.spellRight[idx].store(0u, std::memory_order_relaxed);
         }
 
         if (shoutFormID != 0u) {
             auto* form = RE::TESForm::LookupByID(shoutFormID);
             (void)IntegratedMagic::SpellSettingsDB::Get().GetOrCreate(shoutFormID, form);
         }
+        cfg.TouchSlots();
         if (saveNow) {
             cfg.Save();
             if (IntegratedMagic::SpellSettingsDB::Get().IsDirty()) {
@@ -82,4 +87,26 @@ namespace IntegratedMagic::Slots {
     }
 
     bool IsShoutSlot(int slot) { return GetSlotShout(slot) != 0u; }
+
+    std::uint32_t GetBankCount() { return IntegratedMagic::GetMagicConfig().BankCount(); }
+
+    std::uint32_t GetActiveBank() { return IntegratedMagic::GetMagicConfig().ActiveBankIndex(); }
+
+    bool SetActiveBank(std::uint32_t bank) {
+        auto& cfg = IntegratedMagic::GetMagicConfig();
+        if (bank == cfg.ActiveBankIndex()) return true;
+        if (IntegratedMagic::MagicState::Get().IsActive()) {
+            IM_TRACE(State, "[Slots] SetActiveBank: bank={} ignored while a slot is active", bank);
+            return false;
+        }
+        if (!cfg.SetActiveBank(bank)) return false;
+        IM_TRACE(State, "[Slots] SetActiveBank: bank={}", bank);
+        return true;
+    }
+
+    void CycleBank(int step) {
+        const auto n = static_cast<int>(GetBankCount());
+        const int next = ((static_cast<int>(GetActiveBank()) + step) % n + n) % n;
+        (void)SetActiveBank(static_cast<std::uint32_t>(next));
+    }
 }
\ No newline at end of file
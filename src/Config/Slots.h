@@ -10,4 +10,8 @@ namespace IntegratedMagic::Slots {
     std::uint32_t GetSlotShout(int slot);
     void SetSlotShout(int slot, std::uint32_t shoutFormID, bool saveNow);
     bool IsShoutSlot(int slot);
+    std::uint32_t GetBankCount();
+    std::uint32_t GetActiveBank();
+    bool SetActiveBank(std::uint32_t bank);
+    void CycleBank(int step);
 }
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <string>
+
+#include "FlightRecorder.h"
+#include "State/HandMachine.h"
+
+namespace IntegratedMagic::FlightRecorder {
+    namespace {
+        constexpr std::array<const char*, kEventCount> kEventNames{
+            "SlotEdge",   "PendingArm", "PendingClear",  "SlotPressed", "EnterHand", "HandPhase", "EnableBumper",
+            "BeginCast",  "CastStop",   "CastInterrupt", "SpellFire",   "ShoutStop", "Exit",      "ForceExit",
+            "ActiveTimeout"};
+
+        template <class T>
+        bool Get(std::ifstream& f, T& v) {
+            return static_cast<bool>(f.read(reinterpret_cast<char*>(&v), sizeof(T)));
+        }
+
+        const char* HandName(std::uint8_t hand) {
+            switch (hand) {
+                case 0:
+                    return "L";
+                case 1:
+                    return "R";
+                default:
+                    return "-";
+            }
+        }
+
+        const char* PhaseName(std::uint32_t p) {
+            return p < HandMachine::kPhaseCount ? HandMachine::PhaseName(static_cast<HandPhase>(p)) : "?";
+        }
+
+        std::string Details(const Entry& e) {
+            using enum Event;
+            switch (e.event) {
+                case SlotEdge:
+                    return std::format("{} kb={} gp={}", e.a ? "pressed" : "released", e.b & 1u, (e.b >> 1) & 1u);
+                case PendingArm:
+                    return std::format("src={} window={}ms", e.a == 1 ? "kb" : e.a == 2 ? "gp" : "none", e.b);
+                case PendingClear: {
+                    constexpr std::array<const char*, 3> kReasons{"Success", "Timeout", "Cancelled"};
+                    return std::format("reason={}", e.a < kReasons.size() ? kReasons[e.a] : "?");
+                }
+                case EnterHand: {
+                    constexpr std::array<const char*, 3> kModes{"Hold", "Press", "Automatic"};
+                    return std::format("mode={} phase={}", e.a < kModes.size() ? kModes[e.a] : "?", PhaseName(e.b));
+                }
+                case HandPhase: {
+                    const auto ev = (e.b >> 8) & 0xFFu;
+                    return std::format("{} --{}--> {}", PhaseName(e.a),
+                                       ev < HandMachine::kEventCount
+                                           ? HandMachine::EventName(static_cast<HandEvent>(ev))
+                                           : "?",
+                                       PhaseName(e.b & 0xFFu));
+                }
+                case ActiveTimeout:
+                    return std::format("after={}s", e.b);
+                default:
+                    return {};
+            }
+        }
+    }
+
+    const char* EventName(Event event) {
+        const auto i = static_cast<std::size_t>(event);
+        return i < kEventNames.size() ? kEventNames[i] : "?";
+    }
+
+    bool Decode(const std::filesystem::path& dump, const std::filesystem::path& timeline) {
+        std::ifstream in(dump, std::ios::binary);
+        if (!in) return false;
+
+        std::array<char, 4> magic{};
+        std::uint16_t version = 0;
+        std::uint8_t reasonLen = 0;
+        if (!in.read(magic.data(), magic.size()) || !std::equal(magic.begin(), magic.end(), kDumpMagic) ||
+            !Get(in, version) || version != kDumpVersion || !Get(in, reasonLen))
+            return false;
+        std::string reason(reasonLen, '\0');
+        std::uint64_t dumpNs = 0;
+        std::int64_t dumpWallNs = 0;
+        std::uint32_t count = 0;
+        if (!in.read(reason.data(), reasonLen) || !Get(in, dumpNs) || !Get(in, dumpWallNs) || !Get(in, count))
+            return false;
+
+        std::ofstream out(timeline, std::ios::trunc);
+        if (!out) return false;
+        out << std::format("# reason={} records={} wall={}\n", reason, count,
+                           std::chrono::sys_time<std::chrono::nanoseconds>{std::chrono::nanoseconds{dumpWallNs}});
+        out << "# t_ms is relative to the dump; negative values are before it\n";
+        out << "t_ms,event,slot,hand,details\n";
+
+        for (std::uint32_t i = 0; i < count; ++i) {
+            Entry e{};
+            if (!Get(in, e.tsNs) || !Get(in, e.event) || !Get(in, e.slot) || !Get(in, e.hand) || !Get(in, e.a) ||
+                !Get(in, e.b))
+                return false;
+            const auto rel = static_cast<double>(static_cast<std::int64_t>(e.tsNs - dumpNs)) / 1e6;
+            out << std::format("{:.3f},{},{},{},{}\n", rel, EventName(e.event), e.slot, HandName(e.hand), Details(e));
+        }
+        return static_cast<bool>(out);
+    }
+}
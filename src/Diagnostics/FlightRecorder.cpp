@@ -0,0 +1,137 @@
+#include "FlightRecorder.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Config/ConfigPath.h"
+#include "PCH.h"
+#include "Trace.h"
+
+namespace IntegratedMagic::FlightRecorder {
+    namespace {
+        static_assert((kCapacity & (kCapacity - 1)) == 0);
+
+        struct Cell {
+            std::atomic<std::uint64_t> seq{0};
+            std::atomic<std::uint64_t> tsNs{0};
+            std::atomic<std::uint64_t> packed{0};
+        };
+
+        std::array<Cell, kCapacity> g_ring{};
+        std::atomic<std::uint64_t> g_head{0};
+        std::atomic<bool> g_writing{false};
+
+        std::uint64_t NowNs() noexcept {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                  std::chrono::steady_clock::now().time_since_epoch())
+                                                  .count());
+        }
+
+        constexpr std::uint64_t Pack(Event event, int slot, std::uint8_t hand, std::uint8_t a,
+                                     std::uint32_t b) noexcept {
+            return static_cast<std::uint64_t>(std::to_underlying(event)) |
+                   (static_cast<std::uint64_t>(static_cast<std::uint8_t>(static_cast<std::int8_t>(slot))) << 8) |
+                   (static_cast<std::uint64_t>(hand) << 16) | (static_cast<std::uint64_t>(a) << 24) |
+                   (static_cast<std::uint64_t>(b) << 32);
+        }
+
+        constexpr Entry Unpack(std::uint64_t tsNs, std::uint64_t packed) noexcept {
+            return Entry{.tsNs = tsNs,
+                         .event = static_cast<Event>(packed & 0xFF),
+                         .slot = static_cast<std::int8_t>((packed >> 8) & 0xFF),
+                         .hand = static_cast<std::uint8_t>((packed >> 16) & 0xFF),
+                         .a = static_cast<std::uint8_t>((packed >> 24) & 0xFF),
+                         .b = static_cast<std::uint32_t>(packed >> 32)};
+        }
+
+        std::vector<Entry> Snapshot() {
+            const auto head = g_head.load(std::memory_order_acquire);
+            const auto first = head > kCapacity ? head - kCapacity : 0;
+            std::vector<Entry> out;
+            out.reserve(static_cast<std::size_t>(head - first));
+            for (auto i = first; i < head; ++i) {
+                const auto& cell = g_ring[static_cast<std::size_t>(i & (kCapacity - 1))];
+                const auto s1 = cell.seq.load(std::memory_order_acquire);
+                const auto ts = cell.tsNs.load(std::memory_order_relaxed);
+                const auto packed = cell.packed.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (s1 != i + 1 || cell.seq.load(std::memory_order_relaxed) != s1) continue;
+                out.push_back(Unpack(ts, packed));
+            }
+            return out;
+        }
+
+        template <class T>
+        void Put(std::ofstream& f, const T& v) {
+            f.write(reinterpret_cast<const char*>(&v), sizeof(T));
+        }
+
+        bool WriteDump(const std::filesystem::path& path, const std::string& reason, std::uint64_t dumpNs,
+                       std::int64_t dumpWallNs, const std::vector<Entry>& entries) {
+            std::ofstream f(path, std::ios::binary | std::ios::trunc);
+            if (!f) return false;
+            f.write(kDumpMagic, sizeof(kDumpMagic));
+            Put(f, kDumpVersion);
+            const auto len = static_cast<std::uint8_t>(std::min<std::size_t>(reason.size(), 0xFF));
+            Put(f, len);
+            f.write(reason.data(), len);
+            Put(f, dumpNs);
+            Put(f, dumpWallNs);
+            Put(f, static_cast<std::uint32_t>(entries.size()));
+            for (const auto& e : entries) {
+                Put(f, e.tsNs);
+                Put(f, e.event);
+                Put(f, e.slot);
+                Put(f, e.hand);
+                Put(f, e.a);
+                Put(f, e.b);
+            }
+            return static_cast<bool>(f);
+        }
+    }
+
+    void Record(Event event, int slot, std::uint8_t hand, std::uint8_t a, std::uint32_t b) noexcept {
+        const auto i = g_head.fetch_add(1, std::memory_order_relaxed);
+        auto& cell = g_ring[static_cast<std::size_t>(i & (kCapacity - 1))];
+        cell.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        cell.tsNs.store(NowNs(), std::memory_order_relaxed);
+        cell.packed.store(Pack(event, slot, hand, a, b), std::memory_order_relaxed);
+        cell.seq.store(i + 1, std::memory_order_release);
+    }
+
+    std::filesystem::path DumpPath() { return GetThisDllDir() / "IntegratedMagic_FlightRecorder.bin"; }
+
+    bool Dump(const char* reason) {
+        if (g_writing.exchange(true, std::memory_order_acq_rel)) {
+            IM_TRACE(State, "[FlightRecorder] Dump: previous dump still writing, skipping reason={}", reason);
+            return false;
+        }
+        auto entries = Snapshot();
+        const auto dumpNs = NowNs();
+        const auto dumpWallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::system_clock::now().time_since_epoch())
+                                    .count();
+        std::thread([entries = std::move(entries), why = std::string(reason), dumpNs, dumpWallNs]() {
+            const auto bin = DumpPath();
+            auto txt = bin;
+            txt.replace_extension(".txt");
+            if (!WriteDump(bin, why, dumpNs, dumpWallNs, entries)) {
+                spdlog::warn("[FlightRecorder] Dump: failed to write {}", bin.string());
+            } else if (!Decode(bin, txt)) {
+                spdlog::warn("[FlightRecorder] Dump: failed to decode {}", bin.string());
+            } else {
+                spdlog::info("[FlightRecorder] Dump: reason={} records={} -> {}", why, entries.size(), txt.string());
+            }
+            g_writing.store(false, std::memory_order_release);
+        }).detach();
+        return true;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace IntegratedMagic::FlightRecorder {
+
+    enum class Event : std::uint8_t {
+        SlotEdge = 0,
+        PendingArm,
+        PendingClear,
+        SlotPressed,
+        EnterHand,
+        HandPhase,
+        EnableBumper,
+        BeginCast,
+        CastStop,
+        CastInterrupt,
+        SpellFire,
+        ShoutStop,
+        Exit,
+        ForceExit,
+        ActiveTimeout,
+        kCount
+    };
+
+    inline constexpr std::size_t kEventCount = static_cast<std::size_t>(Event::kCount);
+    inline constexpr std::size_t kCapacity = 4096;
+    inline constexpr std::uint8_t kNoHand = 0xFF;
+
+    inline constexpr char kDumpMagic[4]{'I', 'M', 'F', 'R'};
+    inline constexpr std::uint16_t kDumpVersion = 1;
+
+    struct Entry {
+        std::uint64_t tsNs{0};
+        Event event{Event::SlotEdge};
+        std::int8_t slot{-1};
+        std::uint8_t hand{kNoHand};
+        std::uint8_t a{0};
+        std::uint32_t b{0};
+    };
+
+    void Record(Event event, int slot = -1, std::uint8_t hand = kNoHand, std::uint8_t a = 0,
+                std::uint32_t b = 0) noexcept;
+
+    [[nodiscard]] const char* EventName(Event event);
+
+    [[nodiscard]] std::filesystem::path DumpPath();
+    bool Dump(const char* reason);
+
+    bool Decode(const std::filesystem::path& dump, const std::filesystem::path& timeline);
+}
@@ -0,0 +1,168 @@
+#include "Latency.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <format>
+#include <fstream>
+
+#include "Config/ConfigPath.h"
+#include "PCH.h"
+
+namespace IntegratedMagic::Latency {
+    namespace {
+        using clock = std::chrono::steady_clock;
+
+        constexpr std::uint64_t kMaxSampleUs = 5'000'000;
+        constexpr std::int64_t kPressStaleNs = 1'000'000'000;
+
+        class Histogram {
+        public:
+            static constexpr int kSubBits = 3;
+            static constexpr int kSub = 1 << kSubBits;
+            static constexpr int kBuckets = kSub * 30;
+
+            void Record(std::uint64_t us) noexcept {
+                _buckets[static_cast<std::size_t>(IndexOf(us))].fetch_add(1, std::memory_order_relaxed);
+                _count.fetch_add(1, std::memory_order_relaxed);
+                _sumUs.fetch_add(us, std::memory_order_relaxed);
+                auto prev = _maxUs.load(std::memory_order_relaxed);
+                while (us > prev && !_maxUs.compare_exchange_weak(prev, us, std::memory_order_relaxed));
+            }
+
+            [[nodiscard]] StageSummary Summarize() const noexcept {
+                std::array<std::uint32_t, kBuckets> snap{};
+                std::uint64_t total = 0;
+                for (std::size_t i = 0; i < snap.size(); ++i) {
+                    snap[i] = _buckets[i].load(std::memory_order_relaxed);
+                    total += snap[i];
+                }
+                StageSummary out{};
+                out.count = total;
+                out.maxUs = _maxUs.load(std::memory_order_relaxed);
+                if (total == 0) return out;
+                out.meanUs = _sumUs.load(std::memory_order_relaxed) / _count.load(std::memory_order_relaxed);
+                out.p50Us = std::min(Percentile(snap, total, 0.50), out.maxUs);
+                out.p90Us = std::min(Percentile(snap, total, 0.90), out.maxUs);
+                out.p99Us = std::min(Percentile(snap, total, 0.99), out.maxUs);
+                return out;
+            }
+
+            void Reset() noexcept {
+                for (auto& b : _buckets) b.store(0, std::memory_order_relaxed);
+                _count.store(0, std::memory_order_relaxed);
+                _sumUs.store(0, std::memory_order_relaxed);
+                _maxUs.store(0, std::memory_order_relaxed);
+            }
+
+        private:
+            static int IndexOf(std::uint64_t us) noexcept {
+                if (us < kSub) return static_cast<int>(us);
+                const int m = std::bit_width(us) - 1;
+                const int sub = static_cast<int>((us >> (m - kSubBits)) & (kSub - 1));
+                const int idx = (m - kSubBits + 1) * kSub + sub;
+                return idx < kBuckets ? idx : kBuckets - 1;
+            }
+
+            static std::uint64_t UpperBoundOf(int idx) noexcept {
+                if (idx < kSub) return static_cast<std::uint64_t>(idx);
+                const int m = idx / kSub + kSubBits - 1;
+                const auto sub = static_cast<std::uint64_t>(idx % kSub);
+                return ((kSub + sub + 1) << (m - kSubBits)) - 1;
+            }
+
+            static std::uint64_t Percentile(const std::array<std::uint32_t, kBuckets>& snap, std::uint64_t total,
+                                            double q) noexcept {
+                const auto target = static_cast<std::uint64_t>(static_cast<double>(total) * q + 0.5);
+                std::uint64_t seen = 0;
+                for (int i = 0; i < kBuckets; ++i) {
+                    seen += snap[static_cast<std::size_t>(i)];
+                    if (seen >= target && seen > 0) return UpperBoundOf(i);
+                }
+                return UpperBoundOf(kBuckets - 1);
+            }
+
+            std::array<std::atomic<std::uint32_t>, kBuckets> _buckets{};
+            std::atomic<std::uint64_t> _count{0};
+            std::atomic<std::uint64_t> _sumUs{0};
+            std::atomic<std::uint64_t> _maxUs{0};
+        };
+
+        std::array<Histogram, kStageCount> g_hist{};
+
+        std::atomic<std::int64_t> g_pollNs{0};
+        std::atomic<std::int64_t> g_keyDownNs{0};
+        std::atomic<std::uint32_t> g_recorded{0};
+
+        std::int64_t NowNs() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+        }
+
+        constexpr std::array<const char*, kStageCount> kStageNames{"Accepted",       "Dispatched", "Equipped",
+                                                                   "Attack flushed", "Begin cast", "Spell fire"};
+    }
+
+    void MarkPoll() { g_pollNs.store(NowNs(), std::memory_order_relaxed); }
+
+    void MarkKeyDown() {
+        const auto poll = g_pollNs.load(std::memory_order_relaxed);
+        const auto now = poll ? poll : NowNs();
+        const auto t0 = g_keyDownNs.load(std::memory_order_relaxed);
+        const auto acceptedBit = 1u << static_cast<unsigned>(Stage::Accepted);
+        const bool accepted = (g_recorded.load(std::memory_order_relaxed) & acceptedBit) != 0;
+        if (t0 != 0 && !accepted && now - t0 < kPressStaleNs) return;
+        g_keyDownNs.store(now, std::memory_order_relaxed);
+        g_recorded.store(0, std::memory_order_relaxed);
+    }
+
+    void Mark(Stage stage) {
+        const auto t0 = g_keyDownNs.load(std::memory_order_relaxed);
+        if (t0 == 0) return;
+
+        const auto bit = 1u << static_cast<unsigned>(stage);
+        const auto acceptedBit = 1u << static_cast<unsigned>(Stage::Accepted);
+        auto recorded = g_recorded.load(std::memory_order_relaxed);
+        if (recorded & bit) return;
+        if (stage != Stage::Accepted && !(recorded & acceptedBit)) return;
+        if (!g_recorded.compare_exchange_strong(recorded, recorded | bit, std::memory_order_relaxed)) return;
+
+        const auto deltaNs = NowNs() - t0;
+        if (deltaNs < 0) return;
+        const auto us = static_cast<std::uint64_t>(deltaNs / 1000);
+        if (us > kMaxSampleUs) return;
+        g_hist[static_cast<std::size_t>(stage)].Record(us);
+    }
+
+    const char* StageName(Stage stage) {
+        const auto i = static_cast<std::size_t>(stage);
+        return i < kStageNames.size() ? kStageNames[i] : "?";
+    }
+
+    StageSummary Summarize(Stage stage) { return g_hist[static_cast<std::size_t>(stage)].Summarize(); }
+
+    void Reset() {
+        for (auto& h : g_hist) h.Reset();
+        g_keyDownNs.store(0, std::memory_order_relaxed);
+        g_recorded.store(0, std::memory_order_relaxed);
+    }
+
+    bool DumpToFile() {
+        const auto path = GetThisDllDir() / "IntegratedMagic_Latency.txt";
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            spdlog::warn("[Latency] DumpToFile: failed to open {}", path.string());
+            return false;
+        }
+        out << "stage,count,mean_us,p50_us,p90_us,p99_us,max_us\n";
+        for (std::size_t i = 0; i < kStageCount; ++i) {
+            const auto stage = static_cast<Stage>(i);
+            const auto s = Summarize(stage);
+            out << std::format("{},{},{},{},{},{},{}\n", StageName(stage), s.count, s.meanUs, s.p50Us, s.p90Us,
+                               s.p99Us, s.maxUs);
+        }
+        spdlog::info("[Latency] DumpToFile: wrote {}", path.string());
+        return true;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace IntegratedMagic::Latency {
+
+    enum class Stage : std::uint8_t {
+        Accepted = 0,
+        Dispatched,
+        Equipped,
+        AttackFlushed,
+        BeginCast,
+        SpellFire,
+        kCount
+    };
+
+    inline constexpr std::size_t kStageCount = static_cast<std::size_t>(Stage::kCount);
+
+    struct StageSummary {
+        std::uint64_t count{0};
+        std::uint64_t meanUs{0};
+        std::uint64_t p50Us{0};
+        std::uint64_t p90Us{0};
+        std::uint64_t p99Us{0};
+        std::uint64_t maxUs{0};
+    };
+
+    void MarkPoll();
+    void MarkKeyDown();
+    void Mark(Stage stage);
+
+    [[nodiscard]] const char* StageName(Stage stage);
+    [[nodiscard]] StageSummary Summarize(Stage stage);
+
+    void Reset();
+    bool DumpToFile();
+}
@@ -0,0 +1,159 @@
+#include "Trace.h"
+
+#include <array>
+#include <mutex>
+#include <thread>
+
+#include "PCH.h"
+
+namespace IntegratedMagic::Trace {
+    namespace {
+        constexpr std::size_t kCapacity = 1024;
+        constexpr std::size_t kMask = kCapacity - 1;
+        static_assert((kCapacity & kMask) == 0, "Ring capacity must be a power of two.");
+
+        struct Cell {
+            std::atomic<std::size_t> seq{0};
+            detail::Record rec{};
+        };
+
+        class TraceRing {
+        public:
+            TraceRing() {
+                for (std::size_t i = 0; i < kCapacity; ++i) _cells[i].seq.store(i, std::memory_order_relaxed);
+            }
+
+            detail::Record* TryClaim() noexcept {
+                auto pos = _tail.load(std::memory_order_relaxed);
+                for (;;) {
+                    auto& cell = _cells[pos & kMask];
+                    const auto seq = cell.seq.load(std::memory_order_acquire);
+                    const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+                    if (diff == 0) {
+                        if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                            cell.rec.pos = pos;
+                            return &cell.rec;
+                        }
+                    } else if (diff < 0) {
+                        return nullptr;
+                    } else {
+                        pos = _tail.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            void Publish(detail::Record* rec) noexcept {
+                _cells[rec->pos & kMask].seq.store(rec->pos + 1, std::memory_order_release);
+            }
+
+            detail::Record* Peek() noexcept {
+                auto& cell = _cells[_head & kMask];
+                if (cell.seq.load(std::memory_order_acquire) != _head + 1) return nullptr;
+                return &cell.rec;
+            }
+
+            void Release() noexcept {
+                _cells[_head & kMask].seq.store(_head + kCapacity, std::memory_order_release);
+                ++_head;
+            }
+
+        private:
+            std::array<Cell, kCapacity> _cells{};
+            alignas(64) std::atomic<std::size_t> _tail{0};
+            alignas(64) std::size_t _head{0};
+        };
+
+        TraceRing& GetRing() {
+            static TraceRing r;
+            return r;
+        }
+
+        std::atomic<std::uint64_t> g_dropped{0};
+        std::atomic<std::uint32_t> g_published{0};
+        std::atomic<bool> g_loggerReady{false};
+
+        constexpr std::array<const char*, kCategoryCount> kCategoryNames{"Input", "Replay", "State",
+                                                                         "Anim",  "Equip",  "HUD"};
+
+        bool DrainOnce(std::string& line) {
+            auto& ring = GetRing();
+            bool any = false;
+            while (auto* rec = ring.Peek()) {
+                any = true;
+                if (!rec->format) {
+                    ring.Release();
+                    continue;
+                }
+                line.clear();
+                try {
+                    rec->format(rec->payload, line);
+                } catch (const std::exception& e) {
+                    line = std::format("[Trace] failed to format {} record: {}", CategoryName(rec->category), e.what());
+                }
+                ring.Release();
+                spdlog::info("{}", line);
+            }
+            return any;
+        }
+
+        void Signal() noexcept {
+            g_published.fetch_add(1, std::memory_order_release);
+            g_published.notify_one();
+        }
+
+        // Reads the publish count before draining, so a record published after an empty drain wakes the wait.
+        [[noreturn]] void WorkerLoop() {
+            std::string line;
+            line.reserve(256);
+            for (;;) {
+                const auto seen = g_published.load(std::memory_order_acquire);
+                if (!DrainOnce(line)) g_published.wait(seen, std::memory_order_acquire);
+            }
+        }
+
+        void StartWorkerIfEnabled() {
+            if (!g_loggerReady.load(std::memory_order_acquire) || Mask() == 0) return;
+            static std::once_flag once;
+            std::call_once(once, [] { std::thread(WorkerLoop).detach(); });
+        }
+    }
+
+    const char* CategoryName(Category c) {
+        const auto i = static_cast<std::size_t>(c);
+        return i < kCategoryNames.size() ? kCategoryNames[i] : "?";
+    }
+
+    void SetMask(std::uint32_t mask) {
+        g_enabledMask.store(mask & ((1u << kCategoryCount) - 1u), std::memory_order_relaxed);
+        StartWorkerIfEnabled();
+    }
+
+    std::uint32_t Mask() noexcept { return g_enabledMask.load(std::memory_order_relaxed); }
+
+    std::uint64_t DroppedCount() noexcept { return g_dropped.load(std::memory_order_relaxed); }
+
+    void Start() {
+        g_loggerReady.store(true, std::memory_order_release);
+        StartWorkerIfEnabled();
+    }
+
+    namespace detail {
+        Record* Claim() noexcept {
+            if (auto* rec = GetRing().TryClaim()) return rec;
+            g_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        void Publish(Record* rec) noexcept {
+            GetRing().Publish(rec);
+            Signal();
+        }
+
+        void Abandon(Record* rec) noexcept {
+            rec->format = nullptr;
+            g_dropped.fetch_add(1, std::memory_order_relaxed);
+            GetRing().Publish(rec);
+            Signal();
+        }
+    }
+}
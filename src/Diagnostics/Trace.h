@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <iterator>
+#include <new>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace IntegratedMagic::Trace {
+
+    enum class Category : std::uint8_t { Input = 0, Replay, State, Anim, Equip, HUD, kCount };
+
+    inline constexpr std::size_t kCategoryCount = static_cast<std::size_t>(Category::kCount);
+
+    inline std::atomic<std::uint32_t> g_enabledMask{0};
+
+    [[nodiscard]] inline bool Enabled(Category c) noexcept {
+        return (g_enabledMask.load(std::memory_order_relaxed) >> static_cast<unsigned>(c)) & 1u;
+    }
+
+    [[nodiscard]] const char* CategoryName(Category c);
+    void SetMask(std::uint32_t mask);
+    [[nodiscard]] std::uint32_t Mask() noexcept;
+    [[nodiscard]] std::uint64_t DroppedCount() noexcept;
+
+    // Marks the logger ready. The worker that writes records to it starts once a category is enabled.
+    void Start();
+
+    namespace detail {
+        inline constexpr std::size_t kPayloadBytes = 240;
+        inline constexpr std::size_t kPayloadAlign = 16;
+
+        using FormatFn = void (*)(void* payload, std::string& out);
+
+        struct Record {
+            std::size_t pos{0};
+            Category category{Category::Input};
+            FormatFn format{nullptr};
+            alignas(kPayloadAlign) std::byte payload[kPayloadBytes];
+        };
+
+        Record* Claim() noexcept;
+        void Publish(Record* rec) noexcept;
+        void Abandon(Record* rec) noexcept;
+
+        template <class T>
+        using Stored = std::conditional_t<std::is_convertible_v<const std::decay_t<T>&, std::string_view> &&
+                                              !std::is_same_v<std::decay_t<T>, std::nullptr_t>,
+                                          std::string, std::decay_t<T>>;
+    }
+
+    template <class... Args>
+    void Emit(Category c, std::format_string<Args...> fmt, Args&&... args) {
+        using Payload = std::tuple<std::string_view, detail::Stored<Args>...>;
+        static_assert(sizeof(Payload) <= detail::kPayloadBytes, "Too many trace arguments for one record.");
+        static_assert(alignof(Payload) <= detail::kPayloadAlign);
+
+        auto* rec = detail::Claim();
+        if (!rec) return;
+        try {
+            ::new (static_cast<void*>(rec->payload)) Payload(fmt.get(), std::forward<Args>(args)...);
+        } catch (...) {
+            detail::Abandon(rec);
+            return;
+        }
+        rec->category = c;
+        rec->format = [](void* p, std::string& out) {
+            struct Destroy {
+                Payload* payload;
+                ~Destroy() { payload->~Payload(); }
+            } const guard{std::launder(static_cast<Payload*>(p))};
+            std::apply(
+                [&out](std::string_view f, auto&... a) {
+                    std::vformat_to(std::back_inserter(out), f, std::make_format_args(a...));
+                },
+                *guard.payload);
+        };
+        detail::Publish(rec);
+    }
+}
+
+#define IM_TRACE(cat, ...)                                                                               \
+    do {                                                                                                 \
+        if (::IntegratedMagic::Trace::Enabled(::IntegratedMagic::Trace::Category::cat)) [[unlikely]]     \
+            ::IntegratedMagic::Trace::Emit(::IntegratedMagic::Trace::Category::cat, __VA_ARGS__);        \
+    } while (false)
@@ -9,9 +9,11 @@
 
 #include <utility>
 
+#include "Diagnostics/Latency.h"
 #include "HookUtil.hpp"
 #include "Input/Input.h"
 #include "Input/Inputstate.h"
+#include "Input/OsEvents.h"
 #include "PCH.h"
 #include "State/AnimListener.h"
 #include "State/State.h"
@@ -30,6 +32,7 @@ namespace IntegratedMagic::Hooks {
             static void thunk(RE::BSTEventSource<RE::InputEvent*>* a_dispatcher, RE::InputEvent* const* a_events) {
                 if (!a_events) return;
 
+                IntegratedMagic::Latency::MarkPoll();
                 Input::ProcessAndFilter(const_cast<RE::InputEvent**>(a_events));
 
                 RE::InputEvent* head = IntegratedMagic::detail::FlushSyntheticInput(*a_events);
@@ -37,6 +40,8 @@ namespace IntegratedMagic::Hooks {
                 if (func == 0) return;
                 RE::InputEvent* const arr[2]{head, nullptr};
                 reinterpret_cast<Fn*>(func)(a_dispatcher, arr);
+
+                IntegratedMagic::detail::RecycleSyntheticInput();
             }
 
             static void Install() {
@@ -73,27 +78,79 @@ namespace IntegratedMagic::Hooks {
         static ID3D11Device* g_device{nullptr};
         static ID3D11DeviceContext* g_deviceContext{nullptr};
 
+        static int MouseButtonIndex(UINT uMsg, WPARAM wParam) {
+            switch (uMsg) {
+                case WM_LBUTTONDOWN:
+                case WM_LBUTTONUP:
+                    return 0;
+                case WM_RBUTTONDOWN:
+                case WM_RBUTTONUP:
+                    return 1;
+                case WM_MBUTTONDOWN:
+                case WM_MBUTTONUP:
+                    return 2;
+                case WM_XBUTTONDOWN:
+                case WM_XBUTTONUP:
+                    return GET_XBUTTON_WPARAM(wParam) == XBUTTON1 ? 3 : 4;
+                default:
+                    return -1;
+            }
+        }
+
+        static void ForwardOsEvent(UINT uMsg, WPARAM wParam, LPARAM lParam) {
+            using Input::OsEventType;
+            switch (uMsg) {
+                case WM_ACTIVATEAPP:
+                    Input::PostOsEvent(wParam ? OsEventType::FocusGained : OsEventType::FocusLost);
+                    break;
+                case WM_SETFOCUS:
+                    Input::PostOsEvent(OsEventType::FocusGained);
+                    break;
+                case WM_KILLFOCUS:
+                    Input::PostOsEvent(OsEventType::FocusLost);
+                    break;
+                case WM_KEYDOWN:
+                case WM_SYSKEYDOWN:
+                case WM_KEYUP:
+                case WM_SYSKEYUP: {
+                    const bool down = (uMsg == WM_KEYDOWN || uMsg == WM_SYSKEYDOWN);
+                    if (down && !Input::IsCaptureModeActive()) break;
+                    int sc = static_cast<int>((lParam >> 16) & 0x7F);
+                    if (lParam & (1 << 24)) sc |= 0x80;
+                    Input::PostOsEvent(down ? OsEventType::KeyDown : OsEventType::KeyUp, sc);
+                    break;
+                }
+                case WM_LBUTTONDOWN:
+                case WM_RBUTTONDOWN:
+                case WM_MBUTTONDOWN:
+                case WM_XBUTTONDOWN:
+                    if (Input::IsCaptureModeActive())
+                        Input::PostOsEvent(OsEventType::MouseDown, MouseButtonIndex(uMsg, wParam));
+                    break;
+                case WM_LBUTTONUP:
+                case WM_RBUTTONUP:
+                case WM_MBUTTONUP:
+                case WM_XBUTTONUP:
+                    Input::PostOsEvent(OsEventType::MouseUp, MouseButtonIndex(uMsg, wParam));
+                    break;
+                case WM_DEVICECHANGE:
+                case WM_INPUT_DEVICE_CHANGE:
+                    Input::PostOsEvent(OsEventType::DeviceChange);
+                    break;
+                default:
+                    break;
+            }
+        }
+
         struct WndProcHook {
             static inline WNDPROC func{nullptr};
 
             static LRESULT thunk(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+                ForwardOsEvent(uMsg, wParam, lParam);
+
                 if (g_renderInitialized.load()) {
                     ImGui::SetCurrentContext(g_imguiContext);
 
-                    if (Input::IsCaptureModeActive()) {
-                        if (uMsg == WM_KEYDOWN || uMsg == WM_SYSKEYDOWN) {
-                            const UINT sc = (lParam >> 16) & 0x7F;
-                            if (sc > 0 && sc < static_cast<UINT>(kMouseButtonBase))
-                                Input::InjectCapturedScancode(static_cast<int>(sc));
-                        } else if (uMsg == WM_LBUTTONDOWN) {
-                            Input::InjectCapturedScancode(kMouseButtonBase + 0);
-                        } else if (uMsg == WM_RBUTTONDOWN) {
-                            Input::InjectCapturedScancode(kMouseButtonBase + 1);
-                        } else if (uMsg == WM_MBUTTONDOWN) {
-                            Input::InjectCapturedScancode(kMouseButtonBase + 2);
-                        }
-                    }
-
                     if (!Input::IsCaptureModeActive()) {
                         if (uMsg == WM_KILLFOCUS) {
                             auto& io = ImGui::GetIO();
@@ -115,7 +172,7 @@ namespace IntegratedMagic::Hooks {
             }
         };
 
-        static int PollGamepadCapture() {
+        static int PollGamepadCapture(bool& connected) {
             static constexpr std::pair<WORD, int> kMap[] = {
                 {XINPUT_GAMEPAD_DPAD_UP, 0},
                 {XINPUT_GAMEPAD_DPAD_DOWN, 1},
@@ -133,7 +190,10 @@ namespace IntegratedMagic::Hooks {
                 {XINPUT_GAMEPAD_Y, 13},
             };
             XINPUT_STATE state{};
-            if (XInputGetState(0, &state) != ERROR_SUCCESS) return -1;
+            if (XInputGetState(0, &state) != ERROR_SUCCESS) {
+                connected = false;
+                return -1;
+            }
             for (const auto& [mask, idx] : kMap)
                 if (state.Gamepad.wButtons & mask) return idx;
 
@@ -280,18 +340,15 @@ namespace IntegratedMagic::Hooks {
 
                 if (s_bbWidth > 0.f) ImGui::GetIO().DisplaySize = {s_bbWidth, s_bbHeight};
 
-                if (Input::IsCaptureModeActive()) {
-                    static bool s_prevMouse[5]{};
-                    constexpr int kMouseVKs[5] = {VK_LBUTTON, VK_RBUTTON, VK_MBUTTON, VK_XBUTTON1, VK_XBUTTON2};
-                    for (int i = 0; i < 5; ++i) {
-                        const bool down = (GetAsyncKeyState(kMouseVKs[i]) & 0x8000) != 0;
-                        if (down && !s_prevMouse[i]) Input::InjectCapturedScancode(kMouseButtonBase + i);
-                        s_prevMouse[i] = down;
-                    }
-
-                    const int gpIdx = PollGamepadCapture();
+                static bool s_prevCapture = false;
+                static bool s_padConnected = false;
+                const bool capture = Input::IsCaptureModeActive();
+                if (Input::ConsumeGamepadProbeRequest() || (capture && !s_prevCapture)) s_padConnected = true;
+                if (capture && s_padConnected) {
+                    const int gpIdx = PollGamepadCapture(s_padConnected);
                     if (gpIdx >= 0) Input::InjectCapturedGamepad(gpIdx);
                 }
+                s_prevCapture = capture;
 
                 ImGui::NewFrame();
                 IntegratedMagic::HUD::DrawHudFrame();
@@ -0,0 +1,241 @@
+#include "ChordMachine.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+
+#include "Config/Config.h"
+#include "PCH.h"
+#include "State/Timers.h"
+
+namespace Input::detail {
+
+    namespace {
+        inline constexpr int kMaxChordKeys = 3;
+        inline constexpr float kHoldTriggerSec = 0.35f;
+        inline constexpr float kDoubleTapWindowSec = 0.30f;
+
+        using SlotsByCode = std::array<std::uint64_t, kMaxCode>;
+
+        struct ChordTable {
+            std::array<SlotsByCode, kMaxChordKeys> stepByCode{};
+            std::array<std::uint64_t, kMaxChordKeys> needsKeys{};
+            std::uint64_t needLo{0};
+            std::uint64_t needHi{0};
+            std::uint64_t bound{0};
+        };
+
+        struct ChordState {
+            std::uint64_t lo{0};
+            std::uint64_t hi{0};
+            std::array<std::uint64_t, kMaxChordKeys> progress{};
+        };
+
+        enum class TriggerPhase : std::uint8_t { Idle, Pressed, TapReleased, Active };
+
+        ChordTable g_kbTable{};
+        ChordTable g_gpTable{};
+        ChordState g_kbState{};
+        ChordState g_gpState{};
+        std::uint64_t g_sequenceSlots{0};
+        std::atomic<std::uint64_t> g_kbChordDown{0};
+        std::atomic<std::uint64_t> g_gpChordDown{0};
+        std::uint64_t g_stepSeq{0};
+        std::array<std::uint64_t, kMaxSlots> g_chordEdgeSeq{};
+
+        std::array<IntegratedMagic::HotkeyTrigger, kMaxSlots> g_triggerKind{};
+        std::array<TriggerPhase, kMaxSlots> g_triggerPhase{};
+        std::uint64_t g_triggerDue{0};
+
+        void CompileDevice(ChordTable& t, const std::array<int, 3>& keys, int slot) {
+            const auto bit = 1uLL << slot;
+            int n = 0;
+            for (int k = 0; k < 3; ++k) {
+                const int c = keys[static_cast<std::size_t>(k)];
+                if (!KeyMask::InRange(c)) continue;
+                bool dup = false;
+                for (int j = 0; j < k; ++j) dup = dup || (keys[static_cast<std::size_t>(j)] == c);
+                if (dup) continue;
+                t.stepByCode[static_cast<std::size_t>(n)][static_cast<std::size_t>(c)] |= bit;
+                ++n;
+            }
+            if (n == 0) return;
+            t.bound |= bit;
+            t.needsKeys[static_cast<std::size_t>(n - 1)] |= bit;
+            if (n & 1) t.needLo |= bit;
+            if (n & 2) t.needHi |= bit;
+        }
+
+        void Increment(ChordState& st, std::uint64_t slots) {
+            slots &= ~(st.lo & st.hi);
+            const auto carry = st.lo & slots;
+            st.lo ^= slots;
+            st.hi ^= carry;
+        }
+
+        void Decrement(ChordState& st, std::uint64_t slots) {
+            slots &= (st.lo | st.hi);
+            const auto borrow = ~st.lo & slots;
+            st.lo ^= slots;
+            st.hi ^= borrow;
+        }
+
+        void Publish(const ChordTable& t, const ChordState& st, std::atomic<std::uint64_t>& out) {
+            const auto full = t.bound & ~((st.lo ^ t.needLo) | (st.hi ^ t.needHi));
+            std::uint64_t ordered = 0;
+            for (std::size_t k = 0; k < kMaxChordKeys; ++k) ordered |= st.progress[k] & t.needsKeys[k];
+            const auto next = (full & ~g_sequenceSlots) | (ordered & g_sequenceSlots);
+            for (auto changed = out.exchange(next, std::memory_order_relaxed) ^ next; changed; changed &= (changed - 1))
+                g_chordEdgeSeq[static_cast<std::size_t>(std::countr_zero(changed))] = g_stepSeq;
+        }
+
+        void Step(const ChordTable& t, ChordState& st, const SlotsByCode& slotsByCode, int code, bool down) {
+            const auto c = static_cast<std::size_t>(code);
+            const auto slots = slotsByCode[c];
+            if (!slots) return;
+            if (down) {
+                Increment(st, slots);
+                for (std::size_t k = kMaxChordKeys - 1; k > 0; --k)
+                    st.progress[k] |= st.progress[k - 1] & t.stepByCode[k][c];
+                st.progress[0] |= t.stepByCode[0][c];
+            } else {
+                Decrement(st, slots);
+                for (auto& p : st.progress) p &= ~slots;
+            }
+        }
+
+        bool TriggerDue(std::size_t s) { return (g_triggerDue & (1uLL << s)) != 0; }
+
+        void ArmTrigger(std::size_t s, float secs) {
+            g_triggerDue &= ~(1uLL << s);
+            IntegratedMagic::Timers::Arm(IntegratedMagic::Timers::Timer::SlotTrigger, static_cast<std::uint32_t>(s),
+                                         secs);
+        }
+
+        void DisarmTrigger(std::size_t s) {
+            g_triggerDue &= ~(1uLL << s);
+            IntegratedMagic::Timers::Cancel(IntegratedMagic::Timers::Timer::SlotTrigger, static_cast<std::uint32_t>(s));
+        }
+
+        void Rebuild(ChordState& st, const SlotsByCode& slotsByCode, const KeyDownState& down) {
+            st = {};
+            down.Snapshot().ForEach([&](int code) { Increment(st, slotsByCode[static_cast<std::size_t>(code)]); });
+        }
+    }
+
+    void CompileChordMachine() {
+        auto const& cfg = IntegratedMagic::GetMagicConfig();
+        g_kbTable = {};
+        g_gpTable = {};
+        g_sequenceSlots = 0;
+
+        const int n = ActiveSlots();
+        for (int slot = 0; slot < n; ++slot) {
+            const auto s = static_cast<std::size_t>(slot);
+            CompileDevice(g_kbTable, g_cache[s].kb, slot);
+            CompileDevice(g_gpTable, g_cache[s].gp, slot);
+            g_triggerKind[s] =
+                static_cast<IntegratedMagic::HotkeyTrigger>(cfg.slotInput[s].Trigger.load(std::memory_order_relaxed));
+            if (g_triggerKind[s] == IntegratedMagic::HotkeyTrigger::Sequence) g_sequenceSlots |= (1uLL << slot);
+        }
+
+        ResetSlotTriggers();
+        RebuildChordState();
+    }
+
+    void StepChordMachine(RE::INPUT_DEVICE dev, int code, bool down) {
+        if (!KeyMask::InRange(code)) return;
+        ++g_stepSeq;
+        if (dev == RE::INPUT_DEVICE::kGamepad) {
+            Step(g_gpTable, g_gpState, g_gpSlotsByCode, code, down);
+            Publish(g_gpTable, g_gpState, g_gpChordDown);
+        } else {
+            Step(g_kbTable, g_kbState, g_kbSlotsByCode, code, down);
+            Publish(g_kbTable, g_kbState, g_kbChordDown);
+        }
+    }
+
+    void RebuildChordState() {
+        Rebuild(g_kbState, g_kbSlotsByCode, g_kbDown);
+        Rebuild(g_gpState, g_gpSlotsByCode, g_gpDown);
+        Publish(g_kbTable, g_kbState, g_kbChordDown);
+        Publish(g_gpTable, g_gpState, g_gpChordDown);
+    }
+
+    std::uint64_t ChordKbDownMask() { return g_kbChordDown.load(std::memory_order_relaxed); }
+
+    std::uint64_t ChordGpDownMask() { return g_gpChordDown.load(std::memory_order_relaxed); }
+
+    std::uint64_t ChordEdgeSeq(std::size_t s) { return g_chordEdgeSeq[s]; }
+
+    bool ApplySlotTrigger(std::size_t s, bool rawNow) {
+        using Trigger = IntegratedMagic::HotkeyTrigger;
+        auto& phase = g_triggerPhase[s];
+        switch (g_triggerKind[s]) {
+            case Trigger::Hold:
+                if (!rawNow) {
+                    if (phase != TriggerPhase::Idle) DisarmTrigger(s);
+                    phase = TriggerPhase::Idle;
+                    return false;
+                }
+                if (phase == TriggerPhase::Idle) {
+                    phase = TriggerPhase::Pressed;
+                    ArmTrigger(s, kHoldTriggerSec);
+                    return false;
+                }
+                if (phase == TriggerPhase::Pressed && !TriggerDue(s)) return false;
+                phase = TriggerPhase::Active;
+                return true;
+
+            case Trigger::DoubleTap:
+                switch (phase) {
+                    case TriggerPhase::Idle:
+                        if (rawNow) {
+                            phase = TriggerPhase::Pressed;
+                            ArmTrigger(s, kDoubleTapWindowSec);
+                        }
+                        return false;
+                    case TriggerPhase::Pressed:
+                        if (rawNow) return false;
+                        if (TriggerDue(s)) {
+                            phase = TriggerPhase::Idle;
+                            DisarmTrigger(s);
+                        } else {
+                            phase = TriggerPhase::TapReleased;
+                            ArmTrigger(s, kDoubleTapWindowSec);
+                        }
+                        return false;
+                    case TriggerPhase::TapReleased:
+                        if (rawNow) {
+                            phase = TriggerPhase::Active;
+                            DisarmTrigger(s);
+                            return true;
+                        }
+                        if (TriggerDue(s)) {
+                            phase = TriggerPhase::Idle;
+                            DisarmTrigger(s);
+                        }
+                        return false;
+                    case TriggerPhase::Active:
+                        if (!rawNow) phase = TriggerPhase::Idle;
+                        return rawNow;
+                }
+                return false;
+
+            default:
+                return rawNow;
+        }
+    }
+
+    void ResetSlotTriggers() {
+        g_triggerPhase.fill(TriggerPhase::Idle);
+        g_triggerDue = 0;
+        IntegratedMagic::Timers::CancelAll(IntegratedMagic::Timers::Timer::SlotTrigger);
+    }
+
+    void RegisterChordTimers() {
+        IntegratedMagic::Timers::SetHandler(IntegratedMagic::Timers::Timer::SlotTrigger,
+                                            [](std::uint32_t s) { g_triggerDue |= (1uLL << s); });
+    }
+
+}
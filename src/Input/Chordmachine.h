@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "InputState.h"
+
+namespace Input::detail {
+
+    void CompileChordMachine();
+
+    void StepChordMachine(RE::INPUT_DEVICE dev, int code, bool down);
+
+    void RebuildChordState();
+
+    [[nodiscard]] std::uint64_t ChordKbDownMask();
+
+    [[nodiscard]] std::uint64_t ChordGpDownMask();
+
+    [[nodiscard]] std::uint64_t ChordEdgeSeq(std::size_t s);
+
+    [[nodiscard]] bool ApplySlotTrigger(std::size_t s, bool rawNow);
+
+    void ResetSlotTriggers();
+
+    void RegisterChordTimers();
+
+}
@@ -0,0 +1,189 @@
+#include "ChordTiming.h"
+
+#include <SimpleIni.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <format>
+
+#include "Config/Config.h"
+#include "Config/ConfigPath.h"
+#include "Diagnostics/Trace.h"
+#include "HotkeyCache.h"
+#include "Input.h"
+#include "PCH.h"
+
+namespace Input::detail {
+
+    namespace {
+        using clock = std::chrono::steady_clock;
+
+        inline constexpr std::size_t kSamples = 32;
+        inline constexpr std::uint32_t kMinSamples = 8;
+        inline constexpr float kMinWindowSec = 0.030f;
+        inline constexpr float kMaxWindowSec = 0.250f;
+        inline constexpr float kHeadroom = 1.5f;
+        inline constexpr float kSlackSec = 0.010f;
+
+        struct SampleRing {
+            std::array<std::uint16_t, kSamples> ms{};
+            std::size_t count{0};
+            std::size_t next{0};
+
+            void Push(std::uint16_t v) {
+                ms[next] = v;
+                next = (next + 1) % kSamples;
+                if (count < kSamples) ++count;
+            }
+
+            [[nodiscard]] float Percentile(int pct) const {
+                auto sorted = ms;
+                const auto first = sorted.begin();
+                const auto nth = first + static_cast<std::ptrdiff_t>((count - 1) * static_cast<std::size_t>(pct) / 100);
+                std::nth_element(first, nth, first + static_cast<std::ptrdiff_t>(count));
+                return static_cast<float>(*nth) / 1000.f;
+            }
+        };
+
+        struct ChordTrack {
+            clock::time_point firstDownAt{};
+            clock::time_point fullAt{};
+            bool anyDown{false};
+            bool full{false};
+            bool accepted{false};
+            bool sampleReady{false};
+            std::uint16_t sampleDownMs{0};
+            std::uint16_t sampleReleaseMs{0};
+            std::uint32_t fresh{0};
+            SampleRing downGap{};
+            SampleRing releaseGap{};
+            float confirmSec{kExclusiveConfirmDelaySec};
+            float simSec{kExclusiveConfirmDelaySec};
+        };
+
+        std::array<std::array<ChordTrack, 2>, kMaxSlots> g_tracks{};
+        bool g_dirty{false};
+
+        std::filesystem::path TimingPath() {
+            return IntegratedMagic::GetThisDllDir() / "IntegratedMagic_ChordTiming.ini";
+        }
+
+        bool AdaptiveEnabled() { return IntegratedMagic::GetMagicConfig().adaptiveInputWindowsPatch; }
+
+        int Percentile() { return std::clamp(IntegratedMagic::GetMagicConfig().adaptiveWindowPercentile, 50, 99); }
+
+        ChordTrack& TrackFor(std::size_t s, PendingSrc src) { return g_tracks[s][src == PendingSrc::Gp ? 1 : 0]; }
+
+        std::uint16_t ToMs(clock::duration d) {
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+            return static_cast<std::uint16_t>(std::clamp<long long>(ms, 0, 0xFFFF));
+        }
+
+        void Retune([[maybe_unused]] std::size_t s, ChordTrack& t) {
+            const int pct = Percentile();
+            const float sim =
+                std::clamp(t.downGap.Percentile(pct) * kHeadroom + kSlackSec, kMinWindowSec, kMaxWindowSec);
+            const float confirm = std::clamp(std::min(sim, t.releaseGap.Percentile(100 - pct)), kMinWindowSec, sim);
+            if (std::abs(sim - t.simSec) >= 0.001f || std::abs(confirm - t.confirmSec) >= 0.001f) g_dirty = true;
+            IM_TRACE(Input, "[Input] ChordTiming: slot={} p{} sim {:.3f}s -> {:.3f}s confirm {:.3f}s -> {:.3f}s", s,
+                     pct, t.simSec, sim, t.confirmSec, confirm);
+            t.simSec = sim;
+            t.confirmSec = confirm;
+        }
+
+        void Step(std::size_t s, ChordTrack& t, bool anyDown, bool full, bool accepted, clock::time_point now) {
+            if (anyDown && !t.anyDown) {
+                t.firstDownAt = now;
+                t.accepted = false;
+                t.sampleReady = false;
+            }
+            if (full && !t.full) t.fullAt = now;
+            if (!full && t.full) {
+                t.sampleDownMs = ToMs(t.fullAt - t.firstDownAt);
+                t.sampleReleaseMs = ToMs(now - t.fullAt);
+                t.sampleReady = true;
+            }
+            if (accepted && (full || t.sampleReady)) t.accepted = true;
+            t.anyDown = anyDown;
+            t.full = full;
+
+            if (!t.sampleReady || !t.accepted) return;
+            t.sampleReady = false;
+            t.accepted = false;
+            t.downGap.Push(t.sampleDownMs);
+            t.releaseGap.Push(t.sampleReleaseMs);
+            if (++t.fresh < kMinSamples || t.downGap.count < kMinSamples) return;
+            t.fresh = 0;
+            Retune(s, t);
+        }
+    }
+
+    void ObserveChordTiming(std::size_t s, std::uint64_t kbChordDown, std::uint64_t gpChordDown, bool accepted,
+                            clock::time_point now) {
+        if (!AdaptiveEnabled()) return;
+        const auto bit = 1uLL << s;
+        const auto& hk = g_cache[s];
+        if (g_slots[s].isKbMultiKey)
+            Step(s, g_tracks[s][0], AnyComboKeyDown(hk.kbMask, g_kbDown), (kbChordDown & bit) != 0, accepted, now);
+        if (g_slots[s].isGpMultiKey)
+            Step(s, g_tracks[s][1], AnyComboKeyDown(hk.gpMask, g_gpDown), (gpChordDown & bit) != 0, accepted, now);
+    }
+
+    float ConfirmWindowSec(std::size_t s, PendingSrc src) {
+        return AdaptiveEnabled() ? TrackFor(s, src).confirmSec : kExclusiveConfirmDelaySec;
+    }
+
+    float SimWindowSec(std::size_t s, PendingSrc src) {
+        return AdaptiveEnabled() ? TrackFor(s, src).simSec : kExclusiveConfirmDelaySec;
+    }
+}
+
+void Input::LoadChordTiming() {
+    using namespace Input::detail;
+    CSimpleIniA ini;
+    ini.SetUnicode();
+    if (ini.LoadFile(TimingPath().string().c_str()) < 0) return;
+
+    auto readSec = [&](const char* sec, const char* key) {
+        const auto ms = ini.GetLongValue(sec, key, static_cast<long>(kExclusiveConfirmDelaySec * 1000.f));
+        return std::clamp(static_cast<float>(ms) / 1000.f, kMinWindowSec, kMaxWindowSec);
+    };
+    for (std::size_t s = 0; s < kMaxSlots; ++s) {
+        const auto sec = std::format("Magic{}", s + 1);
+        if (!ini.GetSection(sec.c_str())) continue;
+        auto& kb = g_tracks[s][0];
+        auto& gp = g_tracks[s][1];
+        kb.simSec = readSec(sec.c_str(), "KeyboardSimWindowMs");
+        kb.confirmSec = std::min(readSec(sec.c_str(), "KeyboardConfirmMs"), kb.simSec);
+        gp.simSec = readSec(sec.c_str(), "GamepadSimWindowMs");
+        gp.confirmSec = std::min(readSec(sec.c_str(), "GamepadConfirmMs"), gp.simSec);
+    }
+    g_dirty = false;
+}
+
+void Input::SaveChordTiming() {
+    using namespace Input::detail;
+    if (!g_dirty) return;
+    CSimpleIniA ini;
+    ini.SetUnicode();
+    auto toMs = [](float secs) { return static_cast<long>(std::lround(secs * 1000.f)); };
+    for (std::size_t s = 0; s < kMaxSlots; ++s) {
+        const auto& kb = g_tracks[s][0];
+        const auto& gp = g_tracks[s][1];
+        if (kb.simSec == kExclusiveConfirmDelaySec && kb.confirmSec == kExclusiveConfirmDelaySec &&
+            gp.simSec == kExclusiveConfirmDelaySec && gp.confirmSec == kExclusiveConfirmDelaySec)
+            continue;
+        const auto sec = std::format("Magic{}", s + 1);
+        ini.SetLongValue(sec.c_str(), "KeyboardSimWindowMs", toMs(kb.simSec));
+        ini.SetLongValue(sec.c_str(), "KeyboardConfirmMs", toMs(kb.confirmSec));
+        ini.SetLongValue(sec.c_str(), "GamepadSimWindowMs", toMs(gp.simSec));
+        ini.SetLongValue(sec.c_str(), "GamepadConfirmMs", toMs(gp.confirmSec));
+    }
+    if (ini.SaveFile(TimingPath().string().c_str()) < 0) {
+        spdlog::warn("[Input] SaveChordTiming: failed to write {}", TimingPath().string());
+        return;
+    }
+    g_dirty = false;
+}
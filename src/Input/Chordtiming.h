@@ -0,0 +1,18 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+#include "InputState.h"
+
+namespace Input::detail {
+
+    // `now` is read once per RecomputeSlotEdges call and shared by every slot.
+    void ObserveChordTiming(std::size_t s, std::uint64_t kbChordDown, std::uint64_t gpChordDown, bool accepted,
+                            std::chrono::steady_clock::time_point now);
+
+    [[nodiscard]] float ConfirmWindowSec(std::size_t s, PendingSrc src);
+
+    [[nodiscard]] float SimWindowSec(std::size_t s, PendingSrc src);
+
+}
@@ -1,15 +1,18 @@
 #include "EventFilter.h"
 
-#include <ranges>
+#include <bit>
 
-#include "Config/Config.h"
+#include "ChordMachine.h"
+#include "Diagnostics/Latency.h"
+#include "Diagnostics/Trace.h"
 #include "ExclusivePending.h"
 #include "HotkeyCache.h"
 #include "HudToggle.h"
 #include "InputInternal.h"
 #include "PCH.h"
-#include "ReplaySystem.h"
 #include "SKSEMenuFramework.h"
+#include "State/FormTraits.h"
+#include "State/MenuState.h"
 #include "State/State.h"
 #include "UI/HudManager.h"
 
@@ -17,51 +20,13 @@ namespace Input::detail {
 
     namespace {
 
-        int GamepadIdToIndex(int idCode) {
-            using Key = RE::BSWin32GamepadDevice::Key;
-            switch (static_cast<Key>(idCode)) {
-                case Key::kUp:
-                    return 0;
-                case Key::kDown:
-                    return 1;
-                case Key::kLeft:
-                    return 2;
-                case Key::kRight:
-                    return 3;
-                case Key::kStart:
-                    return 4;
-                case Key::kBack:
-                    return 5;
-                case Key::kLeftThumb:
-                    return 6;
-                case Key::kRightThumb:
-                    return 7;
-                case Key::kLeftShoulder:
-                    return 8;
-                case Key::kRightShoulder:
-                    return 9;
-                case Key::kA:
-                    return 10;
-                case Key::kB:
-                    return 11;
-                case Key::kX:
-                    return 12;
-                case Key::kY:
-                    return 13;
-                case Key::kLeftTrigger:
-                    return 14;
-                case Key::kRightTrigger:
-                    return 15;
-                default:
-                    return -1;
-            }
-        }
-
         void UpdateDownState(RE::INPUT_DEVICE dev, int convertedCode, bool downNow) {
+            bool changed = false;
             if (dev == RE::INPUT_DEVICE::kKeyboard)
-                g_kbDown[static_cast<std::size_t>(convertedCode)].store(downNow, std::memory_order_relaxed);
+                changed = g_kbDown.Store(convertedCode, downNow);
             else if (dev == RE::INPUT_DEVICE::kGamepad)
-                g_gpDown[static_cast<std::size_t>(convertedCode)].store(downNow, std::memory_order_relaxed);
+                changed = g_gpDown.Store(convertedCode, downNow);
+            if (changed) StepChordMachine(dev, convertedCode, downNow);
         }
 
         bool TryHandleCapture(const RE::ButtonEvent* btn, CaptureState& cap, bool& wantCapture, RE::INPUT_DEVICE dev,
@@ -76,156 +41,61 @@ namespace Input::detail {
                 encoded = -(convertedCode + 2);
             if (encoded == -1) return false;
 
-#ifdef DEBUG
-            spdlog::info("[Input] TryHandleCapture: captured dev={} code={} encoded={}", static_cast<int>(dev),
-                         convertedCode, encoded);
-#endif
+            IM_TRACE(Input, "[Input] TryHandleCapture: captured dev={} code={} encoded={}", static_cast<int>(dev),
+                     convertedCode, encoded);
             cap.capturedEncoded.store(encoded, std::memory_order_relaxed);
             cap.captureRequested.store(false, std::memory_order_relaxed);
             wantCapture = false;
             return true;
         }
 
-        bool HasTransformArchetype(const RE::MagicItem* item) {
-            if (!item) return false;
-            using ArchetypeID = RE::EffectArchetypes::ArchetypeID;
-            return std::ranges::any_of(item->effects, [](const auto* effect) {
-                if (!effect || !effect->baseEffect) return false;
-                const auto arch = effect->baseEffect->GetArchetype();
-                return arch == ArchetypeID::kWerewolf || arch == ArchetypeID::kVampireLord;
-            });
-        }
-
         bool IsTransformPowerEquipped(RE::PlayerCharacter* pc) {
             if (!pc) return false;
             const auto& rd = pc->GetActorRuntimeData();
             if (!rd.selectedPower) return false;
-            return HasTransformArchetype(rd.selectedPower->As<RE::MagicItem>());
+            return IntegratedMagic::FormTraits::Get(rd.selectedPower).transform;
         }
 
         void HandleSlotPressed(int slot) {
             if (slot < 0 || slot >= ActiveSlots()) return;
             if (!RE::PlayerCharacter::GetSingleton()) return;
-#ifdef DEBUG
-            spdlog::info("[Input] HandleSlotPressed: slot={}", slot);
-#endif
+            IM_TRACE(Input, "[Input] HandleSlotPressed: slot={}", slot);
+            IntegratedMagic::Latency::Mark(IntegratedMagic::Latency::Stage::Dispatched);
             IntegratedMagic::MagicState::Get().OnSlotPressed(slot);
         }
 
         void HandleSlotReleased(int slot) {
             if (slot < 0 || slot >= ActiveSlots()) return;
-#ifdef DEBUG
-            spdlog::info("[Input] HandleSlotReleased: slot={}", slot);
-#endif
+            IM_TRACE(Input, "[Input] HandleSlotReleased: slot={}", slot);
             IntegratedMagic::MagicState::Get().OnSlotReleased(slot);
         }
 
         void DispatchSlots() {
-            for (auto s = Input::ConsumePressedSlot(); s.has_value(); s = Input::ConsumePressedSlot())
-                HandleSlotPressed(*s);
-            for (auto s = Input::ConsumeReleasedSlot(); s.has_value(); s = Input::ConsumeReleasedSlot())
-                HandleSlotReleased(*s);
+            Input::SlotEdgeBatch edges;
+            const auto n = Input::TakeSlotEdges(edges);
+            for (std::size_t i = 0; i < n; ++i) {
+                if (edges[i].pressed)
+                    HandleSlotPressed(edges[i].slot);
+                else
+                    HandleSlotReleased(edges[i].slot);
+            }
         }
 
         void DrainWhenBlocked() {
-#ifdef DEBUG
+            Input::SlotEdgeBatch edges;
+            const auto n = Input::TakeSlotEdges(edges);
             int drained = 0;
-#endif
-            for (auto s = Input::ConsumePressedSlot(); s.has_value(); s = Input::ConsumePressedSlot())
-#ifdef DEBUG
-                ++drained;
-            if (drained > 0)
-                spdlog::info("[Input] DrainWhenBlocked: discarded {} pressed slot(s) (input blocked)", drained);
-#endif
-            for (auto ss = Input::ConsumeReleasedSlot(); ss.has_value(); ss = Input::ConsumeReleasedSlot()) {
-#ifdef DEBUG
-                spdlog::info("[Input] DrainWhenBlocked: releasing slot={} while blocked", *ss);
-#endif
-                HandleSlotReleased(*ss);
-            }
-        }
-
-        bool ShouldFilterAndSave(RE::INPUT_DEVICE dev, int convertedCode, std::uint32_t rawIdCode,
-                                 const RE::BSFixedString& userEvent, float value, float heldSecs) {
-            const int effectiveKbCode =
-                (dev == RE::INPUT_DEVICE::kMouse) ? (kMouseButtonBase + convertedCode) : convertedCode;
-
-            const int n = ActiveSlots();
-            for (int slot = 0; slot < n; ++slot) {
-                const auto s = static_cast<std::size_t>(slot);
-                const auto& hk = g_cache[s];
-                const bool inKb = (dev == RE::INPUT_DEVICE::kKeyboard || dev == RE::INPUT_DEVICE::kMouse) &&
-                                  ComboContains(hk.kb, effectiveKbCode);
-                const bool inGp = dev == RE::INPUT_DEVICE::kGamepad && ComboContains(hk.gp, convertedCode);
-                if (!inKb && !inGp) continue;
-
-                if (g_slotDown[s].load(std::memory_order_relaxed)) return true;
-
-                if (g_slotWasAccepted[s]) {
-#ifdef DEBUG
-                    spdlog::info("[Input] ShouldFilterAndSave: slot={} code={} dev={} FILTERED (wasAccepted)", slot,
-                                 effectiveKbCode, static_cast<int>(dev));
-#endif
-                    return true;
-                }
-
-                if (inKb && ComboDown(hk.kb, g_kbDown)) return true;
-                if (inGp && ComboDown(hk.gp, g_gpDown)) return true;
-
-                if (ReplayMatchesEvent(s, dev, rawIdCode, userEvent, value)) {
-#ifdef DEBUG
-                    spdlog::info("[Input] ShouldFilterAndSave: slot={} code={} replay PASS-THROUGH", slot,
-                                 effectiveKbCode);
-#endif
-                    ResetReplayState(s);
-                    return false;
-                }
-
-                if (g_slotIsMultiKey[s] && !HasExclusivePending(s)) {
-                    const bool simPatch = IntegratedMagic::GetMagicConfig().pressBothAtSamePatch && g_slotIsMultiKey[s];
-                    const bool replayInProgress = g_replay[s].armed || HasDeferredReplayForSlot(s);
-                    if ((simPatch && !g_simWindowActive[s]) || replayInProgress) continue;
-
-                    bool sharedWithActiveSlot = false;
-                    for (int other = 0; other < n; ++other) {
-                        if (other == slot) continue;
-                        if (!g_slotDown[static_cast<std::size_t>(other)].load(std::memory_order_relaxed)) continue;
-                        const auto& otherHk = g_cache[static_cast<std::size_t>(other)];
-                        if (inKb && ComboContains(otherHk.kb, effectiveKbCode)) {
-                            sharedWithActiveSlot = true;
-                            break;
-                        }
-                        if (inGp && ComboContains(otherHk.gp, convertedCode)) {
-                            sharedWithActiveSlot = true;
-                            break;
-                        }
-                    }
-                    if (sharedWithActiveSlot) return true;
-
-#ifdef DEBUG
-                    spdlog::info(
-                        "[Input] ShouldFilterAndSave: slot={} code={} starting exclusive pending (multiKey, no pending "
-                        "yet)",
-                        slot, effectiveKbCode);
-#endif
-                    g_exclusivePendingSrc[s] = inGp ? PendingSrc::Gp : PendingSrc::Kb;
-                    g_exclusivePendingTimer[s] = kExclusiveConfirmDelaySec;
-                }
-
-                if (HasExclusivePending(s)) {
-#ifdef DEBUG
-                    spdlog::info(
-                        "[Input] ShouldFilterAndSave: slot={} code={} RETAINED (exclusive pending, value={:.2f}, "
-                        "heldSecs={:.3f})",
-                        slot, effectiveKbCode, value, heldSecs);
-#endif
-                    g_retainedEvents[s].emplace_back(RetainedEvent{dev, rawIdCode, userEvent, value, heldSecs});
-                    return true;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (edges[i].pressed) {
+                    ++drained;
+                    continue;
                 }
+                IM_TRACE(Input, "[Input] DrainWhenBlocked: releasing slot={} while blocked", edges[i].slot);
+                HandleSlotReleased(edges[i].slot);
             }
-            return false;
+            if (drained > 0)
+                IM_TRACE(Input, "[Input] DrainWhenBlocked: discarded {} pressed slot(s) (input blocked)", drained);
         }
-
     }
 
     bool IsInputBlockedByMenus() {
@@ -235,31 +105,7 @@ namespace Input::detail {
         if (SKSEMenuFramework::IsAnyBlockingWindowOpened()) return true;
         if (g_captureModeActive.load(std::memory_order_relaxed)) return true;
 
-        static const RE::BSFixedString inventoryMenu{"InventoryMenu"};
-        static const RE::BSFixedString magicMenu{"MagicMenu"};
-        static const RE::BSFixedString statsMenu{"StatsMenu"};
-        static const RE::BSFixedString mapMenu{"MapMenu"};
-        static const RE::BSFixedString journalMenu{"Journal Menu"};
-        static const RE::BSFixedString favoritesMenu{"FavoritesMenu"};
-        static const RE::BSFixedString containerMenu{"ContainerMenu"};
-        static const RE::BSFixedString barterMenu{"BarterMenu"};
-        static const RE::BSFixedString trainingMenu{"Training Menu"};
-        static const RE::BSFixedString craftingMenu{"Crafting Menu"};
-        static const RE::BSFixedString giftMenu{"GiftMenu"};
-        static const RE::BSFixedString lockpickingMenu{"Lockpicking Menu"};
-        static const RE::BSFixedString sleepWaitMenu{"Sleep/Wait Menu"};
-        static const RE::BSFixedString loadingMenu{"Loading Menu"};
-        static const RE::BSFixedString mainMenu{"Main Menu"};
-        static const RE::BSFixedString console{"Console"};
-        static const RE::BSFixedString mcm{"Mod Configuration Menu"};
-        static const RE::BSFixedString tweenMenu{"Tween Menu"};
-
-        return ui->IsMenuOpen(inventoryMenu) || ui->IsMenuOpen(magicMenu) || ui->IsMenuOpen(statsMenu) ||
-               ui->IsMenuOpen(mapMenu) || ui->IsMenuOpen(journalMenu) || ui->IsMenuOpen(favoritesMenu) ||
-               ui->IsMenuOpen(containerMenu) || ui->IsMenuOpen(barterMenu) || ui->IsMenuOpen(trainingMenu) ||
-               ui->IsMenuOpen(craftingMenu) || ui->IsMenuOpen(giftMenu) || ui->IsMenuOpen(lockpickingMenu) ||
-               ui->IsMenuOpen(sleepWaitMenu) || ui->IsMenuOpen(loadingMenu) || ui->IsMenuOpen(mainMenu) ||
-               ui->IsMenuOpen(console) || ui->IsMenuOpen(mcm) || ui->IsMenuOpen(tweenMenu);
+        return IntegratedMagic::MenuState::AnyOpen(IntegratedMagic::MenuState::Category::InputBlocked);
     }
 
     void ProcessButtonEvents(RE::InputEvent** a_evns, CaptureState& cap, bool& wantCapture) {
@@ -277,7 +123,10 @@ namespace Input::detail {
                 const int mouseCode = kMouseButtonBase + code;
                 if (mouseCode >= 0 && mouseCode < kMaxCode) {
                     (void)TryHandleCapture(btn, cap, wantCapture, RE::INPUT_DEVICE::kMouse, mouseCode);
-                    g_kbDown[static_cast<std::size_t>(mouseCode)].store(btn->IsDown(), std::memory_order_relaxed);
+                    if (g_kbDown.Store(mouseCode, btn->IsDown()))
+                        StepChordMachine(RE::INPUT_DEVICE::kKeyboard, mouseCode, btn->IsDown());
+                    if (btn->IsDown() && g_kbSlotsByCode[static_cast<std::size_t>(mouseCode)])
+                        IntegratedMagic::Latency::MarkKeyDown();
                 }
                 continue;
             }
@@ -286,14 +135,16 @@ namespace Input::detail {
 
             (void)TryHandleCapture(btn, cap, wantCapture, dev, code);
             UpdateDownState(dev, code, btn->IsDown());
+            if (btn->IsDown()) {
+                const auto& slotsByCode = (dev == RE::INPUT_DEVICE::kGamepad) ? g_gpSlotsByCode : g_kbSlotsByCode;
+                if (slotsByCode[static_cast<std::size_t>(code)]) IntegratedMagic::Latency::MarkKeyDown();
+            }
 
             if (btn->IsDown() && player && btn->QUserEvent() == "Shout"sv) {
                 if (IsTransformPowerEquipped(player)) {
-#ifdef DEBUG
-                    spdlog::info(
-                        "[Input] ProcessButtonEvents: Shout pressed with transform power equipped -> "
-                        "ForceExitNoRestore");
-#endif
+                    IM_TRACE(Input,
+                             "[Input] ProcessButtonEvents: Shout pressed with transform power equipped -> "
+                             "ForceExitNoRestore");
                     IntegratedMagic::MagicState::Get().ForceExitNoRestore();
                 }
             }
@@ -381,21 +232,19 @@ namespace Input::detail {
                 if (code >= 0 && code < kMaxCode) {
                     remove =
                         ShouldFilterAndSave(dev, code, rawCode, btn->QUserEvent(), btn->Value(), btn->HeldDuration()) ||
-                        ShouldFilterHudToggle(dev, code);
-#ifdef DEBUG
-                    if (!remove && (dev == RE::INPUT_DEVICE::kMouse || dev == RE::INPUT_DEVICE::kKeyboard)) {
+                        ShouldFilterHudToggle(dev, code) || ShouldFilterBankCycle(dev, code);
+                    if (!remove && IntegratedMagic::Trace::Enabled(IntegratedMagic::Trace::Category::Input) &&
+                        (dev == RE::INPUT_DEVICE::kMouse || dev == RE::INPUT_DEVICE::kKeyboard)) {
                         const int effCode = (dev == RE::INPUT_DEVICE::kMouse) ? kMouseButtonBase + code : code;
-                        const int n = ActiveSlots();
-                        for (int slot = 0; slot < n; ++slot) {
-                            if (ComboContains(g_cache[static_cast<std::size_t>(slot)].kb, effCode)) {
-                                spdlog::info(
-                                    "[Input] FilterEvents: slot={} code={} dev={} value={:.2f} PASSING TO ENGINE", slot,
-                                    effCode, static_cast<int>(dev), btn->Value());
-                                break;
+                        if (effCode < kMaxCode) {
+                            const auto slots = g_kbSlotsByCode[static_cast<std::size_t>(effCode)] & ActiveSlotMask();
+                            if (slots) {
+                                IM_TRACE(Input,
+                                         "[Input] FilterEvents: slot={} code={} dev={} value={:.2f} PASSING TO ENGINE",
+                                         std::countr_zero(slots), effCode, static_cast<int>(dev), btn->Value());
                             }
                         }
                     }
-#endif
                 }
             }
 
@@ -411,9 +260,29 @@ namespace Input::detail {
         }
     }
 
-    void UpdateSlotsIfAllowed(bool blocked, float dt) {
+    KeyMask GameControlKeys(bool gamepad) {
+        KeyMask m{};
+        const auto* map = RE::ControlMap::GetSingleton();
+        const auto* ctx = map ? map->controlMap[RE::UserEvents::INPUT_CONTEXT_ID::kGameplay] : nullptr;
+        if (!ctx) return m;
+        auto add = [&](RE::INPUT_DEVICE dev, auto toCode) {
+            for (const auto& mapping : ctx->deviceMappings[dev]) {
+                const auto key = static_cast<int>(mapping.inputKey);
+                if (key != 0xFF) m.Set(toCode(key));
+            }
+        };
+        if (gamepad) {
+            add(RE::INPUT_DEVICE::kGamepad, [](int key) { return GamepadIdToIndex(key); });
+        } else {
+            add(RE::INPUT_DEVICE::kKeyboard, [](int key) { return key; });
+            add(RE::INPUT_DEVICE::kMouse, [](int key) { return kMouseButtonBase + key; });
+        }
+        return m;
+    }
+
+    void UpdateSlotsIfAllowed(bool blocked) {
         if (!blocked)
-            RecomputeSlotEdges(dt);
+            RecomputeSlotEdges();
         else
             DrainWhenBlocked();
     }
@@ -424,6 +293,7 @@ namespace Input::detail {
             IntegratedMagic::MagicState::Get().PumpAutoAttack(dt);
             IntegratedMagic::MagicState::Get().PumpAutomatic(dt);
         }
+        SettlePreEquip();
     }
 
 }
\ No newline at end of file
@@ -13,7 +13,7 @@ namespace Input::detail {
 
     void FilterEvents(RE::InputEvent** a_evns);
 
-    void UpdateSlotsIfAllowed(bool blocked, float dt);
+    void UpdateSlotsIfAllowed(bool blocked);
 
     void DispatchIfAllowed(bool blocked, float dt);
 
@@ -1,72 +1,71 @@
+#include <atomic>
+#include <bit>
+#include <chrono>
 #include <utility>
 
 #include "ExclusivePending.h"
 
+#include "ChordMachine.h"
+#include "ChordTiming.h"
 #include "Config/Config.h"
+#include "Diagnostics/FlightRecorder.h"
+#include "Diagnostics/Latency.h"
+#include "Diagnostics/Trace.h"
 #include "HotkeyCache.h"
 #include "PCH.h"
 #include "ReplaySystem.h"
+#include "State/State.h"
+#include "State/Timers.h"
 
 namespace Input::detail {
 
     namespace {
-        inline void AtomicFetchOrU64(std::atomic<std::uint64_t>& a, std::uint64_t bits,
-                                     std::memory_order order = std::memory_order_relaxed) {
-            std::uint64_t cur = a.load(order);
-            while (!a.compare_exchange_weak(cur, (cur | bits), order, order));
+        std::atomic<std::uint64_t> g_retainedOverflow{0};
+
+        void SpeculatePreEquip(int slot) {
+            if (IntegratedMagic::GetMagicConfig().speculativePreEquipPatch)
+                IntegratedMagic::MagicState::Get().PreEquipSlot(slot);
         }
 
-        template <class DownArr, class KeepArr, class CodesArr>
-        inline void MarkKeepIfDown(const CodesArr& codes, const DownArr& down, KeepArr& keep) {
-            for (int code : codes) {
-                if (code < 0 || code >= kMaxCode) continue;
-                const auto idx = static_cast<std::size_t>(code);
-                if (down[idx].load(std::memory_order_relaxed)) keep[idx] = true;
-            }
+        void CloseSimWindow(std::size_t s) {
+            g_slots[s].simWindowActive = false;
+            IntegratedMagic::Timers::Cancel(IntegratedMagic::Timers::Timer::SimWindow, static_cast<std::uint32_t>(s));
         }
 
         bool ComputeAcceptedExclusive(int slot, const SlotHotkeys& hk, bool prevAccepted, bool kbNow, bool gpNow,
-                                      bool rawNow, float dt) {
+                                      bool rawNow) {
             const auto s = static_cast<std::size_t>(slot);
+            auto& st = g_slots[s];
 
-            const bool kbPrev = g_prevRawKbDown[s];
-            const bool gpPrev = g_prevRawGpDown[s];
-            g_prevRawKbDown[s] = kbNow;
-            g_prevRawGpDown[s] = gpNow;
+            const bool kbPrev = st.prevRawKbDown;
+            const bool gpPrev = st.prevRawGpDown;
+            st.prevRawKbDown = kbNow;
+            st.prevRawGpDown = gpNow;
 
             const auto& cfg = IntegratedMagic::GetMagicConfig();
             const bool requireExcl = cfg.requireExclusiveHotkeyPatch;
 
             {
-                const bool anyComboNow = AnyComboKeyDown(hk.kb, g_kbDown) || AnyComboKeyDown(hk.gp, g_gpDown);
-                const bool prevAnyDown = g_prevAnyKeyDown[s];
-                g_prevAnyKeyDown[s] = anyComboNow;
+                const bool anyComboNow = AnyComboKeyDown(hk.kbMask, g_kbDown) || AnyComboKeyDown(hk.gpMask, g_gpDown);
+                const bool prevAnyDown = st.prevAnyKeyDown;
+                st.prevAnyKeyDown = anyComboNow;
 
                 if (!anyComboNow) {
-                    g_simWindowActive[s] = false;
-                    g_simWindowRemaining[s] = 0.f;
+                    CloseSimWindow(s);
                 } else if (anyComboNow && !prevAnyDown) {
                     if (g_replay[s].skipNextSimWindowOpen) {
                         g_replay[s].skipNextSimWindowOpen = false;
-#ifdef DEBUG
-                        spdlog::info("[Input] ComputeAcceptedExclusive: slot={} sim-window SKIPPED (re-enqueued DOWN)",
-                                     slot);
-#endif
+                        IM_TRACE(Input,
+                                 "[Input] ComputeAcceptedExclusive: slot={} sim-window SKIPPED (re-enqueued DOWN)",
+                                 slot);
                     } else {
-                        g_simWindowActive[s] = true;
-                        g_simWindowRemaining[s] = kExclusiveConfirmDelaySec;
-#ifdef DEBUG
-                        spdlog::info("[Input] ComputeAcceptedExclusive: slot={} sim-window OPENED ({:.2f}s)", slot,
-                                     kExclusiveConfirmDelaySec);
-#endif
-                    }
-                } else if (g_simWindowActive[s]) {
-                    g_simWindowRemaining[s] -= dt;
-                    if (g_simWindowRemaining[s] <= 0.f) {
-                        g_simWindowActive[s] = false;
-#ifdef DEBUG
-                        spdlog::info("[Input] ComputeAcceptedExclusive: slot={} sim-window EXPIRED", slot);
-#endif
+                        const float simSec =
+                            SimWindowSec(s, AnyComboKeyDown(hk.kbMask, g_kbDown) ? PendingSrc::Kb : PendingSrc::Gp);
+                        st.simWindowActive = true;
+                        IntegratedMagic::Timers::Arm(IntegratedMagic::Timers::Timer::SimWindow,
+                                                     static_cast<std::uint32_t>(s), simSec);
+                        IM_TRACE(Input, "[Input] ComputeAcceptedExclusive: slot={} sim-window OPENED ({:.3f}s)", slot,
+                                 simSec);
                     }
                 }
             }
@@ -77,92 +76,80 @@ namespace Input::detail {
             }
 
             if (HasExclusivePending(s)) {
-                const auto src = g_exclusivePendingSrc[s];
+                const auto src = st.pendingSrc;
                 const bool stillDown = (src == PendingSrc::Kb) ? kbNow : gpNow;
 
-                const bool srcIsMulti = (src == PendingSrc::Kb) ? g_slotIsKbMultiKey[s] : g_slotIsGpMultiKey[s];
+                const bool srcIsMulti = (src == PendingSrc::Kb) ? st.isKbMultiKey : st.isGpMultiKey;
                 const bool simPatch = cfg.pressBothAtSamePatch && srcIsMulti;
 
                 if (requireExcl && srcIsMulti) {
                     const bool stillExcl =
                         (src == PendingSrc::Kb)
-                            ? ComboExclusiveNow(hk.kb, g_kbDown, IsAllowedExtra_Keyboard_MoveOrCamera)
-                            : ComboExclusiveNow(hk.gp, g_gpDown, IsAllowedExtra_Gamepad_MoveOrCamera);
+                            ? ComboExclusiveNow(hk.kbMask, hk.kbExclusiveMask, g_kbDown)
+                            : ComboExclusiveNow(hk.gpMask, hk.gpExclusiveMask, g_gpDown);
                     if (!stillExcl) {
-#ifdef DEBUG
-                        spdlog::info(
-                            "[Input] ComputeAcceptedExclusive: slot={} pending CANCELLED (no longer exclusive)", slot);
-#endif
+                        IM_TRACE(Input,
+                                 "[Input] ComputeAcceptedExclusive: slot={} pending CANCELLED (no longer exclusive)",
+                                 slot);
                         ClearExclusivePending(s, ClearReason::Cancelled);
                         return false;
                     }
                 }
 
                 if (srcIsMulti) {
-                    if (stillDown && !g_slotFullComboSeen[s]) {
-                        if (simPatch && !g_simWindowActive[s]) {
-#ifdef DEBUG
-                            spdlog::info(
+                    if (stillDown && !st.fullComboSeen) {
+                        if (simPatch && !st.simWindowActive) {
+                            IM_TRACE(
+                                Input,
                                 "[Input] ComputeAcceptedExclusive: slot={} full combo REJECTED by sim-window (expired)",
                                 slot);
-#endif
                             ClearExclusivePending(s, ClearReason::Cancelled);
                             return false;
                         }
-                        g_slotFullComboSeen[s] = true;
-                        g_exclusivePendingTimer[s] = kExclusiveConfirmDelaySec;
-#ifdef DEBUG
-                        spdlog::info(
-                            "[Input] ComputeAcceptedExclusive: slot={} multi-key full combo seen, timer reset to "
-                            "{:.3f}s",
-                            slot, kExclusiveConfirmDelaySec);
-#endif
+                        st.fullComboSeen = true;
+                        ArmExclusiveConfirm(s);
+                        SpeculatePreEquip(slot);
+                        IM_TRACE(Input,
+                                 "[Input] ComputeAcceptedExclusive: slot={} multi-key full combo seen, timer reset to "
+                                 "{:.3f}s",
+                                 slot, ConfirmWindowSec(s, src));
                     }
 
                     if (!stillDown) {
-                        if (g_slotFullComboSeen[s]) {
-#ifdef DEBUG
-                            spdlog::info(
-                                "[Input] ComputeAcceptedExclusive: slot={} multi-key released after full combo -> "
-                                "ACCEPTED",
-                                slot);
-#endif
+                        if (st.fullComboSeen) {
+                            IM_TRACE(Input,
+                                     "[Input] ComputeAcceptedExclusive: slot={} multi-key released after full combo -> "
+                                     "ACCEPTED",
+                                     slot);
                             DiscardExclusivePending(s);
                             return true;
                         }
 
-                        if (const bool anyHeld = (src == PendingSrc::Gp) ? AnyComboKeyDown(hk.gp, g_gpDown)
-                                                                         : AnyComboKeyDown(hk.kb, g_kbDown);
+                        if (const bool anyHeld = (src == PendingSrc::Gp) ? AnyComboKeyDown(hk.gpMask, g_gpDown)
+                                                                         : AnyComboKeyDown(hk.kbMask, g_kbDown);
                             anyHeld) {
-                            g_exclusivePendingTimer[s] -= dt;
-                            if (g_exclusivePendingTimer[s] <= 0.0f) {
-#ifdef DEBUG
-                                spdlog::info(
-                                    "[Input] ComputeAcceptedExclusive: slot={} multi-key partial hold TIMEOUT -> "
-                                    "Cancelled",
-                                    slot);
-#endif
+                            if (ExclusiveConfirmDue(s)) {
+                                IM_TRACE(Input,
+                                         "[Input] ComputeAcceptedExclusive: slot={} multi-key partial hold TIMEOUT -> "
+                                         "Cancelled",
+                                         slot);
                                 ClearExclusivePending(s, ClearReason::Cancelled);
                             }
                             return false;
                         }
-#ifdef DEBUG
-                        spdlog::info(
-                            "[Input] ComputeAcceptedExclusive: slot={} multi-key all released without full combo -> "
-                            "Cancelled",
-                            slot);
-#endif
+                        IM_TRACE(Input,
+                                 "[Input] ComputeAcceptedExclusive: slot={} multi-key all released without full "
+                                 "combo -> Cancelled",
+                                 slot);
                         ClearExclusivePending(s, ClearReason::Cancelled);
                         return false;
                     }
 
-                    g_exclusivePendingTimer[s] -= dt;
-                    if (g_exclusivePendingTimer[s] <= 0.0f) {
-#ifdef DEBUG
-                        spdlog::info(
+                    if (ExclusiveConfirmDue(s)) {
+                        IM_TRACE(
+                            Input,
                             "[Input] ComputeAcceptedExclusive: slot={} multi-key timer elapsed -> Success (held down)",
                             slot);
-#endif
                         ClearExclusivePending(s, ClearReason::Success);
                         return true;
                     }
@@ -170,18 +157,14 @@ namespace Input::detail {
 
                 } else {
                     if (!stillDown) {
-#ifdef DEBUG
-                        spdlog::info("[Input] ComputeAcceptedExclusive: slot={} single-key released -> ACCEPTED", slot);
-#endif
+                        IM_TRACE(Input, "[Input] ComputeAcceptedExclusive: slot={} single-key released -> ACCEPTED",
+                                 slot);
                         DiscardExclusivePending(s);
                         return true;
                     }
-                    g_exclusivePendingTimer[s] -= dt;
-                    if (g_exclusivePendingTimer[s] <= 0.0f) {
-#ifdef DEBUG
-                        spdlog::info("[Input] ComputeAcceptedExclusive: slot={} single-key timer elapsed -> Success",
-                                     slot);
-#endif
+                    if (ExclusiveConfirmDue(s)) {
+                        IM_TRACE(Input, "[Input] ComputeAcceptedExclusive: slot={} single-key timer elapsed -> Success",
+                                 slot);
                         ClearExclusivePending(s, ClearReason::Success);
                         return true;
                     }
@@ -193,57 +176,67 @@ namespace Input::detail {
             const bool gpEdge = gpNow && !gpPrev;
 
             if (kbEdge) {
-                const bool kbIsMulti = g_slotIsKbMultiKey[s];
-                const bool kbExclOk = !requireExcl || !kbIsMulti ||
-                                      ComboExclusiveNow(hk.kb, g_kbDown, IsAllowedExtra_Keyboard_MoveOrCamera);
+                const bool kbIsMulti = st.isKbMultiKey;
+                const bool kbExclOk =
+                    !requireExcl || !kbIsMulti || ComboExclusiveNow(hk.kbMask, hk.kbExclusiveMask, g_kbDown);
                 if (kbExclOk) {
                     if (const bool kbSimPatch = cfg.pressBothAtSamePatch && kbIsMulti;
-                        kbSimPatch && !g_simWindowActive[s]) {
-#ifdef DEBUG
-                        spdlog::info(
-                            "[Input] ComputeAcceptedExclusive: slot={} KB edge REJECTED by sim-window "
-                            "(expired/inactive)",
-                            slot);
-#endif
+                        kbSimPatch && !st.simWindowActive) {
+                        IM_TRACE(Input,
+                                 "[Input] ComputeAcceptedExclusive: slot={} KB edge REJECTED by sim-window "
+                                 "(expired/inactive)",
+                                 slot);
                         return false;
                     }
-#ifdef DEBUG
-                    spdlog::info(
-                        "[Input] ComputeAcceptedExclusive: slot={} KB edge detected, starting exclusive pending "
-                        "(kbIsMulti={})",
-                        slot, kbIsMulti);
-#endif
-                    g_exclusivePendingSrc[s] = PendingSrc::Kb;
-                    g_exclusivePendingTimer[s] = kExclusiveConfirmDelaySec;
-                    if (kbIsMulti) g_slotFullComboSeen[s] = true;
+                    if (g_kbUnambiguous & (1uLL << slot)) {
+                        IM_TRACE(Input,
+                                 "[Input] ComputeAcceptedExclusive: slot={} KB edge ACCEPTED (unambiguous combo)",
+                                 slot);
+                        return true;
+                    }
+                    IM_TRACE(Input,
+                             "[Input] ComputeAcceptedExclusive: slot={} KB edge detected, starting exclusive pending "
+                             "(kbIsMulti={})",
+                             slot, kbIsMulti);
+                    st.pendingSrc = PendingSrc::Kb;
+                    ArmExclusiveConfirm(s);
+                    if (kbIsMulti) {
+                        st.fullComboSeen = true;
+                        SpeculatePreEquip(slot);
+                    }
                     return false;
                 }
             }
 
             if (gpEdge) {
-                const bool gpIsMulti = g_slotIsGpMultiKey[s];
-                const bool gpExclOk = !requireExcl || !gpIsMulti ||
-                                      ComboExclusiveNow(hk.gp, g_gpDown, IsAllowedExtra_Gamepad_MoveOrCamera);
+                const bool gpIsMulti = st.isGpMultiKey;
+                const bool gpExclOk =
+                    !requireExcl || !gpIsMulti || ComboExclusiveNow(hk.gpMask, hk.gpExclusiveMask, g_gpDown);
                 if (gpExclOk) {
                     if (const bool gpSimPatch = cfg.pressBothAtSamePatch && gpIsMulti;
-                        gpSimPatch && !g_simWindowActive[s]) {
-#ifdef DEBUG
-                        spdlog::info(
-                            "[Input] ComputeAcceptedExclusive: slot={} GP edge REJECTED by sim-window "
-                            "(expired/inactive)",
-                            slot);
-#endif
+                        gpSimPatch && !st.simWindowActive) {
+                        IM_TRACE(Input,
+                                 "[Input] ComputeAcceptedExclusive: slot={} GP edge REJECTED by sim-window "
+                                 "(expired/inactive)",
+                                 slot);
                         return false;
                     }
-#ifdef DEBUG
-                    spdlog::info(
-                        "[Input] ComputeAcceptedExclusive: slot={} GP edge detected, starting exclusive pending "
-                        "(gpIsMulti={})",
-                        slot, gpIsMulti);
-#endif
-                    g_exclusivePendingSrc[s] = PendingSrc::Gp;
-                    g_exclusivePendingTimer[s] = kExclusiveConfirmDelaySec;
-                    if (gpIsMulti) g_slotFullComboSeen[s] = true;
+                    if (g_gpUnambiguous & (1uLL << slot)) {
+                        IM_TRACE(Input,
+                                 "[Input] ComputeAcceptedExclusive: slot={} GP edge ACCEPTED (unambiguous combo)",
+                                 slot);
+                        return true;
+                    }
+                    IM_TRACE(Input,
+                             "[Input] ComputeAcceptedExclusive: slot={} GP edge detected, starting exclusive pending "
+                             "(gpIsMulti={})",
+                             slot, gpIsMulti);
+                    st.pendingSrc = PendingSrc::Gp;
+                    ArmExclusiveConfirm(s);
+                    if (gpIsMulti) {
+                        st.fullComboSeen = true;
+                        SpeculatePreEquip(slot);
+                    }
                     return false;
                 }
             }
@@ -252,84 +245,153 @@ namespace Input::detail {
         }
     }
 
-    void DiscardExclusivePending(std::size_t s) {
-        if (g_exclusivePendingSrc[s] != PendingSrc::None || !g_retainedEvents[s].empty()) {
 #ifdef DEBUG
-            spdlog::info("[Input] DiscardExclusivePending: slot={} (had pending src={} retained={})", s,
-                         static_cast<int>(std::to_underlying(g_exclusivePendingSrc[s])), g_retainedEvents[s].size());
+    namespace {
+        std::uint64_t g_dbgComboSeen{0};
+        std::array<std::uint8_t, kMaxSlots> g_dbgDownWithoutKeys{};
+
+        void CheckSlotInvariants(int slot, bool rawNow, bool prevAcc, bool accNow) {
+            const auto s = static_cast<std::size_t>(slot);
+            const auto bit = 1uLL << slot;
+            const auto& hk = g_cache[s];
+            const bool anyKey = AnyComboKeyDown(hk.kbMask, g_kbDown) || AnyComboKeyDown(hk.gpMask, g_gpDown);
+
+            if (rawNow) g_dbgComboSeen |= bit;
+            if (accNow && !prevAcc && !(g_dbgComboSeen & bit))
+                spdlog::warn("[Input] Invariant: slot={} accepted without its combo ever fully down", slot);
+
+            auto& idle = g_dbgDownWithoutKeys[s];
+            idle = (accNow && !anyKey) ? static_cast<std::uint8_t>(idle < 255 ? idle + 1 : idle) : 0;
+            if (idle == 2) spdlog::warn("[Input] Invariant: slot={} still down after all combo keys released", slot);
+
+            if (!anyKey && !accNow) g_dbgComboSeen &= ~bit;
+
+            if (!g_retainedEvents[s].empty() && !HasExclusivePending(s))
+                spdlog::warn("[Input] Invariant: slot={} holds {} retained event(s) with no pending", slot,
+                             g_retainedEvents[s].size());
+        }
+
+        void CheckQueueInvariants() {
+            static bool s_reported = false;
+            std::size_t total = 0;
+            bool maskOk = true;
+            for (std::size_t s = 0; s < kMaxSlots; ++s) {
+                total += g_deferred.perSlot[s];
+                maskOk = maskOk && ((g_deferred.perSlot[s] > 0) == (((g_deferred.slotMask >> s) & 1uLL) != 0));
+            }
+            const bool strayDown = (g_slotDown.load(std::memory_order_relaxed) & ~ActiveSlotMask()) != 0;
+            const bool ok = (total == g_deferred.count) && maskOk && !strayDown;
+            if (!ok && !s_reported) {
+                spdlog::warn("[Input] Invariant: deferred count={} perSlot total={} slotMask consistent={} "
+                             "stray slotDown={}",
+                             g_deferred.count, total, maskOk, strayDown);
+            }
+            s_reported = !ok;
+        }
+    }
 #endif
+
+    void RegisterExclusiveTimers() {
+        using IntegratedMagic::Timers::Timer;
+        IntegratedMagic::Timers::SetHandler(Timer::ExclusiveConfirm,
+                                            [](std::uint32_t s) { g_exclusiveConfirmDue |= (1uLL << s); });
+        IntegratedMagic::Timers::SetHandler(Timer::SimWindow, [](std::uint32_t s) {
+            g_slots[s].simWindowActive = false;
+            IM_TRACE(Input, "[Input] ComputeAcceptedExclusive: slot={} sim-window EXPIRED", s);
+        });
+    }
+
+    void ArmExclusiveConfirm(std::size_t s) {
+        namespace FR = IntegratedMagic::FlightRecorder;
+        g_exclusiveConfirmDue &= ~(1uLL << s);
+        const float window = ConfirmWindowSec(s, g_slots[s].pendingSrc);
+        IntegratedMagic::Timers::Arm(IntegratedMagic::Timers::Timer::ExclusiveConfirm, static_cast<std::uint32_t>(s),
+                                     window);
+        FR::Record(FR::Event::PendingArm, static_cast<int>(s), FR::kNoHand, std::to_underlying(g_slots[s].pendingSrc),
+                   static_cast<std::uint32_t>(window * 1000.f));
+    }
+
+    void CancelExclusiveConfirm(std::size_t s) {
+        g_exclusiveConfirmDue &= ~(1uLL << s);
+        IntegratedMagic::Timers::Cancel(IntegratedMagic::Timers::Timer::ExclusiveConfirm,
+                                        static_cast<std::uint32_t>(s));
+    }
+
+    void DiscardExclusivePending(std::size_t s) {
+        if (g_slots[s].pendingSrc != PendingSrc::None || !g_retainedEvents[s].empty()) {
+            IM_TRACE(Input, "[Input] DiscardExclusivePending: slot={} (had pending src={} retained={})", s,
+                     static_cast<int>(std::to_underlying(g_slots[s].pendingSrc)), g_retainedEvents[s].size());
         }
         g_retainedEvents[s].clear();
         ClearDeferredReplayEventsForSlot(s);
-        g_exclusivePendingSrc[s] = PendingSrc::None;
-        g_exclusivePendingTimer[s] = 0.0f;
-        g_slotFullComboSeen[s] = false;
+        g_slots[s].pendingSrc = PendingSrc::None;
+        CancelExclusiveConfirm(s);
+        g_slots[s].fullComboSeen = false;
         ResetReplayState(s);
     }
 
     void ClearExclusivePending(std::size_t s, ClearReason reason) {
-#ifdef DEBUG
-        const char* reasonStr = (reason == ClearReason::Success)   ? "Success"
-                                : (reason == ClearReason::Timeout) ? "Timeout"
-                                                                   : "Cancelled";
-        spdlog::info("[Input] ClearExclusivePending: slot={} reason={} retainedEvents={}", s, reasonStr,
-                     g_retainedEvents[s].size());
-#endif
+        namespace FR = IntegratedMagic::FlightRecorder;
+        FR::Record(FR::Event::PendingClear, static_cast<int>(s), FR::kNoHand,
+                   static_cast<std::uint8_t>(std::to_underlying(reason)));
+        IM_TRACE(Input, "[Input] ClearExclusivePending: slot={} reason={} retainedEvents={}", s,
+                 (reason == ClearReason::Success)   ? "Success"
+                 : (reason == ClearReason::Timeout) ? "Timeout"
+                                                    : "Cancelled",
+                 g_retainedEvents[s].size());
         if (reason != ClearReason::Success) {
-            g_simWindowActive[s] = false;
-            g_simWindowRemaining[s] = 0.f;
+            if (auto& ms = IntegratedMagic::MagicState::Get(); ms.PreEquippedSlot() == static_cast<int>(s))
+                ms.CancelPreEquip();
+            CloseSimWindow(s);
             ClearDeferredReplayEventsForSlot(s);
             ResetReplayState(s);
-            for (auto const& ev : g_retainedEvents[s]) {
-#ifdef DEBUG
-                spdlog::info("[Input] ClearExclusivePending: slot={} queue replay dev={} value={:.2f} heldSecs={:.3f}",
-                             s, static_cast<int>(ev.dev), ev.value, ev.heldSecs);
-#endif
-                QueueDeferredReplayEvent(s, ev);
+            for (auto& ev : g_retainedEvents[s]) {
+                IM_TRACE(Input,
+                         "[Input] ClearExclusivePending: slot={} queue replay dev={} value={:.2f} heldSecs={:.3f}", s,
+                         static_cast<int>(ev.dev), ev.value, ev.heldSecs);
+                QueueDeferredReplayEvent(s, std::move(ev));
             }
         } else {
             ClearDeferredReplayEventsForSlot(s);
             ResetReplayState(s);
         }
         g_retainedEvents[s].clear();
-        g_exclusivePendingSrc[s] = PendingSrc::None;
-        g_exclusivePendingTimer[s] = 0.0f;
-        g_slotFullComboSeen[s] = false;
+        g_slots[s].pendingSrc = PendingSrc::None;
+        CancelExclusiveConfirm(s);
+        g_slots[s].fullComboSeen = false;
     }
 
     void ClearEdgeStateOnly() {
         const int n = ActiveSlots();
         for (int slot = 0; slot < n; ++slot) {
             const auto s = static_cast<std::size_t>(slot);
-            g_slotDown[s].store(false, std::memory_order_relaxed);
-            g_slotWasAccepted[s] = false;
-            g_slotFullComboSeen[s] = false;
-            g_prevRawKbDown[s] = false;
-            g_prevRawGpDown[s] = false;
-            g_prevAnyKeyDown[s] = false;
-            g_simWindowActive[s] = false;
-            g_simWindowRemaining[s] = 0.f;
+            g_slots[s].wasAccepted = false;
+            g_slots[s].fullComboSeen = false;
+            g_slots[s].prevRawKbDown = false;
+            g_slots[s].prevRawGpDown = false;
+            g_slots[s].prevAnyKeyDown = false;
+            CloseSimWindow(s);
             DiscardExclusivePending(s);
         }
+        ResetSlotTriggers();
+        g_slotDown.store(0uLL, std::memory_order_relaxed);
         g_pressedMask.store(0uLL, std::memory_order_relaxed);
         g_releasedMask.store(0uLL, std::memory_order_relaxed);
     }
 
     void ClearLikelyStuckKeysAfterMenuClose() {
-        std::array<bool, kMaxCode> keepKb{};
-        std::array<bool, kMaxCode> keepGp{};
+        KeyMask keepKb{};
+        KeyMask keepGp{};
         const int n = ActiveSlots();
         for (int slot = 0; slot < n; ++slot) {
             const auto& hk = g_cache[static_cast<std::size_t>(slot)];
-            MarkKeepIfDown(hk.kb, g_kbDown, keepKb);
-            MarkKeepIfDown(hk.gp, g_gpDown, keepGp);
-        }
-        for (int i = 0; i < kMaxCode; ++i) {
-            const auto idx = static_cast<std::size_t>(i);
-            if (!keepKb[idx]) g_kbDown[idx].store(false, std::memory_order_relaxed);
-            if (!keepGp[idx]) g_gpDown[idx].store(false, std::memory_order_relaxed);
+            keepKb |= hk.kbMask;
+            keepGp |= hk.gpMask;
         }
-        g_kbDown[static_cast<std::size_t>(kDIK_Escape)].store(false, std::memory_order_relaxed);
+        g_kbDown.KeepOnly(keepKb);
+        g_gpDown.KeepOnly(keepGp);
+        g_kbDown.Store(kDIK_Escape, false);
+        RebuildChordState();
         ClearEdgeStateOnly();
     }
 
@@ -337,54 +399,184 @@ namespace Input::detail {
         const int n = ActiveSlots();
         for (int slot = 0; slot < n; ++slot) {
             const auto s = static_cast<std::size_t>(slot);
-            g_prevRawKbDown[s] = false;
-            g_prevRawGpDown[s] = false;
-            g_prevAnyKeyDown[s] = false;
-            g_simWindowActive[s] = false;
-            g_simWindowRemaining[s] = 0.f;
+            g_slots[s].prevRawKbDown = false;
+            g_slots[s].prevRawGpDown = false;
+            g_slots[s].prevAnyKeyDown = false;
+            CloseSimWindow(s);
             DiscardExclusivePending(s);
-            g_slotDown[s].store(false, std::memory_order_relaxed);
-            g_slotWasAccepted[s] = false;
+            g_slots[s].wasAccepted = false;
         }
+        ResetSlotTriggers();
+        g_slotDown.store(0uLL, std::memory_order_relaxed);
         g_pressedMask.store(0uLL, std::memory_order_relaxed);
         g_releasedMask.store(0uLL, std::memory_order_relaxed);
     }
 
-    void RecomputeSlotEdges(float dt) {
+    void SettlePreEquip() {
+        auto& ms = IntegratedMagic::MagicState::Get();
+        const int slot = ms.PreEquippedSlot();
+        if (slot < 0) return;
+        const auto s = static_cast<std::size_t>(slot);
+        if (slot < ActiveSlots() && (HasExclusivePending(s) || IsSlotDown(s))) return;
+        ms.CancelPreEquip();
+    }
+
+    namespace {
+        bool FilterBoundEvent(std::uint64_t slotsForCode, RE::INPUT_DEVICE dev, int code, std::uint32_t rawIdCode,
+                              const RE::BSFixedString& userEvent, float value, float heldSecs) {
+            const bool isGpDev = (dev == RE::INPUT_DEVICE::kGamepad);
+            const std::uint64_t downMask = g_slotDown.load(std::memory_order_relaxed);
+            const std::uint64_t chordDown = isGpDev ? ChordGpDownMask() : ChordKbDownMask();
+            for (auto pending = slotsForCode; pending; pending &= (pending - 1)) {
+                const int slot = std::countr_zero(pending);
+                const auto s = static_cast<std::size_t>(slot);
+
+                if (downMask & (1uLL << slot)) return true;
+
+                if (g_slots[s].wasAccepted) {
+                    IM_TRACE(Input, "[Input] ShouldFilterAndSave: slot={} code={} dev={} FILTERED (wasAccepted)",
+                             slot, code, static_cast<int>(dev));
+                    return true;
+                }
+
+                if (chordDown & (1uLL << slot)) return true;
+
+                if (ReplayMatchesEvent(s, dev, rawIdCode, userEvent, value)) {
+                    IM_TRACE(Input, "[Input] ShouldFilterAndSave: slot={} code={} replay PASS-THROUGH", slot, code);
+                    ConsumeReplayEvent(s);
+                    return false;
+                }
+
+                if (g_slots[s].isMultiKey && !HasExclusivePending(s)) {
+                    if ((isGpDev ? g_gpUnambiguous : g_kbUnambiguous) & (1uLL << slot)) continue;
+                    const bool simPatch = IntegratedMagic::GetMagicConfig().pressBothAtSamePatch;
+                    const bool replayInProgress = g_replay[s].Armed() || HasDeferredReplayForSlot(s);
+                    if ((simPatch && !g_slots[s].simWindowActive) || replayInProgress) continue;
+
+                    if (const bool sharedWithActiveSlot = (slotsForCode & ~(1uLL << slot) & downMask) != 0uLL;
+                        sharedWithActiveSlot)
+                        return true;
+
+                    IM_TRACE(Input,
+                             "[Input] ShouldFilterAndSave: slot={} code={} starting exclusive pending (multiKey, no "
+                             "pending yet)",
+                             slot, code);
+                    g_slots[s].pendingSrc = isGpDev ? PendingSrc::Gp : PendingSrc::Kb;
+                    ArmExclusiveConfirm(s);
+#ifdef DEBUG
+                    if (!(isGpDev ? g_slots[s].isGpMultiKey : g_slots[s].isKbMultiKey)) g_dbgComboSeen |= 1uLL << slot;
+#endif
+                }
+
+                if (HasExclusivePending(s)) {
+                    IM_TRACE(Input,
+                             "[Input] ShouldFilterAndSave: slot={} code={} RETAINED (exclusive pending, value={:.2f}, "
+                             "heldSecs={:.3f})",
+                             slot, code, value, heldSecs);
+                    if (g_retainedEvents[s].Push(dev, code, rawIdCode, userEvent, value, heldSecs)) return true;
+                    g_retainedOverflow.fetch_add(1, std::memory_order_relaxed);
+                    IM_TRACE(Input,
+                             "[Input] ShouldFilterAndSave: slot={} retained buffer full, passing through code={}", slot,
+                             code);
+                    return false;
+                }
+            }
+            return false;
+        }
+    }
+
+    std::uint64_t RetainedOverflowCount() { return g_retainedOverflow.load(std::memory_order_relaxed); }
+
+    bool ShouldFilterAndSave(RE::INPUT_DEVICE dev, int convertedCode, std::uint32_t rawIdCode,
+                             const RE::BSFixedString& userEvent, float value, float heldSecs) {
+        if (dev != RE::INPUT_DEVICE::kKeyboard && dev != RE::INPUT_DEVICE::kMouse &&
+            dev != RE::INPUT_DEVICE::kGamepad)
+            return false;
+
+        const int code = (dev == RE::INPUT_DEVICE::kMouse) ? (kMouseButtonBase + convertedCode) : convertedCode;
+        if (code < 0 || code >= kMaxCode) return false;
+
+        const auto& slotsByCode = (dev == RE::INPUT_DEVICE::kGamepad) ? g_gpSlotsByCode : g_kbSlotsByCode;
+        const std::uint64_t slotsForCode = slotsByCode[static_cast<std::size_t>(code)] & ActiveSlotMask();
+
+        auto& engineDown = EngineDownState(dev);
+        if (value == 0.f && engineDown.Store(code, false)) {
+            IM_TRACE(Input, "[Input] ShouldFilterAndSave: code={} dev={} release PASS-THROUGH (game saw the press)",
+                     code, static_cast<int>(dev));
+            for (auto m = slotsForCode; m; m &= (m - 1)) g_retainedEvents[std::countr_zero(m)].Erase(dev, rawIdCode);
+            ClearDeferredReplayEventsForKey(dev, rawIdCode);
+            return false;
+        }
+
+        for (auto m = slotsForCode; m; m &= (m - 1)) {
+            auto& retained = g_retainedEvents[std::countr_zero(m)];
+            if (retained.Holds(dev, rawIdCode) && retained.Push(dev, code, rawIdCode, userEvent, value, heldSecs))
+                return true;
+        }
+        if (const auto queued = slotsForCode & g_deferred.slotMask) {
+            const auto s = static_cast<std::size_t>(std::countr_zero(queued));
+            IM_TRACE(Input, "[Input] ShouldFilterAndSave: slot={} code={} queued behind pending replay", s, code);
+            QueueDeferredReplayEvent(s, RetainedEvent{dev, code, rawIdCode, userEvent, value, heldSecs});
+            return true;
+        }
+        if (slotsForCode != 0uLL && FilterBoundEvent(slotsForCode, dev, code, rawIdCode, userEvent, value, heldSecs))
+            return true;
+        if (value > 0.f) engineDown.Store(code, true);
+        return false;
+    }
+
+    void RecomputeSlotEdges() {
         auto const& cfg = IntegratedMagic::GetMagicConfig();
         const int n = ActiveSlots();
+        const std::uint64_t kbDownMask = ChordKbDownMask();
+        const std::uint64_t gpDownMask = ChordGpDownMask();
+        const auto now = std::chrono::steady_clock::now();
         for (int slot = 0; slot < n; ++slot) {
             const auto s = static_cast<std::size_t>(slot);
             const auto& hk = g_cache[s];
-            const bool kbNow = ComboDown(hk.kb, g_kbDown);
-            const bool gpNow = ComboDown(hk.gp, g_gpDown);
+            auto& st = g_slots[s];
+            const auto bit = 1uLL << slot;
+            const bool triggered = ApplySlotTrigger(s, ((kbDownMask | gpDownMask) & bit) != 0);
+            const bool kbNow = triggered && (kbDownMask & bit);
+            const bool gpNow = triggered && (gpDownMask & bit);
             const bool rawNow = kbNow || gpNow;
-            const bool prevAcc = g_slotDown[s].load(std::memory_order_relaxed);
+            const bool prevAcc = IsSlotDown(s);
 
             bool accNow = false;
-            if (cfg.requireExclusiveHotkeyPatch || g_slotIsMultiKey[s]) {
-                accNow = ComputeAcceptedExclusive(slot, hk, prevAcc, kbNow, gpNow, rawNow, dt);
+            if (cfg.requireExclusiveHotkeyPatch || st.isMultiKey) {
+                accNow = ComputeAcceptedExclusive(slot, hk, prevAcc, kbNow, gpNow, rawNow);
             } else {
-                g_prevRawKbDown[s] = kbNow;
-                g_prevRawGpDown[s] = gpNow;
+                st.prevRawKbDown = kbNow;
+                st.prevRawGpDown = gpNow;
                 DiscardExclusivePending(s);
                 accNow = rawNow;
             }
 
+            if (st.isMultiKey) ObserveChordTiming(s, kbDownMask, gpDownMask, accNow, now);
+
             if (accNow != prevAcc) {
-#ifdef DEBUG
-                spdlog::info("[Input] RecomputeSlotEdges: slot={} EDGE {} (kb={} gp={} exclusive={} multiKey={})", slot,
-                             accNow ? "PRESSED" : "RELEASED", kbNow, gpNow, cfg.requireExclusiveHotkeyPatch,
-                             g_slotIsMultiKey[s]);
-#endif
-                g_slotDown[s].store(accNow, std::memory_order_relaxed);
-                AtomicFetchOrU64(accNow ? g_pressedMask : g_releasedMask, (1uLL << slot));
+                IM_TRACE(Input, "[Input] RecomputeSlotEdges: slot={} EDGE {} (kb={} gp={} exclusive={} multiKey={})",
+                         slot, accNow ? "PRESSED" : "RELEASED", kbNow, gpNow, cfg.requireExclusiveHotkeyPatch,
+                         st.isMultiKey);
+                SetSlotDown(s, accNow);
+                IntegratedMagic::FlightRecorder::Record(
+                    IntegratedMagic::FlightRecorder::Event::SlotEdge, slot, IntegratedMagic::FlightRecorder::kNoHand,
+                    accNow ? 1 : 0, (kbNow ? 1u : 0u) | (gpNow ? 2u : 0u));
+                (accNow ? g_pressedSeq : g_releasedSeq)[s] = ChordEdgeSeq(s);
+                (accNow ? g_pressedMask : g_releasedMask).fetch_or(bit, std::memory_order_relaxed);
+                if (accNow) IntegratedMagic::Latency::Mark(IntegratedMagic::Latency::Stage::Accepted);
             }
 
             if (accNow)
-                g_slotWasAccepted[s] = true;
+                st.wasAccepted = true;
             else if (!rawNow)
-                g_slotWasAccepted[s] = false;
+                st.wasAccepted = false;
+#ifdef DEBUG
+            CheckSlotInvariants(slot, rawNow, prevAcc, accNow);
+#endif
         }
+#ifdef DEBUG
+        CheckQueueInvariants();
+#endif
     }
 }
\ No newline at end of file
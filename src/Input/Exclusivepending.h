@@ -5,22 +5,20 @@
 namespace Input::detail {
 
     [[nodiscard]] inline bool HasExclusivePending(std::size_t s) {
-        return g_exclusivePendingSrc[s] != PendingSrc::None;
+        return g_slots[s].pendingSrc != PendingSrc::None;
     }
 
-    [[nodiscard]] inline bool IsAllowedExtra_Keyboard_MoveOrCamera(int code) {
-        switch (code) {
-            case kDIK_W:
-            case kDIK_A:
-            case kDIK_S:
-            case kDIK_D:
-                return true;
-            default:
-                return false;
-        }
-    }
+    [[nodiscard]] inline bool ExclusiveConfirmDue(std::size_t s) { return (g_exclusiveConfirmDue & (1uLL << s)) != 0; }
+
+    inline constexpr KeyMask kAllowedExtra_Keyboard_MoveOrCamera = MakeKeyMask({kDIK_W, kDIK_A, kDIK_S, kDIK_D});
+
+    inline constexpr KeyMask kAllowedExtra_Gamepad_MoveOrCamera{};
+
+    void RegisterExclusiveTimers();
 
-    [[nodiscard]] inline bool IsAllowedExtra_Gamepad_MoveOrCamera(int) { return false; }
+    void ArmExclusiveConfirm(std::size_t s);
+
+    void CancelExclusiveConfirm(std::size_t s);
 
     void DiscardExclusivePending(std::size_t s);
 
@@ -32,6 +30,14 @@ namespace Input::detail {
 
     void ResetExclusiveState();
 
-    void RecomputeSlotEdges(float dt);
+    void SettlePreEquip();
+
+    // Key events passed through because their slot's retained buffer was full.
+    [[nodiscard]] std::uint64_t RetainedOverflowCount();
+
+    [[nodiscard]] bool ShouldFilterAndSave(RE::INPUT_DEVICE dev, int convertedCode, std::uint32_t rawIdCode,
+                                           const RE::BSFixedString& userEvent, float value, float heldSecs);
+
+    void RecomputeSlotEdges();
 
 }
\ No newline at end of file
@@ -1,22 +1,125 @@
 #include "HotkeyCache.h"
 
 #include <algorithm>
+#include <mutex>
 #include <ranges>
+#include <vector>
 
+#include "ChordMachine.h"
 #include "Config/Config.h"
+#include "Diagnostics/Trace.h"
+#include "ExclusivePending.h"
 #include "PCH.h"
 
 namespace Input::detail {
 
+    namespace {
+        std::mutex g_conflictsLock;
+        std::vector<HotkeyConflict> g_conflicts;
+
+        bool Collides(const KeyMask& a, const KeyMask& b) {
+            return !a.Empty() && !b.Empty() && (a.SubsetOf(b) || b.SubsetOf(a));
+        }
+
+        bool TimedTrigger(const IntegratedMagic::InputConfig& in) {
+            const auto t = static_cast<IntegratedMagic::HotkeyTrigger>(in.Trigger.load(std::memory_order_relaxed));
+            return t == IntegratedMagic::HotkeyTrigger::DoubleTap || t == IntegratedMagic::HotkeyTrigger::Hold;
+        }
+
+        void AnalyzeConflicts(int n, const KeyMask& kbModifier, const KeyMask& gpModifier) {
+            auto const& cfg = IntegratedMagic::GetMagicConfig();
+            std::vector<HotkeyConflict> conflicts;
+            std::uint64_t kbAmbiguous = 0;
+            std::uint64_t gpAmbiguous = 0;
+
+            const std::uint64_t active = (n >= 64) ? ~0uLL : ((1uLL << n) - 1uLL);
+
+            auto check = [&](int slot, int other, const KeyMask& a, const KeyMask& b, bool gamepad) {
+                if (!Collides(a, b)) return;
+                auto& ambiguous = gamepad ? gpAmbiguous : kbAmbiguous;
+                ambiguous |= 1uLL << slot;
+                if (other >= 0) ambiguous |= 1uLL << other;
+                conflicts.push_back({slot, other, gamepad});
+            };
+
+            auto checkModifierOnly = [&](int who, const KeyMask& combo, const KeyMask& modifier, bool gamepad) {
+                if (modifier.Empty() || combo.Empty() || !combo.Without(modifier).Empty()) return;
+                (gamepad ? gpAmbiguous : kbAmbiguous) |= active;
+                conflicts.push_back({who, HotkeyConflict::kModifier, gamepad});
+            };
+
+            // Any key of a multi-key combo can be the first one down, and a game control bound to it would fire
+            // before the combo completes unless the slot retains it.
+            const auto kbGame = GameControlKeys(false);
+            const auto gpGame = GameControlKeys(true);
+            auto checkGameControl = [&](int slot, const KeyMask& combo, const KeyMask& game, bool gamepad) {
+                if (combo.Count() < 2 || combo.Without(game).Count() == combo.Count()) return;
+                (gamepad ? gpAmbiguous : kbAmbiguous) |= 1uLL << slot;
+                conflicts.push_back({slot, HotkeyConflict::kGameControl, gamepad});
+            };
+
+            const auto hudKb = g_hudCache.kbMask.Without(kbModifier);
+            const auto hudGp = g_hudCache.gpMask.Without(gpModifier);
+            const auto bankKb = g_bankCache.kbMask.Without(kbModifier);
+            const auto bankGp = g_bankCache.gpMask.Without(gpModifier);
+
+            for (int i = 0; i < n; ++i) {
+                const auto& hk = g_cache[static_cast<std::size_t>(i)];
+                const auto kb = hk.kbMask.Without(kbModifier);
+                const auto gp = hk.gpMask.Without(gpModifier);
+                for (int j = i + 1; j < n; ++j) {
+                    const auto& other = g_cache[static_cast<std::size_t>(j)];
+                    check(i, j, kb, other.kbMask.Without(kbModifier), false);
+                    check(i, j, gp, other.gpMask.Without(gpModifier), true);
+                }
+                check(i, HotkeyConflict::kHudPopup, kb, hudKb, false);
+                check(i, HotkeyConflict::kHudPopup, gp, hudGp, true);
+                check(i, HotkeyConflict::kBankCycle, kb, bankKb, false);
+                check(i, HotkeyConflict::kBankCycle, gp, bankGp, true);
+                checkModifierOnly(i, hk.kbMask, kbModifier, false);
+                checkModifierOnly(i, hk.gpMask, gpModifier, true);
+                checkGameControl(i, hk.kbMask, kbGame, false);
+                checkGameControl(i, hk.gpMask, gpGame, true);
+                if (TimedTrigger(cfg.slotInput[static_cast<std::size_t>(i)])) {
+                    kbAmbiguous |= 1uLL << i;
+                    gpAmbiguous |= 1uLL << i;
+                }
+            }
+            checkModifierOnly(HotkeyConflict::kHudPopup, g_hudCache.kbMask, kbModifier, false);
+            checkModifierOnly(HotkeyConflict::kHudPopup, g_hudCache.gpMask, gpModifier, true);
+            checkModifierOnly(HotkeyConflict::kBankCycle, g_bankCache.kbMask, kbModifier, false);
+            checkModifierOnly(HotkeyConflict::kBankCycle, g_bankCache.gpMask, gpModifier, true);
+
+            g_kbUnambiguous = active & ~kbAmbiguous;
+            g_gpUnambiguous = active & ~gpAmbiguous;
+            IM_TRACE(Input, "[Input] AnalyzeConflicts: {} conflict(s), unambiguous kb={:#x} gp={:#x}",
+                     conflicts.size(), g_kbUnambiguous, g_gpUnambiguous);
+            const std::scoped_lock guard(g_conflictsLock);
+            g_conflicts = std::move(conflicts);
+        }
+
+        KeyMask ModifierMask(const IntegratedMagic::InputConfig& in, int pos, bool gamepad) {
+            KeyMask m{};
+            if (pos <= 0) return m;
+            const auto& field = gamepad ? (pos == 1   ? in.GamepadButton1
+                                           : pos == 2 ? in.GamepadButton2
+                                                      : in.GamepadButton3)
+                                        : (pos == 1   ? in.KeyboardScanCode1
+                                           : pos == 2 ? in.KeyboardScanCode2
+                                                      : in.KeyboardScanCode3);
+            m.Set(field.load(std::memory_order_relaxed));
+            return m;
+        }
+    }
+
     void LoadHotkeyCache_FromConfig() {
         auto const& cfg = IntegratedMagic::GetMagicConfig();
         const auto n = static_cast<int>(cfg.SlotCount());
         g_slotCount.store(n, std::memory_order_relaxed);
 
-        for (auto& s : g_cache) {
-            s.kb = {-1, -1, -1};
-            s.gp = {-1, -1, -1};
-        }
+        for (auto& s : g_cache) s = {};
+        g_kbSlotsByCode.fill(0uLL);
+        g_gpSlotsByCode.fill(0uLL);
 
         auto fill = [](SlotHotkeys& out, const auto& in) {
             out.kb[0] = in.KeyboardScanCode1.load(std::memory_order_relaxed);
@@ -25,6 +128,12 @@ namespace Input::detail {
             out.gp[0] = in.GamepadButton1.load(std::memory_order_relaxed);
             out.gp[1] = in.GamepadButton2.load(std::memory_order_relaxed);
             out.gp[2] = in.GamepadButton3.load(std::memory_order_relaxed);
+            out.kbMask = {};
+            out.gpMask = {};
+            for (int c : out.kb) out.kbMask.Set(c);
+            for (int c : out.gp) out.gpMask.Set(c);
+            out.kbExclusiveMask = out.kbMask | kAllowedExtra_Keyboard_MoveOrCamera;
+            out.gpExclusiveMask = out.gpMask | kAllowedExtra_Gamepad_MoveOrCamera;
         };
 
         const int m = std::min(n, kMaxSlots);
@@ -34,23 +143,34 @@ namespace Input::detail {
             const auto& hk = g_cache[s];
             const auto kbKeys = std::ranges::count_if(hk.kb, [](int c) { return c != -1; });
             const auto gpKeys = std::ranges::count_if(hk.gp, [](int c) { return c != -1; });
-            g_slotIsKbMultiKey[s] = (kbKeys > 1);
-            g_slotIsGpMultiKey[s] = (gpKeys > 1);
-            g_slotIsMultiKey[s] = (kbKeys > 1) || (gpKeys > 1);
-#ifdef DEBUG
-            spdlog::info("[Input] LoadHotkeyCache: slot={} kb=[{},{},{}] gp=[{},{},{}] isMultiKey={}", i, hk.kb[0],
-                         hk.kb[1], hk.kb[2], hk.gp[0], hk.gp[1], hk.gp[2], g_slotIsMultiKey[s]);
-#endif
+            g_slots[s].isKbMultiKey = (kbKeys > 1);
+            g_slots[s].isGpMultiKey = (gpKeys > 1);
+            g_slots[s].isMultiKey = (kbKeys > 1) || (gpKeys > 1);
+            hk.kbMask.ForEach([i](int c) { g_kbSlotsByCode[static_cast<std::size_t>(c)] |= (1uLL << i); });
+            hk.gpMask.ForEach([i](int c) { g_gpSlotsByCode[static_cast<std::size_t>(c)] |= (1uLL << i); });
+            IM_TRACE(Input, "[Input] LoadHotkeyCache: slot={} kb=[{},{},{}] gp=[{},{},{}] isMultiKey={}", i,
+                     hk.kb[0], hk.kb[1], hk.kb[2], hk.gp[0], hk.gp[1], hk.gp[2], g_slots[s].isMultiKey);
         }
 
         g_hudCache = {};
         fill(g_hudCache, cfg.hudPopupInput);
+        g_bankCache = {};
+        fill(g_bankCache, cfg.bankCycleInput);
+
+        AnalyzeConflicts(m, ModifierMask(cfg.slotInput[0], cfg.modifierKeyboardPosition, false),
+                         ModifierMask(cfg.slotInput[0], cfg.modifierGamepadPosition, true));
+
+        CompileChordMachine();
+    }
+
+    std::vector<HotkeyConflict> HotkeyConflicts() {
+        const std::scoped_lock guard(g_conflictsLock);
+        return g_conflicts;
     }
 
     bool SlotComboDown(int slot) {
         if (slot < 0 || slot >= ActiveSlots()) return false;
-        const auto& hk = g_cache[static_cast<std::size_t>(slot)];
-        return ComboDown(hk.kb, g_kbDown) || ComboDown(hk.gp, g_gpDown);
+        return ((ChordKbDownMask() | ChordGpDownMask()) & (1uLL << slot)) != 0;
     }
 
 }
\ No newline at end of file
@@ -3,7 +3,9 @@
 #include <algorithm>
 #include <array>
 #include <ranges>
+#include <vector>
 
+#include "Input.h"
 #include "InputState.h"
 
 namespace Input::detail {
@@ -16,39 +18,27 @@ namespace Input::detail {
         return std::ranges::find(combo, code) != combo.end();
     }
 
-    template <class DownArr>
-    [[nodiscard]] bool ComboDown(const std::array<int, 3>& combo, const DownArr& down) {
-        if (!AnyEnabled(combo)) return false;
-        return std::ranges::all_of(combo, [&](int code) {
-            if (code == -1) return true;
-            if (code < 0 || code >= kMaxCode) return false;
-            return down[static_cast<std::size_t>(code)].load(std::memory_order_relaxed);
-        });
+    [[nodiscard]] inline bool ComboDown(const KeyMask& combo, const KeyDownState& down) {
+        return !combo.Empty() && down.AllOf(combo);
     }
 
-    template <class DownArr>
-    [[nodiscard]] bool AnyComboKeyDown(const std::array<int, 3>& combo, const DownArr& down) {
-        return std::ranges::any_of(combo, [&](int code) {
-            if (code < 0 || code >= kMaxCode) return false;
-            return down[static_cast<std::size_t>(code)].load(std::memory_order_relaxed);
-        });
+    [[nodiscard]] inline bool AnyComboKeyDown(const KeyMask& combo, const KeyDownState& down) {
+        return down.AnyOf(combo);
     }
 
-    template <class DownArr, class AllowedFn>
-    [[nodiscard]] bool ComboExclusiveNow(const std::array<int, 3>& combo, const DownArr& down,
-                                         AllowedFn isAllowedExtra) {
-        if (!AnyEnabled(combo)) return false;
-        for (int code = 0; code < kMaxCode; ++code) {
-            if (!down[static_cast<std::size_t>(code)].load(std::memory_order_relaxed)) continue;
-            if (ComboContains(combo, code)) continue;
-            if (isAllowedExtra(code)) continue;
-            return false;
-        }
-        return true;
+    [[nodiscard]] inline bool ComboExclusiveNow(const KeyMask& combo, const KeyMask& exclusiveMask,
+                                                const KeyDownState& down) {
+        if (combo.Empty()) return false;
+        return down.NoneOutside(exclusiveMask);
     }
 
     void LoadHotkeyCache_FromConfig();
 
+    // Keys bound to a gameplay control in the game's ControlMap, as key mask codes.
+    [[nodiscard]] KeyMask GameControlKeys(bool gamepad);
+
+    [[nodiscard]] std::vector<HotkeyConflict> HotkeyConflicts();
+
     [[nodiscard]] bool SlotComboDown(int slot);
 
 }
\ No newline at end of file
@@ -1,38 +1,56 @@
 #include "HudToggle.h"
 
+#include "Config/Slots.h"
 #include "PCH.h"
+#include "State/MenuState.h"
 
 namespace Input::detail {
 
     namespace {
 
         [[nodiscard]] bool IsHudComboDown() {
-            return ComboDown(g_hudCache.kb, g_kbDown) || ComboDown(g_hudCache.gp, g_gpDown);
+            return ComboDown(g_hudCache.kbMask, g_kbDown) || ComboDown(g_hudCache.gpMask, g_gpDown);
+        }
+
+        [[nodiscard]] bool IsBankComboDown() {
+            return ComboDown(g_bankCache.kbMask, g_kbDown) || ComboDown(g_bankCache.gpMask, g_gpDown);
         }
 
     }
 
     bool ShouldFilterHudToggle(RE::INPUT_DEVICE dev, int convertedCode) {
         if (!IsHudToggleCombo(dev, convertedCode)) return false;
-        auto* ui = RE::UI::GetSingleton();
-        if (!ui) return false;
-        static const RE::BSFixedString magicMenu{"MagicMenu"};
-        return ui->IsMenuOpen(magicMenu);
+        return IntegratedMagic::MenuState::IsMagicMenuOpen();
     }
 
     void UpdateHudToggleState() {
         static bool prevHudDown = false;
         const bool hudDown = IsHudComboDown();
 
-        if (hudDown && !prevHudDown) {
-            auto* ui = RE::UI::GetSingleton();
-            static const RE::BSFixedString magicMenu{"MagicMenu"};
-            if (ui && ui->IsMenuOpen(magicMenu)) {
-                g_hudTogglePending.store(true, std::memory_order_relaxed);
-            }
+        if (hudDown && !prevHudDown && IntegratedMagic::MenuState::IsMagicMenuOpen()) {
+            g_hudTogglePending.store(true, std::memory_order_relaxed);
         }
 
         prevHudDown = hudDown;
     }
 
-}
\ No newline at end of file
+    bool ShouldFilterBankCycle(RE::INPUT_DEVICE dev, int convertedCode) {
+        if (!IsBankComboDown()) return false;
+        if (dev == RE::INPUT_DEVICE::kKeyboard) return ComboContains(g_bankCache.kb, convertedCode);
+        if (dev == RE::INPUT_DEVICE::kMouse) return ComboContains(g_bankCache.kb, kMouseButtonBase + convertedCode);
+        if (dev == RE::INPUT_DEVICE::kGamepad) return ComboContains(g_bankCache.gp, convertedCode);
+        return false;
+    }
+
+    void UpdateBankCycleState(bool blocked) {
+        static bool prevBankDown = false;
+        const bool bankDown = IsBankComboDown();
+
+        if (bankDown && !prevBankDown && !blocked) {
+            IntegratedMagic::Slots::CycleBank(1);
+        }
+
+        prevBankDown = bankDown;
+    }
+
+}
@@ -16,4 +16,8 @@ namespace Input::detail {
 
     void UpdateHudToggleState();
 
+    [[nodiscard]] bool ShouldFilterBankCycle(RE::INPUT_DEVICE dev, int convertedCode);
+
+    void UpdateBankCycleState(bool blocked);
+
 }
\ No newline at end of file
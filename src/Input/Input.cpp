@@ -1,39 +1,42 @@
 #include "Input.h"
 
+#include <algorithm>
+#include <bit>
 #include <chrono>
 
+#include "Diagnostics/Trace.h"
+#include "Input/ChordMachine.h"
 #include "Input/EventFilter.h"
 #include "Input/ExclusivePending.h"
 #include "Input/HotkeyCache.h"
 #include "Input/HudToggle.h"
 #include "Input/InputInternal.h"
 #include "Input/InputState.h"
+#include "Input/InputTrace.h"
+#include "Input/InputTraceFormat.h"
+#include "Input/OsEvents.h"
 #include "Input/ReplaySystem.h"
 #include "PCH.h"
 #include "SKSEMenuFramework.h"
 #include "State/Assign.h"
+#include "State/MenuState.h"
 #include "State/SpellClassify.h"
 #include "State/State.h"
+#include "State/Timers.h"
 #include "UI/HoveredForm.h"
 #include "UI/HudManager.h"
 
 namespace {
 
     void TryAssignHoveredToSlotByHotkey() {
-        auto* ui = RE::UI::GetSingleton();
-        if (!ui) return;
-        static const RE::BSFixedString magicMenu{"MagicMenu"};
-        if (!ui->IsMenuOpen(magicMenu)) return;
+        if (!IntegratedMagic::MenuState::IsMagicMenuOpen()) return;
 
         const auto type = IntegratedMagic::HoveredForm::GetHoveredMagicType();
         if (type == IntegratedMagic::HoveredForm::MagicType::None) return;
 
         const int n = ActiveSlots();
         for (int slot = 0; slot < n; ++slot) {
-            const auto& hk = g_cache[static_cast<std::size_t>(slot)];
-            const bool comboDown =
-                Input::detail::ComboDown(hk.kb, g_kbDown) || Input::detail::ComboDown(hk.gp, g_gpDown);
-            if (!comboDown) continue;
+            if (!Input::detail::SlotComboDown(slot)) continue;
 
             using MT = IntegratedMagic::HoveredForm::MagicType;
             if (type == MT::Shout || type == MT::Power) {
@@ -57,27 +60,20 @@ namespace {
         return dt;
     }
 
-    std::optional<int> ConsumeBit(std::atomic<std::uint64_t>& maskAtomic) {
-        while (true) {
-            const int n = ActiveSlots();
-            const std::uint64_t allowed = (n >= 64) ? ~0uLL : ((1uLL << n) - 1uLL);
-            std::uint64_t curAll = maskAtomic.load(std::memory_order_relaxed);
-            std::uint64_t cur = (curAll & allowed);
-            if (cur == 0uLL) {
-                if (curAll != 0uLL)
-                    (void)maskAtomic.compare_exchange_weak(curAll, (curAll & allowed), std::memory_order_relaxed);
-                return std::nullopt;
-            }
-            int idx = -1;
-            for (int i = 0; i < n; ++i) {
-                if (cur & (1uLL << i)) {
-                    idx = i;
-                    break;
-                }
-            }
-            if (idx < 0) return std::nullopt;
-            if (maskAtomic.compare_exchange_weak(curAll, (curAll & ~(1uLL << idx)), std::memory_order_relaxed))
-                return idx;
+    std::uint8_t TraceFrameFlags(bool blocked, bool capturing) {
+        namespace Fmt = Input::detail::TraceFormat;
+        std::uint8_t flags = 0;
+        if (blocked) flags |= Fmt::kBlockedByMenus;
+        if (capturing) flags |= Fmt::kHotkeyCapture;
+        if (IntegratedMagic::HUD::IsDetailPopupOpen()) flags |= Fmt::kDetailPopupOpen;
+        return flags;
+    }
+
+    void AppendEdges(std::uint64_t mask, const std::array<std::uint64_t, kMaxSlots>& seq, bool pressed,
+                     Input::SlotEdgeBatch& out, std::size_t& n) {
+        for (; mask; mask &= (mask - 1)) {
+            const int slot = std::countr_zero(mask);
+            out[n++] = Input::SlotEdge{seq[static_cast<std::size_t>(slot)], slot, pressed};
         }
     }
 
@@ -86,65 +82,93 @@ namespace {
         {kMouseButtonBase + 3, VK_XBUTTON1}, {kMouseButtonBase + 4, VK_XBUTTON2},
     };
 
-    void ClearStuckKeysOnFocusRegain() {
-        static bool s_prevFocused = true;
-
-        const HWND fg = GetForegroundWindow();
-        DWORD fgPid = 0;
-        GetWindowThreadProcessId(fg, &fgPid);
-        const bool focused = (fgPid == GetCurrentProcessId());
-
-        const bool justLostFocus = (s_prevFocused && !focused);
-        const bool justRegainedFocus = (!s_prevFocused && focused);
-        s_prevFocused = focused;
-
-        if (justLostFocus) {
-            for (const auto& [idx, vk] : kMouseVKMap) {
-                const auto i = static_cast<std::size_t>(idx);
-                if (g_kbDown[i].load(std::memory_order_relaxed)) {
-#ifdef DEBUG
-                    spdlog::info("[Input] ClearStuckKeysOnFocusRegain: focus lost, clearing mouse button idx={}", idx);
-#endif
-                    g_kbDown[i].store(false, std::memory_order_relaxed);
-                }
+    void ReleaseKey(int code) {
+        if (g_kbDown.Store(code, false)) Input::detail::StepChordMachine(RE::INPUT_DEVICE::kKeyboard, code, false);
+    }
+
+    void ReleaseMouseButtonsOnFocusLoss() {
+        for (const auto& [idx, vk] : kMouseVKMap) {
+            if (g_kbDown.Test(idx)) {
+                IM_TRACE(Input, "[Input] ReleaseMouseButtonsOnFocusLoss: focus lost, clearing mouse button idx={}",
+                         idx);
+                ReleaseKey(idx);
             }
         }
+    }
 
-        if (!justRegainedFocus) return;
-
-#ifdef DEBUG
-        spdlog::info("[Input] ClearStuckKeysOnFocusRegain: focus regained, checking for stuck keys");
-#endif
+    void ClearStuckKeysOnFocusRegain() {
+        IM_TRACE(Input, "[Input] ClearStuckKeysOnFocusRegain: focus regained, checking for stuck keys");
 
-        for (int code = 0; code < kMouseButtonBase; ++code) {
-            const auto idx = static_cast<std::size_t>(code);
-            if (!g_kbDown[idx].load(std::memory_order_relaxed)) continue;
+        g_kbDown.Snapshot().ForEach([](int code) {
+            if (code >= kMouseButtonBase) return;
             const UINT vk = MapVirtualKeyA(static_cast<UINT>(code), MAPVK_VSC_TO_VK);
-            if (vk == 0) continue;
+            if (vk == 0) return;
             if (!(GetAsyncKeyState(static_cast<int>(vk)) & 0x8000)) {
-#ifdef DEBUG
-                spdlog::info("[Input] ClearStuckKeysOnFocusRegain: cleared keyboard scancode={}", code);
-#endif
-                g_kbDown[idx].store(false, std::memory_order_relaxed);
+                IM_TRACE(Input, "[Input] ClearStuckKeysOnFocusRegain: cleared keyboard scancode={}", code);
+                ReleaseKey(code);
             }
-        }
+        });
 
         for (auto [idx, vk] : kMouseVKMap) {
-            const auto i = static_cast<std::size_t>(idx);
-            if (!g_kbDown[i].load(std::memory_order_relaxed)) continue;
+            if (!g_kbDown.Test(idx)) continue;
             if (!(GetAsyncKeyState(vk) & 0x8000)) {
-#ifdef DEBUG
-                spdlog::info("[Input] ClearStuckKeysOnFocusRegain: cleared mouse button idx={}", idx);
-#endif
-                g_kbDown[i].store(false, std::memory_order_relaxed);
+                IM_TRACE(Input, "[Input] ClearStuckKeysOnFocusRegain: cleared mouse button idx={}", idx);
+                ReleaseKey(idx);
+            }
+        }
+    }
+
+    void DrainOsEvents() {
+        static bool s_focused = true;
+
+        Input::OsEvent ev{};
+        while (Input::detail::PopOsEvent(ev)) {
+            const int code = ev.code;
+            switch (ev.type) {
+                case Input::OsEventType::FocusLost:
+                    if (s_focused) ReleaseMouseButtonsOnFocusLoss();
+                    s_focused = false;
+                    break;
+                case Input::OsEventType::FocusGained:
+                    if (!s_focused) ClearStuckKeysOnFocusRegain();
+                    s_focused = true;
+                    break;
+                case Input::OsEventType::KeyDown:
+                    if (Input::IsCaptureModeActive() && code > 0 && code < kMouseButtonBase)
+                        Input::InjectCapturedScancode(code);
+                    break;
+                case Input::OsEventType::MouseDown:
+                    if (Input::IsCaptureModeActive()) Input::InjectCapturedScancode(kMouseButtonBase + code);
+                    break;
+                case Input::OsEventType::KeyUp:
+                    if (code < kMouseButtonBase) ReleaseKey(code);
+                    break;
+                case Input::OsEventType::MouseUp:
+                    ReleaseKey(kMouseButtonBase + code);
+                    break;
+                case Input::OsEventType::DeviceChange:
+                    Input::detail::RequestGamepadProbe();
+                    break;
             }
         }
+
+        if (Input::detail::ConsumeOsEventOverflow() && s_focused) ClearStuckKeysOnFocusRegain();
     }
 
 }
 
-std::optional<int> Input::ConsumePressedSlot() { return ConsumeBit(g_pressedMask); }
-std::optional<int> Input::ConsumeReleasedSlot() { return ConsumeBit(g_releasedMask); }
+std::size_t Input::TakeSlotEdges(SlotEdgeBatch& out) {
+    const std::uint64_t allowed = ActiveSlotMask();
+    const std::uint64_t pressed = g_pressedMask.exchange(0uLL, std::memory_order_relaxed) & allowed;
+    const std::uint64_t released = g_releasedMask.exchange(0uLL, std::memory_order_relaxed) & allowed;
+    std::size_t n = 0;
+    AppendEdges(pressed, g_pressedSeq, true, out, n);
+    AppendEdges(released, g_releasedSeq, false, out, n);
+    if (std::popcount(pressed | released) > 1) {
+        std::ranges::stable_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(n), {}, &SlotEdge::seq);
+    }
+    return n;
+}
 
 void Input::ProcessAndFilter(RE::InputEvent** a_evns) {
     if (!a_evns) return;
@@ -155,9 +179,9 @@ void Input::ProcessAndFilter(RE::InputEvent** a_evns) {
         s_cacheInitialized = true;
     }
 
-    Input::detail::DrainOneDeferredReplayEvent();
+    Input::detail::DrainDeferredReplayEvents();
 
-    ClearStuckKeysOnFocusRegain();
+    DrainOsEvents();
 
     static bool prevBlocked = false;
     auto& cap = GetCaptureState();
@@ -167,17 +191,16 @@ void Input::ProcessAndFilter(RE::InputEvent** a_evns) {
     const float dt = CalculateDeltaTime();
     const bool blocked = Input::detail::IsInputBlockedByMenus();
 
+    Input::detail::BeginInputTraceFrame(*a_evns, dt, TraceFrameFlags(blocked, wantCaptureBefore));
+    IntegratedMagic::Timers::Advance(blocked ? 0.f : dt);
+
     if (prevBlocked && !blocked) {
-#ifdef DEBUG
-        spdlog::info("[Input] ProcessAndFilter: menu CLOSED - clearing stuck keys");
-#endif
+        IM_TRACE(Input, "[Input] ProcessAndFilter: menu CLOSED - clearing stuck keys");
         Input::detail::ClearLikelyStuckKeysAfterMenuClose();
     }
 
     if (!prevBlocked && blocked) {
-#ifdef DEBUG
-        spdlog::info("[Input] ProcessAndFilter: menu OPENED - discarding all exclusive pending");
-#endif
+        IM_TRACE(Input, "[Input] ProcessAndFilter: menu OPENED - discarding all exclusive pending");
         const int n = ActiveSlots();
         for (int slot = 0; slot < n; ++slot) Input::detail::DiscardExclusivePending(static_cast<std::size_t>(slot));
     }
@@ -186,10 +209,11 @@ void Input::ProcessAndFilter(RE::InputEvent** a_evns) {
 
     Input::detail::ProcessButtonEvents(a_evns, cap, wantCapture);
     Input::detail::UpdateHudToggleState();
+    Input::detail::UpdateBankCycleState(blocked);
 
     if (blocked) TryAssignHoveredToSlotByHotkey();
 
-    Input::detail::UpdateSlotsIfAllowed(blocked, dt);
+    Input::detail::UpdateSlotsIfAllowed(blocked);
     Input::detail::FilterMouseForPopup(a_evns);
 
     if (!blocked) Input::detail::FilterEvents(a_evns);
@@ -213,18 +237,26 @@ void Input::ProcessAndFilter(RE::InputEvent** a_evns) {
 
     for (int i = 0; i < ActiveSlots(); ++i) {
         const auto s = static_cast<std::size_t>(i);
-        if (g_replay[s].armed && !Input::detail::HasDeferredReplayForSlot(s)) Input::detail::ResetReplayState(s);
+        if (g_replay[s].Armed() && !Input::detail::HasDeferredReplayForSlot(s)) Input::detail::ResetReplayState(s);
     }
 
+    Input::detail::EndInputTraceFrame(*a_evns);
+
     Input::detail::DispatchIfAllowed(blocked, dt);
 }
 
 void Input::OnConfigChanged() {
-#ifdef DEBUG
-    spdlog::info("[Input] OnConfigChanged: reloading hotkey cache and resetting exclusive state");
-#endif
+    IM_TRACE(Input, "[Input] OnConfigChanged: reloading hotkey cache and resetting exclusive state");
     Input::detail::LoadHotkeyCache_FromConfig();
     Input::detail::ResetExclusiveState();
+    Input::detail::NoteInputTraceConfigChanged();
+}
+
+std::vector<Input::HotkeyConflict> Input::GetHotkeyConflicts() { return Input::detail::HotkeyConflicts(); }
+
+void Input::RegisterTimers() {
+    Input::detail::RegisterExclusiveTimers();
+    Input::detail::RegisterChordTimers();
 }
 
 std::optional<int> Input::GetDownSlotForSelection() {
@@ -269,16 +301,14 @@ bool Input::IsModifierHeld() {
         const int code = kbPos == 1   ? ic.KeyboardScanCode1.load(std::memory_order_relaxed)
                          : kbPos == 2 ? ic.KeyboardScanCode2.load(std::memory_order_relaxed)
                                       : ic.KeyboardScanCode3.load(std::memory_order_relaxed);
-        if (code >= 0 && code < kMaxCode && g_kbDown[static_cast<std::size_t>(code)].load(std::memory_order_relaxed))
-            return true;
+        if (g_kbDown.Test(code)) return true;
     }
     if (gpPos > 0) {
         const auto& ic = cfg.slotInput[0];
         const int code = gpPos == 1   ? ic.GamepadButton1.load(std::memory_order_relaxed)
                          : gpPos == 2 ? ic.GamepadButton2.load(std::memory_order_relaxed)
                                       : ic.GamepadButton3.load(std::memory_order_relaxed);
-        if (code >= 0 && code < kMaxCode && g_gpDown[static_cast<std::size_t>(code)].load(std::memory_order_relaxed))
-            return true;
+        if (g_gpDown.Test(code)) return true;
     }
     return false;
 }
@@ -290,9 +320,7 @@ bool Input::IsCaptureModeActive() { return g_captureModeActive.load(std::memory_
 void Input::InjectCapturedScancode(int scancode) {
     auto& cap = GetCaptureState();
     if (!cap.captureRequested.load(std::memory_order_relaxed)) return;
-#ifdef DEBUG
-    spdlog::info("[Input] InjectCapturedScancode: scancode={}", scancode);
-#endif
+    IM_TRACE(Input, "[Input] InjectCapturedScancode: scancode={}", scancode);
     cap.capturedEncoded.store(scancode, std::memory_order_relaxed);
     cap.captureRequested.store(false, std::memory_order_relaxed);
     g_captureModeActive.store(false, std::memory_order_relaxed);
@@ -302,9 +330,7 @@ void Input::InjectCapturedGamepad(int buttonIndex) {
     auto& cap = GetCaptureState();
     if (!cap.captureRequested.load(std::memory_order_relaxed)) return;
     const int encoded = -(buttonIndex + 2);
-#ifdef DEBUG
-    spdlog::info("[Input] InjectCapturedGamepad: index={} encoded={}", buttonIndex, encoded);
-#endif
+    IM_TRACE(Input, "[Input] InjectCapturedGamepad: index={} encoded={}", buttonIndex, encoded);
     cap.capturedEncoded.store(encoded, std::memory_order_relaxed);
     cap.captureRequested.store(false, std::memory_order_relaxed);
     g_captureModeActive.store(false, std::memory_order_relaxed);
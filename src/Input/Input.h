@@ -1,12 +1,26 @@
 #pragma once
 
 #include <optional>
+#include <vector>
 
 #include "PCH.h"
 
 namespace Input {
+    struct HotkeyConflict {
+        static constexpr int kHudPopup = -1;
+        static constexpr int kModifier = -2;
+        static constexpr int kBankCycle = -3;
+        static constexpr int kGameControl = -4;
+        int slot{0};
+        int other{0};
+        bool gamepad{false};
+    };
+
     void ProcessAndFilter(RE::InputEvent** a_evns);
     void OnConfigChanged();
+    void RegisterTimers();
+    void LoadChordTiming();
+    void SaveChordTiming();
     [[nodiscard]] std::optional<int> GetDownSlotForSelection();
     [[nodiscard]] bool IsSlotHotkeyDown(int slot);
     void RequestHotkeyCapture();
@@ -18,4 +32,5 @@ namespace Input {
     [[nodiscard]] bool IsCaptureModeActive();
     void InjectCapturedScancode(int scancode);
     void InjectCapturedGamepad(int buttonIndex);
+    [[nodiscard]] std::vector<HotkeyConflict> GetHotkeyConflicts();
 }
\ No newline at end of file
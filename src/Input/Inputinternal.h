@@ -1,13 +1,21 @@
 #pragma once
 
-#include <optional>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 
 #include "InputState.h"
 
 namespace Input {
 
-    [[nodiscard]] std::optional<int> ConsumePressedSlot();
+    struct SlotEdge {
+        std::uint64_t seq{0};
+        int slot{0};
+        bool pressed{false};
+    };
 
-    [[nodiscard]] std::optional<int> ConsumeReleasedSlot();
+    using SlotEdgeBatch = std::array<SlotEdge, 2 * kMaxSlots>;
+
+    [[nodiscard]] std::size_t TakeSlotEdges(SlotEdgeBatch& out);
 
 }
\ No newline at end of file
@@ -1,40 +1,78 @@
 #include "InputState.h"
 
-std::array<std::atomic_bool, kMaxCode> g_kbDown{};
-std::array<std::atomic_bool, kMaxCode> g_gpDown{};
+KeyDownState g_kbDown{};
+KeyDownState g_gpDown{};
+KeyDownState g_kbEngineDown{};
+KeyDownState g_gpEngineDown{};
 
 std::atomic<int> g_slotCount{4};
-std::array<std::atomic_bool, kMaxSlots> g_slotDown{};
-std::array<bool, kMaxSlots> g_slotWasAccepted{};
-std::array<bool, kMaxSlots> g_slotIsMultiKey{};
+std::atomic<std::uint64_t> g_slotDown{0uLL};
+alignas(64) std::array<SlotInputState, kMaxSlots> g_slots{};
 
 std::atomic<std::uint64_t> g_pressedMask{0ull};
 std::atomic<std::uint64_t> g_releasedMask{0ull};
+std::array<std::uint64_t, kMaxSlots> g_pressedSeq{};
+std::array<std::uint64_t, kMaxSlots> g_releasedSeq{};
 
-std::array<PendingSrc, kMaxSlots> g_exclusivePendingSrc{};
-std::array<float, kMaxSlots> g_exclusivePendingTimer{};
-std::array<bool, kMaxSlots> g_slotFullComboSeen{};
-std::array<bool, kMaxSlots> g_prevRawKbDown{};
-std::array<bool, kMaxSlots> g_prevRawGpDown{};
-
-std::array<bool, kMaxSlots> g_prevAnyKeyDown{};
-std::array<bool, kMaxSlots> g_simWindowActive{};
-std::array<float, kMaxSlots> g_simWindowRemaining{};
+std::uint64_t g_exclusiveConfirmDue{0};
 
 std::array<ReplayState, kMaxSlots> g_replay{};
-std::array<std::vector<RetainedEvent>, kMaxSlots> g_retainedEvents{};
-std::vector<DeferredReplayEvent> g_deferredEvents{};
+std::array<RetainedBuffer, kMaxSlots> g_retainedEvents{};
+DeferredReplayQueue g_deferred{};
 
 std::array<SlotHotkeys, kMaxSlots> g_cache{};
 SlotHotkeys g_hudCache{};
+SlotHotkeys g_bankCache{};
+
+std::array<std::uint64_t, kMaxCode> g_kbSlotsByCode{};
+std::array<std::uint64_t, kMaxCode> g_gpSlotsByCode{};
+std::uint64_t g_kbUnambiguous{0};
+std::uint64_t g_gpUnambiguous{0};
 
 std::atomic_bool g_hudTogglePending{false};
 std::atomic_bool g_captureModeActive{false};
 
-std::array<bool, kMaxSlots> g_slotIsKbMultiKey{};
-std::array<bool, kMaxSlots> g_slotIsGpMultiKey{};
-
 CaptureState& GetCaptureState() {
     static CaptureState st{};
     return st;
-}
\ No newline at end of file
+}
+
+int GamepadIdToIndex(int idCode) {
+    using Key = RE::BSWin32GamepadDevice::Key;
+    switch (static_cast<Key>(idCode)) {
+        case Key::kUp:
+            return 0;
+        case Key::kDown:
+            return 1;
+        case Key::kLeft:
+            return 2;
+        case Key::kRight:
+            return 3;
+        case Key::kStart:
+            return 4;
+        case Key::kBack:
+            return 5;
+        case Key::kLeftThumb:
+            return 6;
+        case Key::kRightThumb:
+            return 7;
+        case Key::kLeftShoulder:
+            return 8;
+        case Key::kRightShoulder:
+            return 9;
+        case Key::kA:
+            return 10;
+        case Key::kB:
+            return 11;
+        case Key::kX:
+            return 12;
+        case Key::kY:
+            return 13;
+        case Key::kLeftTrigger:
+            return 14;
+        case Key::kRightTrigger:
+            return 15;
+        default:
+            return -1;
+    }
+}
@@ -2,7 +2,10 @@
 
 #include <array>
 #include <atomic>
+#include <bit>
 #include <cstdint>
+#include <initializer_list>
+#include <utility>
 #include <vector>
 
 #include "Config/Config.h"
@@ -21,76 +24,339 @@ inline constexpr int kDIK_Escape = 0x01;
 
 static_assert(kMaxSlots <= 64, "Input mask uses uint64_t, keep max slots <= 64.");
 
+inline constexpr int kKeyWords = (kMaxCode + 63) / 64;
+
+struct KeyMask {
+    std::array<std::uint64_t, kKeyWords> words{};
+
+    [[nodiscard]] static constexpr bool InRange(int code) noexcept { return code >= 0 && code < kMaxCode; }
+
+    constexpr void Set(int code) noexcept {
+        if (InRange(code)) words[static_cast<std::size_t>(code >> 6)] |= (1uLL << (code & 63));
+    }
+
+    [[nodiscard]] constexpr bool Test(int code) const noexcept {
+        return InRange(code) && (words[static_cast<std::size_t>(code >> 6)] & (1uLL << (code & 63))) != 0;
+    }
+
+    [[nodiscard]] constexpr bool Empty() const noexcept {
+        for (auto w : words)
+            if (w) return false;
+        return true;
+    }
+
+    [[nodiscard]] constexpr int Count() const noexcept {
+        int n = 0;
+        for (auto w : words) n += std::popcount(w);
+        return n;
+    }
+
+    [[nodiscard]] constexpr bool SubsetOf(const KeyMask& o) const noexcept {
+        for (std::size_t i = 0; i < words.size(); ++i)
+            if (words[i] & ~o.words[i]) return false;
+        return true;
+    }
+
+    template <class Fn>
+    void ForEach(Fn&& fn) const {
+        for (int i = 0; i < kKeyWords; ++i) {
+            for (auto w = words[static_cast<std::size_t>(i)]; w; w &= (w - 1))
+                fn((i << 6) + std::countr_zero(w));
+        }
+    }
+
+    [[nodiscard]] constexpr KeyMask Without(const KeyMask& o) const noexcept {
+        KeyMask r{};
+        for (std::size_t i = 0; i < words.size(); ++i) r.words[i] = words[i] & ~o.words[i];
+        return r;
+    }
+
+    [[nodiscard]] constexpr KeyMask operator|(const KeyMask& o) const noexcept {
+        KeyMask r{};
+        for (std::size_t i = 0; i < words.size(); ++i) r.words[i] = words[i] | o.words[i];
+        return r;
+    }
+
+    constexpr KeyMask& operator|=(const KeyMask& o) noexcept {
+        for (std::size_t i = 0; i < words.size(); ++i) words[i] |= o.words[i];
+        return *this;
+    }
+};
+
+[[nodiscard]] constexpr KeyMask MakeKeyMask(std::initializer_list<int> codes) noexcept {
+    KeyMask m{};
+    for (int c : codes) m.Set(c);
+    return m;
+}
+
+class KeyDownState {
+public:
+    bool Store(int code, bool down) noexcept {
+        if (!KeyMask::InRange(code)) return false;
+        const auto bit = 1uLL << (code & 63);
+        auto& w = _words[static_cast<std::size_t>(code >> 6)];
+        const auto prev =
+            down ? w.fetch_or(bit, std::memory_order_relaxed) : w.fetch_and(~bit, std::memory_order_relaxed);
+        if (((prev & bit) != 0) == down) return false;
+        _count.fetch_add(down ? 1 : -1, std::memory_order_relaxed);
+        return true;
+    }
+
+    [[nodiscard]] int Count() const noexcept { return _count.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] int CountOf(const KeyMask& m) const noexcept {
+        int n = 0;
+        for (std::size_t i = 0; i < _words.size(); ++i) {
+            if (m.words[i]) n += std::popcount(_words[i].load(std::memory_order_relaxed) & m.words[i]);
+        }
+        return n;
+    }
+
+    [[nodiscard]] bool Test(int code) const noexcept {
+        if (!KeyMask::InRange(code)) return false;
+        return (_words[static_cast<std::size_t>(code >> 6)].load(std::memory_order_relaxed) & (1uLL << (code & 63))) !=
+               0;
+    }
+
+    [[nodiscard]] bool AllOf(const KeyMask& m) const noexcept {
+        for (std::size_t i = 0; i < _words.size(); ++i) {
+            if (!m.words[i]) continue;
+            if ((_words[i].load(std::memory_order_relaxed) & m.words[i]) != m.words[i]) return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool AnyOf(const KeyMask& m) const noexcept {
+        for (std::size_t i = 0; i < _words.size(); ++i) {
+            if (m.words[i] && (_words[i].load(std::memory_order_relaxed) & m.words[i])) return true;
+        }
+        return false;
+    }
+
+    [[nodiscard]] bool NoneOutside(const KeyMask& m) const noexcept { return Count() == CountOf(m); }
+
+    void KeepOnly(const KeyMask& m) noexcept {
+        int n = 0;
+        for (std::size_t i = 0; i < _words.size(); ++i)
+            n += std::popcount(_words[i].fetch_and(m.words[i], std::memory_order_relaxed) & m.words[i]);
+        _count.store(n, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] KeyMask Snapshot() const noexcept {
+        KeyMask m{};
+        for (std::size_t i = 0; i < _words.size(); ++i) m.words[i] = _words[i].load(std::memory_order_relaxed);
+        return m;
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, kKeyWords> _words{};
+    std::atomic<int> _count{0};
+};
+
 enum class PendingSrc : std::uint8_t { None = 0, Kb = 1, Gp = 2 };
 
 enum class ClearReason { Success, Timeout, Cancelled };
 
-struct ReplayState {
-    bool armed{false};
-    bool skipNextSimWindowOpen{false};
-    RE::INPUT_DEVICE dev{RE::INPUT_DEVICE::kKeyboard};
-    std::uint32_t rawIdCode{0};
-    RE::BSFixedString userEvent{};
-    bool valueAboveHalf{false};
+struct SlotInputState {
+    PendingSrc pendingSrc{PendingSrc::None};
+    bool wasAccepted{false};
+    bool fullComboSeen{false};
+    bool prevRawKbDown{false};
+    bool prevRawGpDown{false};
+    bool prevAnyKeyDown{false};
+    bool simWindowActive{false};
+    bool isMultiKey{false};
+    bool isKbMultiKey{false};
+    bool isGpMultiKey{false};
 };
 
+static_assert(sizeof(SlotInputState) <= 16, "Keep the per-slot hot record within a quarter cache line.");
+
 struct SlotHotkeys {
     std::array<int, 3> kb{-1, -1, -1};
     std::array<int, 3> gp{-1, -1, -1};
+    KeyMask kbMask{};
+    KeyMask gpMask{};
+    KeyMask kbExclusiveMask{};
+    KeyMask gpExclusiveMask{};
 };
 
 struct RetainedEvent {
     RE::INPUT_DEVICE dev;
+    int code;
     std::uint32_t rawIdCode;
     RE::BSFixedString userEvent;
     float value;
     float heldSecs;
 };
 
+inline constexpr std::size_t kMaxRetainedPerSlot = 32;
+
+struct RetainedBuffer {
+    std::array<RetainedEvent, kMaxRetainedPerSlot> items{};
+    std::size_t count{0};
+    std::size_t openKeys{0};
+
+    [[nodiscard]] bool empty() const noexcept { return count == 0; }
+    [[nodiscard]] std::size_t size() const noexcept { return count; }
+    RetainedEvent* begin() noexcept { return items.data(); }
+    RetainedEvent* end() noexcept { return items.data() + count; }
+
+    bool Push(RE::INPUT_DEVICE dev, int code, std::uint32_t rawIdCode, const RE::BSFixedString& userEvent,
+              float value, float heldSecs) {
+        auto* last = LastFor(dev, rawIdCode);
+        const bool wasOpen = last && last->value > 0.f;
+        if (value > 0.f) {
+            if (wasOpen && heldSecs > 0.f && last->heldSecs > 0.f) {
+                last->value = value;
+                last->heldSecs = heldSecs;
+                return true;
+            }
+            const std::size_t reserve = wasOpen ? 0 : 1;
+            if (count + 1 + reserve + openKeys > items.size()) return false;
+            Append(dev, code, rawIdCode, userEvent, value, heldSecs);
+            openKeys += reserve;
+            return true;
+        }
+        if (count >= items.size()) return false;
+        Append(dev, code, rawIdCode, userEvent, value, heldSecs);
+        if (wasOpen) --openKeys;
+        return true;
+    }
+
+    void clear() noexcept {
+        for (auto& ev : *this) ev.userEvent = {};
+        count = 0;
+        openKeys = 0;
+    }
+
+    [[nodiscard]] bool Holds(RE::INPUT_DEVICE dev, std::uint32_t rawIdCode) const noexcept {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (items[i].dev == dev && items[i].rawIdCode == rawIdCode) return true;
+        }
+        return false;
+    }
+
+    void Erase(RE::INPUT_DEVICE dev, std::uint32_t rawIdCode) {
+        if (const auto* last = LastFor(dev, rawIdCode); last && last->value > 0.f) --openKeys;
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (items[i].dev == dev && items[i].rawIdCode == rawIdCode) continue;
+            if (kept != i) items[kept] = std::move(items[i]);
+            ++kept;
+        }
+        for (auto i = kept; i < count; ++i) items[i].userEvent = {};
+        count = kept;
+    }
+
+private:
+    RetainedEvent* LastFor(RE::INPUT_DEVICE dev, std::uint32_t rawIdCode) noexcept {
+        for (auto i = count; i-- > 0;) {
+            if (items[i].dev == dev && items[i].rawIdCode == rawIdCode) return &items[i];
+        }
+        return nullptr;
+    }
+
+    void Append(RE::INPUT_DEVICE dev, int code, std::uint32_t rawIdCode, const RE::BSFixedString& userEvent,
+                float value, float heldSecs) {
+        auto& ev = items[count++];
+        ev.dev = dev;
+        ev.code = code;
+        ev.rawIdCode = rawIdCode;
+        ev.userEvent = userEvent;
+        ev.value = value;
+        ev.heldSecs = heldSecs;
+    }
+};
+
+struct ReplayExpect {
+    RE::INPUT_DEVICE dev{RE::INPUT_DEVICE::kKeyboard};
+    std::uint32_t rawIdCode{0};
+    RE::BSFixedString userEvent{};
+    bool valueAboveHalf{false};
+};
+
+struct ReplayState {
+    std::array<ReplayExpect, kMaxRetainedPerSlot> expected{};
+    std::uint8_t head{0};
+    std::uint8_t count{0};
+    bool skipNextSimWindowOpen{false};
+
+    [[nodiscard]] bool Armed() const noexcept { return count != 0; }
+    [[nodiscard]] bool Full() const noexcept { return count == expected.size(); }
+    [[nodiscard]] const ReplayExpect& Front() const noexcept { return expected[head]; }
+
+    bool Push(ReplayExpect&& e) noexcept {
+        if (Full()) return false;
+        expected[(head + count) % expected.size()] = std::move(e);
+        ++count;
+        return true;
+    }
+
+    void Pop() noexcept {
+        expected[head].userEvent = {};
+        head = static_cast<std::uint8_t>((head + 1) % expected.size());
+        --count;
+    }
+
+    void ClearExpected() noexcept {
+        while (Armed()) Pop();
+    }
+};
+
 struct DeferredReplayEvent {
     std::size_t slot{0};
     RetainedEvent ev{};
 };
 
+inline constexpr std::size_t kMaxDeferredEvents = 512;
+
+struct DeferredReplayQueue {
+    std::array<DeferredReplayEvent, kMaxDeferredEvents> items{};
+    std::size_t head{0};
+    std::size_t count{0};
+    std::array<std::uint16_t, kMaxSlots> perSlot{};
+    std::uint64_t slotMask{0};
+};
+
 struct CaptureState {
     std::atomic_bool captureRequested{false};
     std::atomic_int capturedEncoded{-1};
 };
 
-extern std::array<std::atomic_bool, kMaxCode> g_kbDown;
-extern std::array<std::atomic_bool, kMaxCode> g_gpDown;
+extern KeyDownState g_kbDown;
+extern KeyDownState g_gpDown;
+// Keys the game has been sent a press for; their release must reach it too.
+extern KeyDownState g_kbEngineDown;
+extern KeyDownState g_gpEngineDown;
 
 extern std::atomic<int> g_slotCount;
-extern std::array<std::atomic_bool, kMaxSlots> g_slotDown;
-extern std::array<bool, kMaxSlots> g_slotWasAccepted;
-extern std::array<bool, kMaxSlots> g_slotIsMultiKey;
+extern std::atomic<std::uint64_t> g_slotDown;
+extern std::array<SlotInputState, kMaxSlots> g_slots;
 
 extern std::atomic<std::uint64_t> g_pressedMask;
 extern std::atomic<std::uint64_t> g_releasedMask;
+extern std::array<std::uint64_t, kMaxSlots> g_pressedSeq;
+extern std::array<std::uint64_t, kMaxSlots> g_releasedSeq;
 
-extern std::array<PendingSrc, kMaxSlots> g_exclusivePendingSrc;
-extern std::array<float, kMaxSlots> g_exclusivePendingTimer;
-extern std::array<bool, kMaxSlots> g_slotFullComboSeen;
-extern std::array<bool, kMaxSlots> g_prevRawKbDown;
-extern std::array<bool, kMaxSlots> g_prevRawGpDown;
-
-extern std::array<bool, kMaxSlots> g_prevAnyKeyDown;
-extern std::array<bool, kMaxSlots> g_simWindowActive;
-extern std::array<float, kMaxSlots> g_simWindowRemaining;
+extern std::uint64_t g_exclusiveConfirmDue;
 
 extern std::array<ReplayState, kMaxSlots> g_replay;
-extern std::array<std::vector<RetainedEvent>, kMaxSlots> g_retainedEvents;
-extern std::vector<DeferredReplayEvent> g_deferredEvents;
+extern std::array<RetainedBuffer, kMaxSlots> g_retainedEvents;
+extern DeferredReplayQueue g_deferred;
 
 extern std::array<SlotHotkeys, kMaxSlots> g_cache;
 extern SlotHotkeys g_hudCache;
+extern SlotHotkeys g_bankCache;
+
+extern std::array<std::uint64_t, kMaxCode> g_kbSlotsByCode;
+extern std::array<std::uint64_t, kMaxCode> g_gpSlotsByCode;
+extern std::uint64_t g_kbUnambiguous;
+extern std::uint64_t g_gpUnambiguous;
 
 extern std::atomic_bool g_hudTogglePending;
 extern std::atomic_bool g_captureModeActive;
 
-extern std::array<bool, kMaxSlots> g_slotIsKbMultiKey;
-extern std::array<bool, kMaxSlots> g_slotIsGpMultiKey;
-
 [[nodiscard]] inline int ActiveSlots() {
     int n = g_slotCount.load(std::memory_order_relaxed);
     if (n < 1) n = 1;
@@ -98,4 +364,27 @@ extern std::array<bool, kMaxSlots> g_slotIsGpMultiKey;
     return n;
 }
 
-[[nodiscard]] CaptureState& GetCaptureState();
\ No newline at end of file
+[[nodiscard]] inline std::uint64_t ActiveSlotMask() {
+    const int n = ActiveSlots();
+    return (n >= 64) ? ~0uLL : ((1uLL << n) - 1uLL);
+}
+
+[[nodiscard]] inline bool IsSlotDown(std::size_t s) {
+    return (g_slotDown.load(std::memory_order_relaxed) & (1uLL << s)) != 0;
+}
+
+inline void SetSlotDown(std::size_t s, bool down) {
+    if (down)
+        g_slotDown.fetch_or(1uLL << s, std::memory_order_relaxed);
+    else
+        g_slotDown.fetch_and(~(1uLL << s), std::memory_order_relaxed);
+}
+
+[[nodiscard]] inline KeyDownState& EngineDownState(RE::INPUT_DEVICE dev) {
+    return (dev == RE::INPUT_DEVICE::kGamepad) ? g_gpEngineDown : g_kbEngineDown;
+}
+
+[[nodiscard]] CaptureState& GetCaptureState();
+
+// Maps a BSWin32GamepadDevice::Key id code to the dense gamepad code used by the key masks, or -1.
+[[nodiscard]] int GamepadIdToIndex(int idCode);
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "InputTrace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+#include "Config/Config.h"
+#include "Config/ConfigPath.h"
+#include "InputTraceFormat.h"
+#include "PCH.h"
+
+namespace Input::detail {
+    namespace {
+        namespace Fmt = TraceFormat;
+
+        struct TraceRecord {
+            const RE::InputEvent* ev{nullptr};
+            Fmt::EventType type{Fmt::EventType::Button};
+            std::uint8_t device{0};
+            std::uint32_t idCode{0};
+            float a{0.f};
+            float b{0.f};
+            std::string_view userEvent{};
+        };
+
+        std::ofstream g_traceFile;
+        std::vector<TraceRecord> g_frame;
+        std::vector<const RE::InputEvent*> g_kept;
+        float g_frameDt{0.f};
+        std::uint8_t g_frameFlags{0};
+        bool g_frameOpen{false};
+        std::atomic_bool g_configDirty{false};
+
+        std::filesystem::path TracePath() {
+            return IntegratedMagic::GetThisDllDir() / "IntegratedMagic_InputTrace.bin";
+        }
+
+        template <class T>
+        void Put(const T& v) {
+            g_traceFile.write(reinterpret_cast<const char*>(&v), sizeof(T));
+        }
+
+        bool EnsureTraceOpen() {
+            if (!IntegratedMagic::GetMagicConfig().recordInputTrace) {
+                if (g_traceFile.is_open()) {
+                    g_traceFile.close();
+#ifdef DEBUG
+                    spdlog::info("[Input] InputTrace: recording stopped");
+#endif
+                }
+                return false;
+            }
+            if (g_traceFile.is_open()) return true;
+
+            g_traceFile.open(TracePath(), std::ios::binary | std::ios::trunc);
+            if (!g_traceFile) {
+                spdlog::warn("[Input] InputTrace: failed to open {}", TracePath().string());
+                return false;
+            }
+            g_traceFile.write(Fmt::kMagic, sizeof(Fmt::kMagic));
+            Put(Fmt::kVersion);
+            g_configDirty.store(true, std::memory_order_relaxed);
+#ifdef DEBUG
+            spdlog::info("[Input] InputTrace: recording to {}", TracePath().string());
+#endif
+            return true;
+        }
+
+        void PutInput(const IntegratedMagic::InputConfig& in) {
+            for (const auto* field : {&in.KeyboardScanCode1, &in.KeyboardScanCode2, &in.KeyboardScanCode3,
+                                      &in.GamepadButton1, &in.GamepadButton2, &in.GamepadButton3, &in.Trigger})
+                Put(static_cast<std::int32_t>(field->load(std::memory_order_relaxed)));
+        }
+
+        void PutConfig() {
+            const auto& cfg = IntegratedMagic::GetMagicConfig();
+            const auto slots = cfg.SlotCount();
+            std::uint8_t patches = 0;
+            if (cfg.requireExclusiveHotkeyPatch) patches |= Fmt::kRequireExclusiveHotkey;
+            if (cfg.pressBothAtSamePatch) patches |= Fmt::kPressBothAtSame;
+            if (cfg.speculativePreEquipPatch) patches |= Fmt::kSpeculativePreEquip;
+            if (cfg.adaptiveInputWindowsPatch) patches |= Fmt::kAdaptiveInputWindows;
+
+            Put(Fmt::kConfigTag);
+            Put(static_cast<std::uint8_t>(slots));
+            Put(patches);
+            Put(static_cast<std::int8_t>(cfg.modifierKeyboardPosition));
+            Put(static_cast<std::int8_t>(cfg.modifierGamepadPosition));
+            for (std::uint32_t s = 0; s < slots; ++s) PutInput(cfg.slotInput[s]);
+            PutInput(cfg.hudPopupInput);
+            PutInput(cfg.bankCycleInput);
+        }
+
+        bool Capture(const RE::InputEvent* e, TraceRecord& out) {
+            out.ev = e;
+            out.device = static_cast<std::uint8_t>(e->GetDevice());
+            if (const auto* btn = e->AsButtonEvent()) {
+                out.type = Fmt::EventType::Button;
+                out.idCode = btn->GetIDCode();
+                out.a = btn->Value();
+                out.b = btn->HeldDuration();
+                out.userEvent = btn->QUserEvent().c_str();
+                return true;
+            }
+            if (e->eventType == RE::INPUT_EVENT_TYPE::kMouseMove) {
+                const auto* mm = static_cast<const RE::MouseMoveEvent*>(e);
+                out.type = Fmt::EventType::MouseMove;
+                out.idCode = mm->GetIDCode();
+                out.a = static_cast<float>(mm->mouseInputX);
+                out.b = static_cast<float>(mm->mouseInputY);
+                out.userEvent = mm->QUserEvent().c_str();
+                return true;
+            }
+            if (e->eventType == RE::INPUT_EVENT_TYPE::kThumbstick) {
+                const auto* ts = static_cast<const RE::ThumbstickEvent*>(e);
+                out.type = Fmt::EventType::Thumbstick;
+                out.idCode = ts->GetIDCode();
+                out.a = ts->xValue;
+                out.b = ts->yValue;
+                out.userEvent = ts->QUserEvent().c_str();
+                return true;
+            }
+            return false;
+        }
+    }
+
+    void BeginInputTraceFrame(RE::InputEvent* head, float dt, std::uint8_t frameFlags) {
+        g_frameOpen = EnsureTraceOpen();
+        if (!g_frameOpen) return;
+        if (g_configDirty.exchange(false, std::memory_order_relaxed)) PutConfig();
+
+        g_frameDt = dt;
+        g_frameFlags = frameFlags;
+        g_frame.clear();
+        for (auto* e = head; e; e = e->next) {
+            if (TraceRecord rec{}; Capture(e, rec)) g_frame.push_back(rec);
+        }
+    }
+
+    void EndInputTraceFrame(RE::InputEvent* head) {
+        if (!g_frameOpen) return;
+        g_frameOpen = false;
+
+        g_kept.clear();
+        for (auto* e = head; e; e = e->next) g_kept.push_back(e);
+
+        Put(Fmt::kFrameTag);
+        Put(g_frameDt);
+        Put(g_frameFlags);
+        Put(static_cast<std::uint16_t>(std::min<std::size_t>(g_frame.size(), 0xFFFF)));
+        for (std::size_t i = 0; i < g_frame.size() && i < 0xFFFF; ++i) {
+            const auto& rec = g_frame[i];
+            const bool kept = std::ranges::find(g_kept, rec.ev) != g_kept.end();
+            const auto len = static_cast<std::uint8_t>(std::min<std::size_t>(rec.userEvent.size(), 0xFF));
+            Put(static_cast<std::uint8_t>(rec.type));
+            Put(rec.device);
+            Put(static_cast<std::uint8_t>(kept ? 1 : 0));
+            Put(rec.idCode);
+            Put(rec.a);
+            Put(rec.b);
+            Put(len);
+            g_traceFile.write(rec.userEvent.data(), len);
+        }
+    }
+
+    void NoteInputTraceConfigChanged() { g_configDirty.store(true, std::memory_order_relaxed); }
+
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+#include "PCH.h"
+
+namespace Input::detail {
+
+    // frameFlags is a TraceFormat::FrameFlag set describing the poll the events were seen in.
+    void BeginInputTraceFrame(RE::InputEvent* head, float dt, std::uint8_t frameFlags);
+
+    void EndInputTraceFrame(RE::InputEvent* head);
+
+    // Makes the next recorded frame start with a fresh config record.
+    void NoteInputTraceConfigChanged();
+
+}
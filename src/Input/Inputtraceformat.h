@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of IntegratedMagic_InputTrace.bin, shared by the recorder and the host replayer. All values are
+// little-endian and unpadded.
+//
+//   header  'I' 'M' 'T' 'R', u16 version
+//   config  'C', u8 slotCount, u8 patch flags, i8 modifierKeyboardPosition, i8 modifierGamepadPosition,
+//           then slotCount slot inputs, the HUD popup input and the bank cycle input as
+//           i32 KeyboardScanCode1..3, i32 GamepadButton1..3, i32 Trigger
+//   frame   'F', f32 dt, u8 frame flags, u16 event count, then per event:
+//           u8 type, u8 device, u8 kept, u32 idCode, f32 a, f32 b, u8 length, user event bytes
+//
+// A config record precedes the first frame and follows every hotkey reload. For buttons a/b are value/heldSecs,
+// for mouse moves the x/y deltas and for thumbsticks the x/y axes.
+namespace Input::detail::TraceFormat {
+
+    inline constexpr char kMagic[4]{'I', 'M', 'T', 'R'};
+    inline constexpr std::uint16_t kVersion = 2;
+
+    inline constexpr std::uint8_t kConfigTag = 'C';
+    inline constexpr std::uint8_t kFrameTag = 'F';
+
+    enum class EventType : std::uint8_t { Button = 0, MouseMove = 1, Thumbstick = 2 };
+
+    enum PatchFlag : std::uint8_t {
+        kRequireExclusiveHotkey = 1 << 0,
+        kPressBothAtSame = 1 << 1,
+        kSpeculativePreEquip = 1 << 2,
+        kAdaptiveInputWindows = 1 << 3,
+    };
+
+    enum FrameFlag : std::uint8_t {
+        kBlockedByMenus = 1 << 0,
+        kHotkeyCapture = 1 << 1,
+        kDetailPopupOpen = 1 << 2,
+    };
+
+}
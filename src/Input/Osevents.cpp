@@ -0,0 +1,44 @@
+#include "OsEvents.h"
+
+#include <array>
+#include <atomic>
+
+#include "PCH.h"
+
+namespace Input {
+    namespace {
+        constexpr std::uint32_t kMailboxSize = 128;
+
+        std::array<OsEvent, kMailboxSize> g_mailbox{};
+        std::atomic<std::uint32_t> g_head{0};
+        std::atomic<std::uint32_t> g_tail{0};
+        std::atomic_bool g_overflow{false};
+        std::atomic_bool g_gamepadProbe{true};
+    }
+
+    void PostOsEvent(OsEventType type, int code) {
+        const auto tail = g_tail.load(std::memory_order_relaxed);
+        if (tail - g_head.load(std::memory_order_acquire) >= kMailboxSize) {
+            g_overflow.store(true, std::memory_order_relaxed);
+            return;
+        }
+        g_mailbox[tail % kMailboxSize] = {type, static_cast<std::uint16_t>(code)};
+        g_tail.store(tail + 1, std::memory_order_release);
+    }
+
+    bool ConsumeGamepadProbeRequest() { return g_gamepadProbe.exchange(false, std::memory_order_relaxed); }
+}
+
+namespace Input::detail {
+    bool PopOsEvent(OsEvent& out) {
+        const auto head = g_head.load(std::memory_order_relaxed);
+        if (head == g_tail.load(std::memory_order_acquire)) return false;
+        out = g_mailbox[head % kMailboxSize];
+        g_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool ConsumeOsEventOverflow() { return g_overflow.exchange(false, std::memory_order_relaxed); }
+
+    void RequestGamepadProbe() { g_gamepadProbe.store(true, std::memory_order_relaxed); }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Input {
+    enum class OsEventType : std::uint8_t { FocusLost, FocusGained, KeyDown, KeyUp, MouseDown, MouseUp, DeviceChange };
+
+    struct OsEvent {
+        OsEventType type{OsEventType::FocusGained};
+        std::uint16_t code{0};
+    };
+
+    void PostOsEvent(OsEventType type, int code = 0);
+    [[nodiscard]] bool ConsumeGamepadProbeRequest();
+}
+
+namespace Input::detail {
+    [[nodiscard]] bool PopOsEvent(OsEvent& out);
+    [[nodiscard]] bool ConsumeOsEventOverflow();
+    void RequestGamepadProbe();
+}
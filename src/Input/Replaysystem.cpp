@@ -1,58 +1,115 @@
 #include "ReplaySystem.h"
 
-#include <algorithm>
+#include <bit>
+#include <utility>
 
+#include "Diagnostics/Trace.h"
 #include "PCH.h"
 #include "State/SyntheticInput.h"
 
 namespace Input::detail {
+    namespace {
+        void PushDeferred(DeferredReplayEvent&& item) {
+            auto& q = g_deferred;
+            q.items[(q.head + q.count) % kMaxDeferredEvents] = std::move(item);
+            ++q.count;
+        }
+
+        DeferredReplayEvent PopDeferred() {
+            auto& q = g_deferred;
+            auto item = std::exchange(q.items[q.head], DeferredReplayEvent{});
+            q.head = (q.head + 1) % kMaxDeferredEvents;
+            --q.count;
+            return item;
+        }
+
+        void OnDeferredRemoved(std::size_t s) {
+            auto& q = g_deferred;
+            if (q.perSlot[s] > 0 && --q.perSlot[s] == 0) q.slotMask &= ~(1uLL << s);
+        }
+
+        template <class Fn>
+        void RemoveDeferredIf(Fn&& shouldRemove) {
+            const auto n = g_deferred.count;
+            for (std::size_t i = 0; i < n; ++i) {
+                auto item = PopDeferred();
+                if (shouldRemove(item)) {
+                    OnDeferredRemoved(item.slot);
+                    continue;
+                }
+                PushDeferred(std::move(item));
+            }
+        }
+
+        void EmitDeferred(DeferredReplayEvent& item) {
+            auto& rp = g_replay[item.slot];
+            const bool down = item.ev.value > 0.5f;
+            rp.Push(ReplayExpect{item.ev.dev, item.ev.rawIdCode, item.ev.userEvent, down});
+            rp.skipNextSimWindowOpen = down;
+            EngineDownState(item.ev.dev).Store(item.ev.code, item.ev.value > 0.f);
+
+            IM_TRACE(Replay, "[Input] Replay: slot={} dequeue dev={} value={:.2f} heldSecs={:.3f}", item.slot,
+                     static_cast<int>(item.ev.dev), item.ev.value, item.ev.heldSecs);
+
+            IntegratedMagic::detail::EnqueueRetainedEvent(item.ev.dev, item.ev.rawIdCode, std::move(item.ev.userEvent),
+                                                          item.ev.value, item.ev.heldSecs);
+        }
+    }
 
     void ResetReplayState(std::size_t s) { g_replay[s] = ReplayState{}; }
 
-    bool HasDeferredReplayForSlot(std::size_t s) {
-        return std::ranges::any_of(g_deferredEvents, [s](const DeferredReplayEvent& item) { return item.slot == s; });
+    void ConsumeReplayEvent(std::size_t s) {
+        if (g_replay[s].Armed()) g_replay[s].Pop();
     }
 
-    void QueueDeferredReplayEvent(std::size_t s, const RetainedEvent& ev) {
-        g_deferredEvents.push_back(DeferredReplayEvent{s, ev});
+    bool HasDeferredReplayForSlot(std::size_t s) { return (g_deferred.slotMask >> s) & 1uLL; }
+
+    void QueueDeferredReplayEvent(std::size_t s, RetainedEvent&& ev) {
+        if (g_deferred.count >= kMaxDeferredEvents) {
+            spdlog::warn("[Input] Replay: deferred queue full, dropping event for slot={}", s);
+            return;
+        }
+        PushDeferred(DeferredReplayEvent{s, std::move(ev)});
+        ++g_deferred.perSlot[s];
+        g_deferred.slotMask |= (1uLL << s);
     }
 
     void ClearDeferredReplayEventsForSlot(std::size_t s) {
-        g_deferredEvents.erase(std::remove_if(g_deferredEvents.begin(), g_deferredEvents.end(),
-                                              [s](const DeferredReplayEvent& item) { return item.slot == s; }),
-                               g_deferredEvents.end());
+        if (!HasDeferredReplayForSlot(s)) return;
+        RemoveDeferredIf([s](const DeferredReplayEvent& item) { return item.slot == s; });
+    }
+
+    void ClearDeferredReplayEventsForKey(RE::INPUT_DEVICE dev, std::uint32_t rawIdCode) {
+        if (g_deferred.count == 0) return;
+        RemoveDeferredIf([dev, rawIdCode](const DeferredReplayEvent& item) {
+            return item.ev.dev == dev && item.ev.rawIdCode == rawIdCode;
+        });
     }
 
     bool ReplayMatchesEvent(std::size_t s, RE::INPUT_DEVICE dev, std::uint32_t rawIdCode,
                             const RE::BSFixedString& userEvent, float value) {
-        const auto& rp = g_replay[s];
-        if (!rp.armed) return false;
+        if (!g_replay[s].Armed()) return false;
+        const auto& rp = g_replay[s].Front();
         if (rp.dev != dev) return false;
         if (rp.rawIdCode != rawIdCode) return false;
         if (rp.userEvent != userEvent) return false;
         return (value > 0.5f) == rp.valueAboveHalf;
     }
 
-    void DrainOneDeferredReplayEvent() {
-        if (g_deferredEvents.empty()) return;
-
-        const auto item = g_deferredEvents.front();
-        g_deferredEvents.erase(g_deferredEvents.begin());
-
-        auto& rp = g_replay[item.slot];
-        rp.armed = true;
-        rp.dev = item.ev.dev;
-        rp.rawIdCode = item.ev.rawIdCode;
-        rp.userEvent = item.ev.userEvent;
-        rp.valueAboveHalf = item.ev.value > 0.5f;
-        rp.skipNextSimWindowOpen = rp.valueAboveHalf;
-
-#ifdef DEBUG
-        spdlog::info("[Input] Replay: slot={} dequeue dev={} value={:.2f} heldSecs={:.3f}", item.slot,
-                     static_cast<int>(item.ev.dev), item.ev.value, item.ev.heldSecs);
-#endif
-
-        IntegratedMagic::detail::EnqueueRetainedEvent(item.ev.dev, item.ev.rawIdCode, item.ev.userEvent, item.ev.value,
-                                                      item.ev.heldSecs);
+    void DrainDeferredReplayEvents() {
+        if (g_deferred.slotMask == 0uLL) return;
+        // Expectations from an earlier drain went out with that poll. A slot replays at most kMaxRetainedPerSlot
+        // events per poll so its expectations never wrap; the rest of its queue waits for the next poll.
+        for (auto m = g_deferred.slotMask; m; m &= (m - 1)) g_replay[std::countr_zero(m)].ClearExpected();
+        const auto n = g_deferred.count;
+        for (std::size_t i = 0; i < n; ++i) {
+            auto item = PopDeferred();
+            if (g_replay[item.slot].Full()) {
+                PushDeferred(std::move(item));
+                continue;
+            }
+            OnDeferredRemoved(item.slot);
+            EmitDeferred(item);
+        }
     }
-}
\ No newline at end of file
+}
@@ -66,19 +66,36 @@ namespace IntegratedMagic {
                 if (i < itR->size()) s.right[i] = _toU32Clamped(itR->at(i));
                 if (itS != obj.end() && itS->is_array() && i < itS->size()) s.shout[i] = _toU32Clamped(itS->at(i));
             }
+            if (const auto itB = obj.find("banks"); itB != obj.end() && itB->is_array()) {
+                for (const auto& b : *itB) {
+                    if (b.is_object()) s.extraBanks.push_back(_parseV3ObjectToLR(b));
+                }
+            }
+            if (const auto itA = obj.find("activeBank"); itA != obj.end()) s.activeBank = _toU32Clamped(*itA);
             return s;
         }
 
+        nlohmann::json _slotsToJson(const SaveSpellSlots& slots) {
+            nlohmann::json obj;
+            obj["left"] = slots.left;
+            obj["right"] = slots.right;
+            obj["shout"] = slots.shout;
+            return obj;
+        }
+
         nlohmann::json _buildJsonV3_NoLock(
             const std::unordered_map<std::string, SaveSpellSlots, TransparentSaveKeyHash, std::equal_to<>>& bySave) {
             nlohmann::json j;
             j["version"] = 3;
             nlohmann::json saves = nlohmann::json::object();
             for (auto const& [key, slots] : bySave) {
-                nlohmann::json obj;
-                obj["left"] = slots.left;
-                obj["right"] = slots.right;
-                obj["shout"] = slots.shout;
+                nlohmann::json obj = _slotsToJson(slots);
+                if (!slots.extraBanks.empty()) {
+                    nlohmann::json banks = nlohmann::json::array();
+                    for (const auto& b : slots.extraBanks) banks.push_back(_slotsToJson(b));
+                    obj["banks"] = std::move(banks);
+                    obj["activeBank"] = slots.activeBank;
+                }
                 saves[key] = std::move(obj);
             }
             j["saves"] = std::move(saves);
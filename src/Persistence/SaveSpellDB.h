@@ -20,6 +20,8 @@ namespace IntegratedMagic {
         std::vector<std::uint32_t> left;
         std::vector<std::uint32_t> right;
         std::vector<std::uint32_t> shout;
+        std::vector<SaveSpellSlots> extraBanks;
+        std::uint32_t activeBank{0};
         inline std::size_t Size() const noexcept { return std::max(left.size(), std::max(right.size(), shout.size())); }
     };
 
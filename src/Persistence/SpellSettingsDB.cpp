@@ -7,8 +7,8 @@
 #include <nlohmann/json.hpp>
 
 #include "Config/Config.h"
-#include "Config/SpellType.h"
 #include "PCH.h"
+#include "State/FormTraits.h"
 
 namespace {
     std::string_view MakeKeyView(std::uint32_t id, std::array<char, 9>& buf) {
@@ -53,6 +53,7 @@ namespace IntegratedMagic {
         std::scoped_lock _{_mtx};
         _byKey.clear();
         _dirty = false;
+        _version.fetch_add(1, std::memory_order_release);
         if (!std::filesystem::exists(path)) {
             return;
         }
@@ -101,7 +102,7 @@ namespace IntegratedMagic {
 
         SpellSettings s{};
         if (form) {
-            const auto type = DetectSpellType(form);
+            const auto type = FormTraits::Get(form).spellType;
             const auto& d = GetMagicConfig().spellTypeDefaults[static_cast<int>(type)];
             s.mode = d.mode;
             s.autoAttack = d.autoAttack;
@@ -121,6 +122,7 @@ namespace IntegratedMagic {
             _byKey.try_emplace(std::string(keysv), s);
         }
         _dirty = true;
+        _version.fetch_add(1, std::memory_order_release);
     }
 
     bool SpellSettingsDB::IsDirty() const {
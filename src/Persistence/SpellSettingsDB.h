@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
 #include <filesystem>
 #include <functional>
@@ -34,6 +35,7 @@ namespace IntegratedMagic {
         void Set(std::uint32_t spellFormID, const SpellSettings& s);
         bool IsDirty() const;
         void ClearDirty();
+        std::uint32_t Version() const noexcept { return _version.load(std::memory_order_acquire); }
         static std::filesystem::path JsonPath();
 
     private:
@@ -41,6 +43,7 @@ namespace IntegratedMagic {
         std::unordered_map<std::string, IntegratedMagic::SpellSettings, TransparentStringHash, std::equal_to<>>
             _byKey{};
         bool _dirty{false};
+        std::atomic<std::uint32_t> _version{0};
         static std::string MakeKey(std::uint32_t spellFormID);
     };
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
+#include <utility>
+
 #include "AnimListener.h"
 
 #include "Config/Slots.h"
+#include "Diagnostics/FlightRecorder.h"
+#include "Diagnostics/Latency.h"
+#include "Diagnostics/Trace.h"
 #include "PCH.h"
 #include "State.h"
 
@@ -12,51 +17,44 @@ void AnimListener::HandleAnimEvent(const RE::BSAnimationGraphEvent* ev,
     if (auto const* player = RE::PlayerCharacter::GetSingleton(); !actor || actor != player) return;
 
     using Hand = IntegratedMagic::Slots::Hand;
+    namespace FR = IntegratedMagic::FlightRecorder;
     auto& state = IntegratedMagic::MagicState::Get();
     const std::string_view tag{ev->tag.c_str(), ev->tag.size()};
-#ifdef DEBUG
-    spdlog::info("[AnimListener] Event received: tag='{}' | state.active={}", ev->tag.c_str(), state.IsActive());
-#endif
+    IM_TRACE(Anim, "[AnimListener] Event received: tag='{}' | state.active={}", ev->tag.c_str(), state.IsActive());
 
     if (tag == "EnableBumper"sv) {
-#ifdef DEBUG
-        spdlog::info("[AnimListener] >> EnableBumper -> NotifyAttackEnabled");
-#endif
+        IM_TRACE(Anim, "[AnimListener] >> EnableBumper -> NotifyAttackEnabled");
+        FR::Record(FR::Event::EnableBumper);
         state.NotifyAttackEnabled();
     }
     if (tag == "CastStop"sv || tag == "RitualSpellOut"sv) {
-#ifdef DEBUG
-        spdlog::info("[AnimListener] >> CastStop -> OnCastStop");
-#endif
+        IM_TRACE(Anim, "[AnimListener] >> CastStop -> OnCastStop");
+        FR::Record(FR::Event::CastStop);
         state.OnCastStop();
     }
     if (tag == "InterruptCast"sv) {
-#ifdef DEBUG
-        spdlog::info("[AnimListener] >> InterruptCast -> OnCastInterrupt");
-#endif
+        IM_TRACE(Anim, "[AnimListener] >> InterruptCast -> OnCastInterrupt");
+        FR::Record(FR::Event::CastInterrupt);
         state.OnCastInterrupt();
     }
     if (tag == "BeginCastRight"sv) {
-#ifdef DEBUG
-        spdlog::info("[AnimListener] >> BeginCastRight -> OnBeginCast(Right)");
-#endif
+        IM_TRACE(Anim, "[AnimListener] >> BeginCastRight -> OnBeginCast(Right)");
+        IntegratedMagic::Latency::Mark(IntegratedMagic::Latency::Stage::BeginCast);
+        FR::Record(FR::Event::BeginCast, -1, std::to_underlying(Hand::Right));
         state.OnBeginCast(Hand::Right);
     } else if (tag == "BeginCastLeft"sv) {
-#ifdef DEBUG
-        spdlog::info("[AnimListener] >> BeginCastLeft -> OnBeginCast(Left)");
-#endif
+        IM_TRACE(Anim, "[AnimListener] >> BeginCastLeft -> OnBeginCast(Left)");
+        IntegratedMagic::Latency::Mark(IntegratedMagic::Latency::Stage::BeginCast);
+        FR::Record(FR::Event::BeginCast, -1, std::to_underlying(Hand::Left));
         state.OnBeginCast(Hand::Left);
     }
     if (tag == "shoutStop"sv) {
-#ifdef DEBUG
-        spdlog::info("[AnimListener] >> shoutStop -> OnShoutStop");
-#endif
+        IM_TRACE(Anim, "[AnimListener] >> shoutStop -> OnShoutStop");
+        FR::Record(FR::Event::ShoutStop);
         state.OnShoutStop();
     }
     if (tag == "blockStart"sv || tag == "BashExit"sv) {
-#ifdef DEBUG
-        spdlog::info("[AnimListener] >> {} -> ForceExit!", ev->tag.c_str());
-#endif
+        IM_TRACE(Anim, "[AnimListener] >> {} -> ForceExit!", ev->tag.c_str());
         if (!state.IsPressMode()) {
             state.ForceExit();
         }
@@ -64,15 +62,17 @@ void AnimListener::HandleAnimEvent(const RE::BSAnimationGraphEvent* ev,
     if (tag == "tailMTIdle"sv || tag == "IdleStop"sv) {
         if (state.IsWaitingSheatheRestore()) {
             state.NotifySheatheComplete();
-#ifdef DEBUG
-            spdlog::info("[AnimListener] >> {} -> NotifySheatheComplete!");
-#endif
+            IM_TRACE(Anim, "[AnimListener] >> {} -> NotifySheatheComplete!", ev->tag.c_str());
         }
     }
     if (tag == "MRh_SpellFire_Event"sv) {
+        IntegratedMagic::Latency::Mark(IntegratedMagic::Latency::Stage::SpellFire);
+        FR::Record(FR::Event::SpellFire, -1, std::to_underlying(Hand::Right));
         state.OnSpellFired(Hand::Right);
     }
     if (tag == "MLh_SpellFire_Event"sv) {
+        IntegratedMagic::Latency::Mark(IntegratedMagic::Latency::Stage::SpellFire);
+        FR::Record(FR::Event::SpellFire, -1, std::to_underlying(Hand::Left));
         state.OnSpellFired(Hand::Left);
     }
 }
\ No newline at end of file
@@ -115,9 +115,10 @@ namespace IntegratedMagic::MagicAssign {
         const auto s = static_cast<std::size_t>(slot);
 
         if (hand == Slots::Hand::Right)
-            cfg.slotSpellFormIDRight[s].store(0, std::memory_order_relaxed);
+            cfg.Bank().spellRight[s].store(0, std::memory_order_relaxed);
         else
-            cfg.slotSpellFormIDLeft[s].store(0, std::memory_order_relaxed);
+            cfg.Bank().spellLeft[s].store(0, std::memory_order_relaxed);
+        cfg.TouchSlots();
         cfg.Save();
         return true;
     }
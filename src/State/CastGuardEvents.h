@@ -1,4 +1,5 @@
 #pragma once
+#include "MenuState.h"
 #include "PCH.h"
 #include "State.h"
 
@@ -40,16 +41,9 @@ protected:
 
     RE::BSEventNotifyControl ProcessEvent(const RE::MenuOpenCloseEvent* ev,
                                           RE::BSTEventSource<RE::MenuOpenCloseEvent>*) override {
-        static constexpr std::array kInterruptMenus = {
-            "ContainerMenu"sv, "InventoryMenu"sv, "MagicMenu"sv, "MapMenu"sv, "Journal Menu"sv, "Dialogue Menu"sv,
-        };
-        if (ev && ev->opening) {
-            for (auto m : kInterruptMenus) {
-                if (ev->menuName == m) {
-                    IntegratedMagic::MagicState::Get().ForceExit();
-                    break;
-                }
-            }
+        if (ev && ev->opening &&
+            IntegratedMagic::MenuState::InCategory(ev->menuName, IntegratedMagic::MenuState::Category::CastInterrupt)) {
+            IntegratedMagic::MagicState::Get().ForceExit();
         }
         return RE::BSEventNotifyControl::kContinue;
     }
@@ -1,7 +1,9 @@
 #include "EquipSink.h"
 
 #include "Config/Slots.h"
+#include "Diagnostics/Trace.h"
 #include "PCH.h"
+#include "State/FormTraits.h"
 #include "State/State.h"
 
 namespace IntegratedMagic::EquipSink {
@@ -18,23 +20,12 @@ namespace IntegratedMagic::EquipSink {
             };
 
             for (const auto spellID : slotIDs) {
-                if (!spellID) continue;
-                const auto* spell = RE::TESForm::LookupByID<RE::SpellItem>(spellID);
-                if (!spell) continue;
-
-                for (const auto* effect : spell->effects) {
-                    if (!effect || !effect->baseEffect) continue;
-                    const auto* associated = effect->baseEffect->data.associatedForm;
-                    if (associated && associated->GetFormID() == weaponFormID) {
-#ifdef DEBUG
-                        spdlog::info(
-                            "[EquipSink] IsAssociatedBoundWeaponOfSlot: weaponID={:#010x} matched "
-                            "associatedForm of spell={:#010x} in slot={}",
-                            weaponFormID, spellID, activeSlot);
-#endif
-                        return true;
-                    }
-                }
+                if (!spellID || !FormTraits::Get(spellID).BindsWeapon(weaponFormID)) continue;
+                IM_TRACE(Equip,
+                         "[EquipSink] IsAssociatedBoundWeaponOfSlot: weaponID={:#010x} matched "
+                         "associatedForm of spell={:#010x} in slot={}",
+                         weaponFormID, spellID, activeSlot);
+                return true;
             }
             return false;
         }
@@ -54,9 +45,7 @@ namespace IntegratedMagic::EquipSink {
 
                 if (form->As<RE::TESShout>() || form->As<RE::SpellItem>()) {
                     s_lastEquippedMagicFormID.store(formID, std::memory_order_relaxed);
-#ifdef DEBUG
-                    spdlog::info("[EquipSink] cached formID={:#010x}", formID);
-#endif
+                    IM_TRACE(Equip, "[EquipSink] cached formID={:#010x}", formID);
                 }
 
                 auto& state = MagicState::Get();
@@ -77,11 +66,10 @@ namespace IntegratedMagic::EquipSink {
                                           spell->GetSpellType() == RE::MagicSystem::SpellType::kLesserPower);
                     if (isPower) {
                         if (!sID) return RE::BSEventNotifyControl::kContinue;
-#ifdef DEBUG
-                        spdlog::info(
+                        IM_TRACE(
+                            Equip,
                             "[EquipSink] foreign power {:#010x} equipped during active slot {} -> ForceExitNoRestore",
                             formID, activeSlot);
-#endif
                         if (auto* task = SKSE::GetTaskInterface()) {
                             task->AddTask([]() { MagicState::Get().ForceExitNoRestore(); });
                         }
@@ -103,12 +91,10 @@ namespace IntegratedMagic::EquipSink {
                     const bool conflictsLeft = isInLeftHand && (lID != 0);
 
                     if (!conflictsRight && !conflictsLeft) return RE::BSEventNotifyControl::kContinue;
-#ifdef DEBUG
-                    spdlog::info(
-                        "[EquipSink] foreign spell {:#010x} equipped in {} hand during active slot {} -> "
-                        "ForceExitNoRestore",
-                        formID, isInRightHand ? "right" : "left", activeSlot);
-#endif
+                    IM_TRACE(Equip,
+                             "[EquipSink] foreign spell {:#010x} equipped in {} hand during active slot {} -> "
+                             "ForceExitNoRestore",
+                             formID, isInRightHand ? "right" : "left", activeSlot);
                     if (auto* task = SKSE::GetTaskInterface()) {
                         task->AddTask([]() { MagicState::Get().ForceExitNoRestore(); });
                     }
@@ -121,11 +107,10 @@ namespace IntegratedMagic::EquipSink {
                     const auto sID = Slots::GetSlotShout(activeSlot);
                     if (!sID) return RE::BSEventNotifyControl::kContinue;
                     if (formID == sID) return RE::BSEventNotifyControl::kContinue;
-#ifdef DEBUG
-                    spdlog::info(
+                    IM_TRACE(
+                        Equip,
                         "[EquipSink] foreign shout/power {:#010x} equipped during active slot {} -> ForceExitNoRestore",
                         formID, activeSlot);
-#endif
                     if (auto* task = SKSE::GetTaskInterface()) {
                         task->AddTask([]() { MagicState::Get().ForceExitNoRestore(); });
                     }
@@ -138,10 +123,8 @@ namespace IntegratedMagic::EquipSink {
                     if (state.IsInSlotSetup() || state.IsShoutActive()) return RE::BSEventNotifyControl::kContinue;
 
                     if (form->As<RE::TESObjectWEAP>() && IsAssociatedBoundWeaponOfSlot(formID, activeSlot)) {
-#ifdef DEBUG
-                        spdlog::info("[EquipSink] weaponID={:#010x} is bound weapon of active slot {} -> ignoring",
-                                     formID, activeSlot);
-#endif
+                        IM_TRACE(Equip, "[EquipSink] weaponID={:#010x} is bound weapon of active slot {} -> ignoring",
+                                 formID, activeSlot);
                         return RE::BSEventNotifyControl::kContinue;
                     }
 
@@ -153,11 +136,10 @@ namespace IntegratedMagic::EquipSink {
                         const bool isShield = armature->HasPartOf(RE::BGSBipedObjectForm::BipedObjectSlot::kShield);
                         if (!isShield) return RE::BSEventNotifyControl::kContinue;
                         if (!lID) return RE::BSEventNotifyControl::kContinue;
-#ifdef DEBUG
-                        spdlog::info(
+                        IM_TRACE(
+                            Equip,
                             "[EquipSink] shield {:#010x} in left hand conflicts with slot {} -> ForceExitNoRestore",
                             formID, activeSlot);
-#endif
                         if (auto* task = SKSE::GetTaskInterface())
                             task->AddTask([]() { MagicState::Get().ForceExitNoRestore(); });
                         return RE::BSEventNotifyControl::kContinue;
@@ -174,11 +156,9 @@ namespace IntegratedMagic::EquipSink {
                     const bool conflictsLeft = (leftNow == formID) && (lID != 0);
 
                     if (!conflictsRight && !conflictsLeft) return RE::BSEventNotifyControl::kContinue;
-#ifdef DEBUG
-                    spdlog::info(
-                        "[EquipSink] weapon/misc {:#010x} in {} hand conflicts with slot {} -> ForceExitNoRestore",
-                        formID, conflictsRight ? "right" : "left", activeSlot);
-#endif
+                    IM_TRACE(Equip,
+                             "[EquipSink] weapon/misc {:#010x} in {} hand conflicts with slot {} -> ForceExitNoRestore",
+                             formID, conflictsRight ? "right" : "left", activeSlot);
                     if (auto* task = SKSE::GetTaskInterface())
                         task->AddTask([]() { MagicState::Get().ForceExitNoRestore(); });
                 }
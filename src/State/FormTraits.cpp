@@ -0,0 +1,195 @@
+#include "FormTraits.h"
+
+#include <array>
+#include <atomic>
+
+#include "PCH.h"
+#include "State/SpellClassify.h"
+
+namespace IntegratedMagic::FormTraits {
+    namespace {
+        constexpr std::size_t kBits = 12;
+        constexpr std::size_t kCapacity = std::size_t{1} << kBits;
+        constexpr std::size_t kMask = kCapacity - 1;
+        constexpr std::size_t kMaxProbe = 32;
+
+        struct Cell {
+            std::atomic<RE::FormID> key{0};
+            std::atomic<bool> ready{false};
+            Traits value{};
+        };
+
+        std::array<Cell, kCapacity> g_cells{};
+
+        constexpr std::size_t Hash(RE::FormID id) noexcept {
+            return static_cast<std::size_t>((id * 2654435761u) >> (32 - kBits));
+        }
+
+        constexpr bool IsDynamic(RE::FormID id) noexcept { return (id >> 24) == 0xFF; }
+
+        School ToSchool(RE::ActorValue av) noexcept {
+            switch (av) {
+                using enum RE::ActorValue;
+                case kAlteration:
+                    return School::Alteration;
+                case kConjuration:
+                    return School::Conjuration;
+                case kDestruction:
+                    return School::Destruction;
+                case kIllusion:
+                    return School::Illusion;
+                case kRestoration:
+                    return School::Restoration;
+                default:
+                    return School::None;
+            }
+        }
+
+        SpellIconType SchoolIcon(School school, RE::ActorValue resist) noexcept {
+            using enum SpellIconType;
+            switch (school) {
+                case School::Alteration:
+                    return alteration;
+                case School::Conjuration:
+                    return conjuration;
+                case School::Illusion:
+                    return illusion;
+                case School::Restoration:
+                    return restoration;
+                case School::Destruction:
+                    if (resist == RE::ActorValue::kResistFire) return destruction_fire;
+                    if (resist == RE::ActorValue::kResistShock) return destruction_shock;
+                    if (resist == RE::ActorValue::kResistFrost) return destruction_frost;
+                    return destruction;
+                default:
+                    return spell_default;
+            }
+        }
+
+        RE::BGSPerk* DualCastPerk(RE::ActorValue skill) {
+            RE::FormID perkID = 0;
+            switch (skill) {
+                using enum RE::ActorValue;
+                case kAlteration:
+                    perkID = 0x000153CD;
+                    break;
+                case kConjuration:
+                    perkID = 0x000153CE;
+                    break;
+                case kDestruction:
+                    perkID = 0x000153CF;
+                    break;
+                case kIllusion:
+                    perkID = 0x000153D0;
+                    break;
+                case kRestoration:
+                    perkID = 0x000153D1;
+                    break;
+                default:
+                    return nullptr;
+            }
+            return RE::TESForm::LookupByID<RE::BGSPerk>(perkID);
+        }
+
+        HandClass ClassifyHand(const RE::SpellItem* spell) {
+            using ST = RE::MagicSystem::SpellType;
+            const auto t = spell->GetSpellType();
+            const bool isPower = t == ST::kPower || t == ST::kLesserPower || t == ST::kVoicePower;
+            switch (SpellClassify::GetSpellEquipSlotID(spell)) {
+                case SpellClassify::kBothHandsSlotID:
+                    return isPower ? HandClass::Either : HandClass::TwoHanded;
+                case SpellClassify::kRightHandSlotID:
+                    return HandClass::RightOnly;
+                case SpellClassify::kLeftHandSlotID:
+                    return HandClass::LeftOnly;
+                default:
+                    return HandClass::Either;
+            }
+        }
+
+        Traits Build(const RE::TESForm* form) {
+            Traits t{};
+            if (!form) return t;
+            t.formType = form->GetFormType();
+            t.spellType = DetectSpellType(form);
+            t.name = form->GetName();
+            if (t.IsShout()) {
+                t.icon = SpellIconType::shout;
+                return t;
+            }
+
+            const auto* item = form->As<RE::MagicItem>();
+            if (!item) return t;
+
+            using ArchetypeID = RE::EffectArchetypes::ArchetypeID;
+            for (const auto* effect : item->effects) {
+                if (!effect || !effect->baseEffect) continue;
+                const auto arch = effect->baseEffect->GetArchetype();
+                if (arch == ArchetypeID::kWerewolf || arch == ArchetypeID::kVampireLord) t.transform = true;
+                const auto* associated = effect->baseEffect->data.associatedForm;
+                if (!associated || !associated->Is(RE::FormType::Weapon)) continue;
+                const auto weaponID = associated->GetFormID();
+                if (t.BindsWeapon(weaponID)) continue;
+                if (t.boundWeaponCount < t.boundWeapons.size()) {
+                    t.boundWeapons[t.boundWeaponCount++] = weaponID;
+                } else {
+                    spdlog::warn("[FormTraits] {:#010x}: more than {} bound weapons, ignoring {:#010x}",
+                                 form->GetFormID(), Traits::kMaxBoundWeapons, weaponID);
+                }
+            }
+
+            auto resist = RE::ActorValue::kNone;
+            if (const auto* fx = item->GetCostliestEffectItem(); fx && fx->baseEffect) {
+                auto av = fx->baseEffect->GetMagickSkill();
+                if (av == RE::ActorValue::kNone) av = fx->baseEffect->data.primaryAV;
+                t.school = ToSchool(av);
+                resist = fx->baseEffect->data.resistVariable;
+            }
+            t.icon = SchoolIcon(t.school, resist);
+
+            if (const auto* spell = form->As<RE::SpellItem>()) {
+                using ST = RE::MagicSystem::SpellType;
+                const auto st = spell->GetSpellType();
+                if (st == ST::kPower || st == ST::kLesserPower) {
+                    t.icon = SpellIconType::power;
+                } else if (st == ST::kVoicePower) {
+                    t.icon = SpellIconType::shout;
+                }
+                t.hand = ClassifyHand(spell);
+                t.dualCastPerk = DualCastPerk(spell->GetAssociatedSkill());
+            }
+            return t;
+        }
+
+        Traits Resolve(RE::FormID id, const RE::TESForm* form) {
+            if (!id) return {};
+            if (IsDynamic(id)) return Build(form ? form : RE::TESForm::LookupByID(id));
+
+            auto i = Hash(id);
+            for (std::size_t probe = 0; probe < kMaxProbe; ++probe, i = (i + 1) & kMask) {
+                auto& cell = g_cells[i];
+                auto key = cell.key.load(std::memory_order_acquire);
+                if (key == 0) {
+                    if (!form) form = RE::TESForm::LookupByID(id);
+                    if (!form) return {};
+                    const auto t = Build(form);
+                    if (cell.key.compare_exchange_strong(key, id, std::memory_order_acq_rel)) {
+                        cell.value = t;
+                        cell.ready.store(true, std::memory_order_release);
+                        return t;
+                    }
+                    if (key == id) return t;
+                    continue;
+                }
+                if (key != id) continue;
+                if (cell.ready.load(std::memory_order_acquire)) return cell.value;
+                break;
+            }
+            return Build(form ? form : RE::TESForm::LookupByID(id));
+        }
+    }
+
+    Traits Get(RE::FormID formID) { return Resolve(formID, nullptr); }
+
+    Traits Get(const RE::TESForm* form) { return form ? Resolve(form->GetFormID(), form) : Traits{}; }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "Config/SpellType.h"
+#include "PCH.h"
+
+namespace IntegratedMagic {
+
+    enum class SpellIconType : std::int32_t {
+        spell_default = 0,
+        alteration,
+        conjuration,
+        illusion,
+        restoration,
+        destruction,
+        destruction_fire,
+        destruction_frost,
+        destruction_shock,
+        power,
+        shout,
+        total
+    };
+}
+
+namespace IntegratedMagic::FormTraits {
+
+    enum class HandClass : std::uint8_t { Either = 0, TwoHanded, RightOnly, LeftOnly };
+
+    enum class School : std::uint8_t { None = 0, Alteration, Conjuration, Destruction, Illusion, Restoration };
+
+    struct Traits {
+        static constexpr std::size_t kMaxBoundWeapons = 4;
+
+        RE::FormType formType{RE::FormType::None};
+        SpellType spellType{SpellType::Unknown};
+        HandClass hand{HandClass::Either};
+        School school{School::None};
+        SpellIconType icon{SpellIconType::spell_default};
+        bool transform{false};
+        std::array<RE::FormID, kMaxBoundWeapons> boundWeapons{};
+        std::uint8_t boundWeaponCount{0};
+        const char* name{nullptr};
+        RE::BGSPerk* dualCastPerk{nullptr};
+
+        [[nodiscard]] bool Valid() const noexcept { return formType != RE::FormType::None; }
+        [[nodiscard]] bool IsSpell() const noexcept { return formType == RE::FormType::Spell; }
+        [[nodiscard]] bool IsShout() const noexcept { return formType == RE::FormType::Shout; }
+        [[nodiscard]] bool BindsWeapon(RE::FormID id) const noexcept {
+            const auto end = boundWeapons.begin() + boundWeaponCount;
+            return id && std::find(boundWeapons.begin(), end, id) != end;
+        }
+    };
+
+    [[nodiscard]] Traits Get(RE::FormID formID);
+    [[nodiscard]] Traits Get(const RE::TESForm* form);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace IntegratedMagic {
+
+    enum class HandPhase : std::uint8_t {
+        Idle,
+        Hold,
+        HoldReleased,
+        AutoCharging,
+        AutoCharged,
+        Press,
+        PressCharging,
+        PressCharged,
+        Finished,
+        kCount
+    };
+
+    enum class HandEvent : std::uint8_t {
+        Pressed,
+        Released,
+        ReleasedCharged,
+        ChargeComplete,
+        CastStop,
+        SpellFire,
+        Interrupt,
+        Timeout,
+        Finish,
+        kCount
+    };
+
+    namespace HandMachine {
+        inline constexpr auto kPhaseCount = static_cast<std::size_t>(HandPhase::kCount);
+        inline constexpr auto kEventCount = static_cast<std::size_t>(HandEvent::kCount);
+
+        using Table = std::array<std::array<HandPhase, kEventCount>, kPhaseCount>;
+
+        consteval Table BuildTable() {
+            using P = HandPhase;
+            using E = HandEvent;
+            Table t{};
+            auto set = [&t](P p, E e, P next) { t[static_cast<std::size_t>(p)][static_cast<std::size_t>(e)] = next; };
+            for (std::size_t p = 0; p < kPhaseCount; ++p) {
+                for (std::size_t e = 0; e < kEventCount; ++e) t[p][e] = static_cast<P>(p);
+                set(static_cast<P>(p), E::Timeout, P::Finished);
+                set(static_cast<P>(p), E::Finish, P::Finished);
+            }
+
+            set(P::Hold, E::Released, P::Finished);
+            set(P::Hold, E::ReleasedCharged, P::HoldReleased);
+            set(P::HoldReleased, E::CastStop, P::Finished);
+
+            set(P::AutoCharging, E::ChargeComplete, P::AutoCharged);
+            set(P::AutoCharging, E::Interrupt, P::Finished);
+            set(P::AutoCharged, E::CastStop, P::Finished);
+            set(P::AutoCharged, E::SpellFire, P::Finished);
+            set(P::AutoCharged, E::Interrupt, P::Finished);
+
+            set(P::Press, E::Pressed, P::Finished);
+            set(P::PressCharging, E::Pressed, P::Finished);
+            set(P::PressCharging, E::ChargeComplete, P::PressCharged);
+            set(P::PressCharging, E::Interrupt, P::Finished);
+            set(P::PressCharged, E::Pressed, P::Finished);
+            set(P::PressCharged, E::CastStop, P::Press);
+            set(P::PressCharged, E::SpellFire, P::Press);
+            set(P::PressCharged, E::Interrupt, P::Finished);
+            return t;
+        }
+
+        inline constexpr Table kTransitions = BuildTable();
+
+        [[nodiscard]] constexpr HandPhase Next(HandPhase p, HandEvent e) noexcept {
+            return kTransitions[static_cast<std::size_t>(p)][static_cast<std::size_t>(e)];
+        }
+
+        [[nodiscard]] constexpr const char* PhaseName(HandPhase p) noexcept {
+            constexpr std::array<const char*, kPhaseCount> kNames{
+                "Idle", "Hold", "HoldReleased", "AutoCharging", "AutoCharged", "Press", "PressCharging", "PressCharged",
+                "Finished"};
+            return p < HandPhase::kCount ? kNames[static_cast<std::size_t>(p)] : "?";
+        }
+
+        [[nodiscard]] constexpr const char* EventName(HandEvent e) noexcept {
+            constexpr std::array<const char*, kEventCount> kNames{
+                "Pressed", "Released", "ReleasedCharged", "ChargeComplete", "CastStop", "SpellFire", "Interrupt",
+                "Timeout", "Finish"};
+            return e < HandEvent::kCount ? kNames[static_cast<std::size_t>(e)] : "?";
+        }
+
+        consteval bool FinishedIsAbsorbing() {
+            for (std::size_t e = 0; e < kEventCount; ++e)
+                if (Next(HandPhase::Finished, static_cast<HandEvent>(e)) != HandPhase::Finished) return false;
+            return true;
+        }
+
+        consteval bool ReachesFinishedByGameEvents(HandPhase from) {
+            std::array<bool, kPhaseCount> seen{};
+            seen[static_cast<std::size_t>(from)] = true;
+            for (bool grew = true; grew;) {
+                grew = false;
+                for (std::size_t q = 0; q < kPhaseCount; ++q) {
+                    if (!seen[q]) continue;
+                    for (std::size_t e = 0; e < kEventCount; ++e) {
+                        const auto ev = static_cast<HandEvent>(e);
+                        if (ev == HandEvent::Timeout || ev == HandEvent::Finish) continue;
+                        const auto n = static_cast<std::size_t>(Next(static_cast<HandPhase>(q), ev));
+                        if (!seen[n]) seen[n] = grew = true;
+                    }
+                }
+            }
+            return seen[static_cast<std::size_t>(HandPhase::Finished)];
+        }
+
+        consteval bool NoStuckPhases() {
+            for (std::size_t p = 0; p < kPhaseCount; ++p) {
+                const auto phase = static_cast<HandPhase>(p);
+                if (phase != HandPhase::Idle && !ReachesFinishedByGameEvents(phase)) return false;
+            }
+            return true;
+        }
+
+        static_assert(FinishedIsAbsorbing(), "A finished hand must stay finished until it is re-entered.");
+        static_assert(NoStuckPhases(), "Every active hand phase must be able to finish without a forced exit.");
+    }
+
+}
@@ -7,6 +7,7 @@
 #include "Action.h"
 #include "Config/EquipSlots.h"
 #include "Config/Slots.h"
+#include "FormTraits.h"
 #include "PCH.h"
 
 namespace IntegratedMagic {
@@ -133,29 +134,7 @@ namespace IntegratedMagic {
 
     float GetDualCastCostMultiplier(RE::PlayerCharacter const* player, RE::SpellItem const* spell) {
         if (!player || !spell) return 2.0f;
-
-        RE::FormID dualCastPerkID = 0;
-        switch (spell->GetAssociatedSkill()) {
-            using enum RE::ActorValue;
-            case kAlteration:
-                dualCastPerkID = 0x000153CD;
-                break;
-            case kConjuration:
-                dualCastPerkID = 0x000153CE;
-                break;
-            case kDestruction:
-                dualCastPerkID = 0x000153CF;
-                break;
-            case kIllusion:
-                dualCastPerkID = 0x000153D0;
-                break;
-            case kRestoration:
-                dualCastPerkID = 0x000153D1;
-                break;
-            default:
-                return 2.0f;
-        }
-        auto* perk = RE::TESForm::LookupByID<RE::BGSPerk>(dualCastPerkID);
+        auto* perk = FormTraits::Get(spell).dualCastPerk;
         return (perk && player->HasPerk(perk)) ? 2.8f : 2.0f;
     }
 
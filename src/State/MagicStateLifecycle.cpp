@@ -2,6 +2,8 @@
 
 #include "Action.h"
 #include "Config/EquipSlots.h"
+#include "Diagnostics/FlightRecorder.h"
+#include "Diagnostics/Trace.h"
 #include "InventoryUtil.h"
 #include "PCH.h"
 #include "Persistence/SpellSettingsDB.h"
@@ -49,25 +51,23 @@ namespace IntegratedMagic {
 
     void MagicState::EnsureActiveWithSnapshot(RE::PlayerCharacter const* player, int slot, bool raiseHandsIfSheathed) {
         if (_session.active) {
-#ifdef DEBUG
-            spdlog::info("[State] EnsureActiveWithSnapshot: already active, updating slot {} -> {}",
-                         _session.activeSlot, slot);
-#endif
+            IM_TRACE(State, "[State] EnsureActiveWithSnapshot: already active, updating slot {} -> {}",
+                     _session.activeSlot, slot);
             _session.activeSlot = slot;
             return;
         }
 
-        CaptureSnapshot(player);
-        _restore.prevExtraEquipped.clear();
+        if (_preEquip.slot != slot) {
+            CaptureSnapshot(player);
+            _restore.prevExtraEquipped.clear();
+        }
         _restore.ClearPending();
 
         auto* pc = const_cast<RE::PlayerCharacter*>(player);
         const auto ws = pc->AsActorState()->GetWeaponState();
         _session.wasHandsDown = (ws == RE::WEAPON_STATE::kSheathed);
-#ifdef DEBUG
-        spdlog::info("[State] EnsureActiveWithSnapshot: ACTIVATING slot={} wasHandsDown={} weaponState={}", slot,
-                     _session.wasHandsDown, static_cast<int>(std::to_underlying(ws)));
-#endif
+        IM_TRACE(State, "[State] EnsureActiveWithSnapshot: ACTIVATING slot={} wasHandsDown={} weaponState={}", slot,
+                 _session.wasHandsDown, static_cast<int>(std::to_underlying(ws)));
         if (_session.wasHandsDown && raiseHandsIfSheathed) {
             pc->DrawWeaponMagicHands(true);
         }
@@ -81,7 +81,7 @@ namespace IntegratedMagic {
         _right = {};
         _aa.Reset();
         _shout.Reset();
-        _session.activeTimeoutSecs = 0.f;
+        Timers::Arm(Timers::Timer::ActiveTimeout, 0, kMaxActiveTimeoutSecs);
     }
 
     void MagicState::CaptureSnapshot(RE::PlayerCharacter const* player) {
@@ -124,12 +124,10 @@ namespace IntegratedMagic {
             }
         }
         _restore.snapshot.valid = true;
-#ifdef DEBUG
-        spdlog::info("[State] CaptureSnapshot: snapShoutID={:#010x} rightSpell={:#010x} leftSpell={:#010x}",
-                     _restore.snapshot.snapShoutID,
-                     _restore.snapshot.rightSpell ? _restore.snapshot.rightSpell->GetFormID() : 0u,
-                     _restore.snapshot.leftSpell ? _restore.snapshot.leftSpell->GetFormID() : 0u);
-#endif
+        IM_TRACE(State, "[State] CaptureSnapshot: snapShoutID={:#010x} rightSpell={:#010x} leftSpell={:#010x}",
+                 _restore.snapshot.snapShoutID,
+                 _restore.snapshot.rightSpell ? _restore.snapshot.rightSpell->GetFormID() : 0u,
+                 _restore.snapshot.leftSpell ? _restore.snapshot.leftSpell->GetFormID() : 0u);
     }
 
     void MagicState::RestoreSnapshot(RE::PlayerCharacter* player) {
@@ -139,10 +137,8 @@ namespace IntegratedMagic {
         auto* mgr = RE::ActorEquipManager::GetSingleton();
         if (!mgr) return;
 
-#ifdef DEBUG
-        spdlog::info("[State] RestoreSnapshot: dirtyLeft={} dirtyRight={} dirtyShout={} snapShoutID={:#010x}",
-                     _restore.dirtyLeft, _restore.dirtyRight, _restore.dirtyShout, _restore.snapshot.snapShoutID);
-#endif
+        IM_TRACE(State, "[State] RestoreSnapshot: dirtyLeft={} dirtyRight={} dirtyShout={} snapShoutID={:#010x}",
+                 _restore.dirtyLeft, _restore.dirtyRight, _restore.dirtyShout, _restore.snapshot.snapShoutID);
 
         _session.wasHandsDown = false;
         MagicAction::ApplySkipEquipAnimReturn(player);
@@ -156,17 +152,13 @@ namespace IntegratedMagic {
         auto* leftSnapSpell = snap.leftObj.base ? nullptr : AsSpell(snap.leftSpell);
 
         if (_restore.dirtyRight) {
-#ifdef DEBUG
-            spdlog::info("[State] RestoreSnapshot: restoring Right hand");
-#endif
+            IM_TRACE(State, "[State] RestoreSnapshot: restoring Right hand");
             ClearHandSpellIfNoSnapshot(player, rightSnapSpell, _session.modeSpellRight, Right);
             RestoreOneHand(player, mgr, idx, false, snap.rightObj, rightSlot);
             EquipSpellIfPresent(player, rightSnapSpell, Right);
         }
         if (_restore.dirtyLeft) {
-#ifdef DEBUG
-            spdlog::info("[State] RestoreSnapshot: restoring Left hand");
-#endif
+            IM_TRACE(State, "[State] RestoreSnapshot: restoring Left hand");
             ClearHandSpellIfNoSnapshot(player, leftSnapSpell, _session.modeSpellLeft, Left);
             RestoreOneHand(player, mgr, idx, true, snap.leftObj, leftSlot);
             EquipSpellIfPresent(player, leftSnapSpell, Left);
@@ -174,9 +166,7 @@ namespace IntegratedMagic {
                 RestoreOneHand(player, mgr, idx, false, snap.rightObj, rightSlot);
         }
         if (_restore.dirtyShout) {
-#ifdef DEBUG
-            spdlog::info("[State] RestoreSnapshot: restoring shout, snapShoutID={:#010x}", snap.snapShoutID);
-#endif
+            IM_TRACE(State, "[State] RestoreSnapshot: restoring shout, snapShoutID={:#010x}", snap.snapShoutID);
             MagicAction::ClearVoiceShout(player);
             if (snap.snapShoutID) {
                 if (auto* form = RE::TESForm::LookupByID(snap.snapShoutID))
@@ -191,9 +181,7 @@ namespace IntegratedMagic {
         _session.modeSpellLeft = nullptr;
         _session.modeSpellRight = nullptr;
         _restore.ClearDirty();
-#ifdef DEBUG
-        spdlog::info("[State] RestoreSnapshot: done");
-#endif
+        IM_TRACE(State, "[State] RestoreSnapshot: done");
     }
 
     bool MagicState::HandIsRelevant(Slots::Hand h) const {
@@ -206,7 +194,7 @@ namespace IntegratedMagic {
         if (_shout.modeShoutID != 0) return _shout.finished;
         const bool needL = HandIsRelevant(Left);
         const bool needR = HandIsRelevant(Right);
-        return (!needL || _left.finished) && (!needR || _right.finished);
+        return (!needL || _left.Finished()) && (!needR || _right.Finished());
     }
 
     bool MagicState::CanOverwriteNow() const {
@@ -220,16 +208,16 @@ namespace IntegratedMagic {
         const bool needL = (_session.modeSpellLeft != nullptr);
         const bool needR = (_session.modeSpellRight != nullptr);
         if (!needL && !needR) return false;
-        if ((needL && (_left.holdActive || _left.autoActive || _left.holdFiredAndWaitingCastStop)) ||
-            (needR && (_right.holdActive || _right.autoActive || _right.holdFiredAndWaitingCastStop))) {
+        if ((needL && (_left.HoldActive() || _left.AutoActive() || _left.HoldFired())) ||
+            (needR && (_right.HoldActive() || _right.AutoActive() || _right.HoldFired()))) {
             return false;
         }
         int pressCount = 0;
         if (needL && _left.mode == Press) ++pressCount;
         if (needR && _right.mode == Press) ++pressCount;
         if (pressCount == 0) return false;
-        if (needL && _left.mode != Press && !_left.finished) return false;
-        if (needR && _right.mode != Press && !_right.finished) return false;
+        if (needL && _left.mode != Press && !_left.Finished()) return false;
+        if (needR && _right.mode != Press && !_right.Finished()) return false;
         return true;
     }
 
@@ -238,8 +226,8 @@ namespace IntegratedMagic {
         auto* pc = GetPlayer();
         if (!pc) return true;
         if (PlayerIsDead(pc)) return true;
-        if (PlayerIsKnockedOrStaggered(pc) && (!_left.pressActive && !_right.pressActive)) return true;
-        if (PlayerIsBlocking(pc) && (!_left.pressActive && !_right.pressActive)) return true;
+        if (PlayerIsKnockedOrStaggered(pc) && (!_left.PressActive() && !_right.PressActive())) return true;
+        if (PlayerIsBlocking(pc) && (!_left.PressActive() && !_right.PressActive())) return true;
 
         if (!_restore.pendingRestoreAfterSheathe && _shout.modeShoutID == 0 && PlayerIsSheathingOrSheathed(pc))
             return true;
@@ -247,18 +235,14 @@ namespace IntegratedMagic {
         if (_session.modeSpellRight) {
             auto* caster = MagicAction::GetCaster(pc, RE::MagicSystem::CastingSource::kRightHand);
             if (CasterSpellMismatch(caster, _session.modeSpellRight)) {
-#ifdef DEBUG
-                spdlog::info("[State] ShouldForceInterrupt: TRUE - Right caster spell mismatch");
-#endif
+                IM_TRACE(State, "[State] ShouldForceInterrupt: TRUE - Right caster spell mismatch");
                 return true;
             }
         }
         if (_session.modeSpellLeft) {
             auto* caster = MagicAction::GetCaster(pc, RE::MagicSystem::CastingSource::kLeftHand);
             if (CasterSpellMismatch(caster, _session.modeSpellLeft)) {
-#ifdef DEBUG
-                spdlog::info("[State] ShouldForceInterrupt: TRUE - Left caster spell mismatch");
-#endif
+                IM_TRACE(State, "[State] ShouldForceInterrupt: TRUE - Left caster spell mismatch");
                 return true;
             }
         }
@@ -268,28 +252,23 @@ namespace IntegratedMagic {
     void MagicState::TryFinalizeExit() {
         if (!_session.active) return;
         const bool allFinished = AllRelevantHandsFinished();
-#ifdef DEBUG
-        spdlog::info("[State] TryFinalizeExit: allFinished={} left.finished={} right.finished={} shoutFinished={}",
-                     allFinished, _left.finished, _right.finished, _shout.finished);
-#endif
+        IM_TRACE(State, "[State] TryFinalizeExit: allFinished={} left.finished={} right.finished={} shoutFinished={}",
+                 allFinished, _left.Finished(), _right.Finished(), _shout.finished);
         if (allFinished) ExitAllNow();
     }
 
     void MagicState::ExitAllNow() {
-#ifdef DEBUG
-        spdlog::info(
-            "[State] ExitAllNow: modeShoutID={:#010x} shoutIsPower={} shoutFinished={} "
-            "firstInterrupt={} active={} wasHandsDown={} pendingRestore={}",
-            _shout.modeShoutID, _shout.isPower, _shout.finished, _session.firstInterrupt, _session.active,
-            _session.wasHandsDown, _restore.pendingRestore);
-#endif
+        FlightRecorder::Record(FlightRecorder::Event::Exit, _session.activeSlot);
+        IM_TRACE(State,
+                 "[State] ExitAllNow: modeShoutID={:#010x} shoutIsPower={} shoutFinished={} "
+                 "firstInterrupt={} active={} wasHandsDown={} pendingRestore={}",
+                 _shout.modeShoutID, _shout.isPower, _shout.finished, _session.firstInterrupt, _session.active,
+                 _session.wasHandsDown, _restore.pendingRestore);
 
         if (_shout.modeShoutID != 0 && _shout.isPower && _shout.finished) {
-#ifdef DEBUG
-            spdlog::info("[State] ExitAllNow: power path -> pendingPowerRestore, dispatching StopShoutPress");
-#endif
+            IM_TRACE(State, "[State] ExitAllNow: power path -> pendingPowerRestore, dispatching StopShoutPress");
             _restore.pendingPowerRestore = true;
-            _restore.pendingPowerRestoreDelaySecs = RestoreContext::kPowerRestoreDelaySec;
+            Timers::Arm(Timers::Timer::PowerRestoreDelay, 0, RestoreContext::kPowerRestoreDelaySec);
             StopAllAutoAttack();
             StopShoutPress();
             CancelAllDelayedStarts();
@@ -316,25 +295,21 @@ namespace IntegratedMagic {
         CancelAllDelayedStarts();
 
         if (_session.wasHandsDown && !player->IsInCombat()) {
-#ifdef DEBUG
-            spdlog::info("[State] ExitAllNow: hands were down -> sheathing before restore");
-#endif
+            IM_TRACE(State, "[State] ExitAllNow: hands were down -> sheathing before restore");
             player->DrawWeaponMagicHands(false);
             _restore.pendingRestoreAfterSheathe = true;
+            _restore.sheatheWaitTimedOut = false;
+            Timers::Arm(Timers::Timer::SheatheWait, 0, RestoreContext::kSheatheWaitTimeoutSec);
             return;
         }
 
         if (_session.firstInterrupt > 1) {
-#ifdef DEBUG
-            spdlog::info("[State] ExitAllNow: firstInterrupt={} > 1 -> pendingRestore", _session.firstInterrupt);
-#endif
+            IM_TRACE(State, "[State] ExitAllNow: firstInterrupt={} > 1 -> pendingRestore", _session.firstInterrupt);
             _restore.pendingRestore = true;
             return;
         }
 
-#ifdef DEBUG
-        spdlog::info("[State] ExitAllNow: immediate RestoreSnapshot");
-#endif
+        IM_TRACE(State, "[State] ExitAllNow: immediate RestoreSnapshot");
         RestoreSnapshot(player);
         if (auto* mgr = RE::ActorEquipManager::GetSingleton()) {
             auto idx = BuildInventoryIndex(player);
@@ -344,9 +319,7 @@ namespace IntegratedMagic {
     }
 
     void MagicState::PrepareForOverwriteToSlot(int newSlot) {
-#ifdef DEBUG
-        spdlog::info("[State] PrepareForOverwriteToSlot: newSlot={}", newSlot);
-#endif
+        IM_TRACE(State, "[State] PrepareForOverwriteToSlot: newSlot={}", newSlot);
         StopAllAutoAttack();
         _session.activeSlot = newSlot;
         _session.attackEnabled = false;
@@ -359,16 +332,16 @@ namespace IntegratedMagic {
         _aa.Reset();
         _shout.Reset();
         _restore.pendingPowerRestore = false;
-        _restore.pendingPowerRestoreDelaySecs = 0.f;
         _restore.pendingRestoreAfterSheathe = false;
     }
 
     void MagicState::ForceExit() {
         if (!_session.active) return;
-#ifdef DEBUG
-        spdlog::info("[State] ForceExit: slot={} left.autoActive={} right.autoActive={} aaHeldL={} aaHeldR={}",
-                     _session.activeSlot, _left.autoActive, _right.autoActive, _aa.heldLeft, _aa.heldRight);
-#endif
+        FlightRecorder::Record(FlightRecorder::Event::ForceExit, _session.activeSlot);
+        FlightRecorder::Dump("ForceExit");
+        IM_TRACE(State, "[State] ForceExit: slot={} left={} right={} aaHeldL={} aaHeldR={}", _session.activeSlot,
+                 HandMachine::PhaseName(_left.phase), HandMachine::PhaseName(_right.phase), _aa.heldLeft,
+                 _aa.heldRight);
         StopAllAutoAttack();
         CancelAllDelayedStarts();
         _left = {};
@@ -384,9 +357,7 @@ namespace IntegratedMagic {
 
     void MagicState::ForceExitNoRestore() {
         if (!_session.active) return;
-#ifdef DEBUG
-        spdlog::info("[State] ForceExitNoRestore: discarding snapshot and forcing exit");
-#endif
+        IM_TRACE(State, "[State] ForceExitNoRestore: discarding snapshot and forcing exit");
         _restore.snapshot = {};
         ForceExit();
     }
@@ -1,5 +1,7 @@
 #include "Action.h"
 #include "Config/Slots.h"
+#include "Diagnostics/FlightRecorder.h"
+#include "Diagnostics/Trace.h"
 #include "InventoryUtil.h"
 #include "PCH.h"
 #include "Persistence/SpellSettingsDB.h"
@@ -9,9 +11,7 @@
 namespace IntegratedMagic {
 
     void MagicState::StartAutoAttack(Slots::Hand hand) {
-#ifdef DEBUG
-        spdlog::info("[State] StartAutoAttack: hand={}", IsLeft(hand) ? "Left" : "Right");
-#endif
+        IM_TRACE(State, "[State] StartAutoAttack: hand={}", IsLeft(hand) ? "Left" : "Right");
         _aa.Held(hand) = true;
         _aa.Secs(hand) = 0.f;
         detail::DispatchAttack(hand, 1.0f, 0.0f);
@@ -20,9 +20,7 @@ namespace IntegratedMagic {
     void MagicState::StopAutoAttack(Slots::Hand hand) {
         if (!_aa.Held(hand)) return;
         const float held = (_aa.Secs(hand) > 0.f) ? _aa.Secs(hand) : 0.1f;
-#ifdef DEBUG
-        spdlog::info("[State] StopAutoAttack: hand={} heldSecs={:.3f}", IsLeft(hand) ? "Left" : "Right", held);
-#endif
+        IM_TRACE(State, "[State] StopAutoAttack: hand={} heldSecs={:.3f}", IsLeft(hand) ? "Left" : "Right", held);
         detail::DispatchAttack(hand, 0.0f, held);
         _aa.Held(hand) = false;
         _aa.Secs(hand) = 0.f;
@@ -53,33 +51,31 @@ namespace IntegratedMagic {
 
     void MagicState::NotifyAttackEnabled() {
         if (!_session.active) {
-#ifdef DEBUG
-            spdlog::info("[State] NotifyAttackEnabled: ignored - not active");
-#endif
+            IM_TRACE(State, "[State] NotifyAttackEnabled: ignored - not active");
             return;
         }
         _session.attackEnabled = true;
 
         if (auto* player = GetPlayer()) MagicAction::DisableSkipEquipVarsNow(player);
-#ifdef DEBUG
-        spdlog::info(
-            "[State] NotifyAttackEnabled: left.waitingAutoAfterEquip={} right.waitingAutoAfterEquip={} "
-            "aaHeldLeft={} aaHeldRight={}",
-            _left.waitingAutoAfterEquip, _right.waitingAutoAfterEquip, _aa.heldLeft, _aa.heldRight);
-#endif
+        IM_TRACE(State,
+                 "[State] NotifyAttackEnabled: left.waitingAutoAfterEquip={} right.waitingAutoAfterEquip={} "
+                 "aaHeldLeft={} aaHeldRight={}",
+                 _left.waitingAutoAfterEquip, _right.waitingAutoAfterEquip, _aa.heldLeft, _aa.heldRight);
         using enum Slots::Hand;
         auto tryStart = [&](Slots::Hand hand) {
             auto& hm = ModeFor(hand);
-            if (!hm.waitingAutoAfterEquip) return;
+            if (!hm.waitingAutoAfterEquip) {
+                if (hm.waitingBeginCast) ArmBeginCastWait(hand);
+                return;
+            }
             hm.waitingAutoAfterEquip = false;
-            if (!(hm.autoActive || hm.wantAutoAttack) || _aa.Held(hand)) return;
-#ifdef DEBUG
-            spdlog::info("[State] NotifyAttackEnabled: starting {} auto attack", IsLeft(hand) ? "Left" : "Right");
-#endif
+            if (hm.waitingBeginCast) ArmBeginCastWait(hand);
+            if (!(hm.AutoActive() || hm.wantAutoAttack) || _aa.Held(hand)) return;
+            IM_TRACE(State, "[State] NotifyAttackEnabled: starting {} auto attack", IsLeft(hand) ? "Left" : "Right");
             StartAutoAttack(hand);
-            if (hm.autoActive || (hm.holdActive && hm.wantAutoAttack)) {
+            if (hm.DrivesAutoAttack()) {
                 hm.waitingBeginCast = true;
-                hm.beginCastWaitSecs = 0.f;
+                ArmBeginCastWait(hand);
             }
         };
         tryStart(Left);
@@ -88,26 +84,20 @@ namespace IntegratedMagic {
 
     void MagicState::OnBeginCast(Slots::Hand hand) {
         auto& hm = ModeFor(hand);
-#ifdef DEBUG
-        spdlog::info("[State] OnBeginCast: hand={} waitingBeginCast={} retries={}", IsLeft(hand) ? "Left" : "Right",
-                     hm.waitingBeginCast, hm.beginCastRetries);
-#endif
+        IM_TRACE(State, "[State] OnBeginCast: hand={} waitingBeginCast={} retries={}", IsLeft(hand) ? "Left" : "Right",
+                 hm.waitingBeginCast, hm.beginCastRetries);
         if (!hm.waitingBeginCast) return;
 
         hm.waitingBeginCast = false;
-        hm.beginCastWaitSecs = 0.f;
         hm.beginCastRetries = 0;
         CancelDelayedStart(hand);
-#ifdef DEBUG
-        spdlog::info("[State] OnBeginCast: hand={} -> cast confirmed, begin cast wait cleared",
-                     IsLeft(hand) ? "Left" : "Right");
-#endif
+        IM_TRACE(State, "[State] OnBeginCast: hand={} -> cast confirmed, begin cast wait cleared",
+                 IsLeft(hand) ? "Left" : "Right");
         using enum Slots::Hand;
         const auto other = IsLeft(hand) ? Right : Left;
         auto& otherHm = ModeFor(other);
         if (otherHm.waitingBeginCast) {
             otherHm.waitingBeginCast = false;
-            otherHm.beginCastWaitSecs = 0.f;
             otherHm.beginCastRetries = 0;
             CancelDelayedStart(other);
         }
@@ -116,29 +106,18 @@ namespace IntegratedMagic {
     void MagicState::OnCastStop() {
         using enum Slots::Hand;
         if (!_session.active) {
-#ifdef DEBUG
-            spdlog::info("[State] OnCastStop: ignored - not active");
-#endif
+            IM_TRACE(State, "[State] OnCastStop: ignored - not active");
             return;
         }
-#ifdef DEBUG
-        spdlog::info(
-            "[State] OnCastStop: castStopsToSkip={} isDualCasting={} "
-            "left.autoActive={} left.chargeComplete={} left.finished={} "
-            "right.autoActive={} right.chargeComplete={} right.finished={} "
-            "left.holdFired={} right.holdFired={}",
-            _cast.castStopsToSkip, _session.isDualCasting, _left.autoActive, _left.chargeComplete, _left.finished,
-            _right.autoActive, _right.chargeComplete, _right.finished, _left.holdFiredAndWaitingCastStop,
-            _right.holdFiredAndWaitingCastStop);
-#endif
+        IM_TRACE(State, "[State] OnCastStop: castStopsToSkip={} isDualCasting={} left={} right={}",
+                 _cast.castStopsToSkip, _session.isDualCasting, HandMachine::PhaseName(_left.phase),
+                 HandMachine::PhaseName(_right.phase));
 
         if (_cast.castStopsToSkip > 0) {
             --_cast.castStopsToSkip;
             const bool isLastSkip = (_cast.castStopsToSkip == 0);
-#ifdef DEBUG
-            spdlog::info("[State] OnCastStop: SKIPPING cast stop (remaining={}), isLastSkip={}", _cast.castStopsToSkip,
-                         isLastSkip);
-#endif
+            IM_TRACE(State, "[State] OnCastStop: SKIPPING cast stop (remaining={}), isLastSkip={}",
+                     _cast.castStopsToSkip, isLastSkip);
 
             if (isLastSkip) {
                 if (const bool isTwoHanded =
@@ -152,17 +131,15 @@ namespace IntegratedMagic {
 
                 auto stopAndDelay = [&](Slots::Hand h) {
                     auto& hm = ModeFor(h);
-                    if ((hm.autoActive || (hm.holdActive && hm.wantAutoAttack)) && !hm.finished) {
+                    if (hm.DrivesAutoAttack()) {
                         CancelDelayedStart(h);
                         StopAutoAttack(h);
                         hm.waitingBeginCast = true;
-                        hm.beginCastWaitSecs = 0.f;
                         hm.beginCastRetries = 0;
+                        ArmBeginCastWait(h);
                         ScheduleDelayedStart(h);
-#ifdef DEBUG
-                        spdlog::info("[State] OnCastStop: scheduled delayed start for hand={}",
-                                     IsLeft(h) ? "Left" : "Right");
-#endif
+                        IM_TRACE(State, "[State] OnCastStop: scheduled delayed start for hand={}",
+                                 IsLeft(h) ? "Left" : "Right");
                     }
                 };
                 stopAndDelay(Left);
@@ -176,82 +153,48 @@ namespace IntegratedMagic {
                 --_session.dualCastSkipCastStops;
                 return;
             }
-            if (!_left.chargeComplete && !_right.chargeComplete) {
+            if (!_left.Charged() && !_right.Charged()) {
                 return;
             }
-            FinishHand(Left);
-            FinishHand(Right);
+            Dispatch(Left, HandEvent::Finish);
+            Dispatch(Right, HandEvent::Finish);
             _session.isDualCasting = false;
             TryFinalizeExit();
             return;
         }
 
-        if (_left.autoActive && !_left.finished && _left.chargeComplete) {
-            if (_left.pressAutocast) {
-                _left.autoActive = false;
-                _left.chargeComplete = false;
-                _left.waitingChargeComplete = false;
-                _left.pressAutocast = false;
-            } else {
-                FinishHand(Left);
-            }
-        }
-        if (_right.autoActive && !_right.finished && _right.chargeComplete) {
-            if (_right.pressAutocast) {
-                _right.autoActive = false;
-                _right.chargeComplete = false;
-                _right.waitingChargeComplete = false;
-                _right.pressAutocast = false;
-            } else {
-                FinishHand(Right);
-            }
-        }
-        if (_left.holdFiredAndWaitingCastStop && !_left.finished) FinishHand(Left);
-        if (_right.holdFiredAndWaitingCastStop && !_right.finished) FinishHand(Right);
+        Dispatch(Left, HandEvent::CastStop);
+        Dispatch(Right, HandEvent::CastStop);
         TryFinalizeExit();
     }
 
     void MagicState::OnCastInterrupt() {
         if (!_session.active) return;
-#ifdef DEBUG
-        spdlog::info("[State] OnCastInterrupt: firstInterrupt={} left.autoActive={} right.autoActive={}",
-                     _session.firstInterrupt, _left.autoActive, _right.autoActive);
-#endif
+        IM_TRACE(State, "[State] OnCastInterrupt: firstInterrupt={} left={} right={}", _session.firstInterrupt,
+                 HandMachine::PhaseName(_left.phase), HandMachine::PhaseName(_right.phase));
         if (_session.firstInterrupt == 0) {
             ++_session.firstInterrupt;
-#ifdef DEBUG
-            spdlog::info("[State] OnCastInterrupt: first interrupt - ignoring");
-#endif
+            IM_TRACE(State, "[State] OnCastInterrupt: first interrupt - ignoring");
             return;
         }
         if (_session.wasHandsDown && !_session.attackEnabled) {
             ++_session.firstInterrupt;
-#ifdef DEBUG
-            spdlog::info("[State] OnCastInterrupt: low hands interrupt - ignoring");
-#endif
+            IM_TRACE(State, "[State] OnCastInterrupt: low hands interrupt - ignoring");
             return;
         }
         ++_session.firstInterrupt;
         using enum Slots::Hand;
         bool anyFinished = false;
-        if (_left.autoActive && !_left.finished && !_left.waitingBeginCast) {
-            FinishHand(Left);
-            anyFinished = true;
-        }
-        if (_right.autoActive && !_right.finished && !_right.waitingBeginCast) {
-            FinishHand(Right);
-            anyFinished = true;
-        }
+        if (!_left.waitingBeginCast) anyFinished |= Dispatch(Left, HandEvent::Interrupt);
+        if (!_right.waitingBeginCast) anyFinished |= Dispatch(Right, HandEvent::Interrupt);
         if (anyFinished) _session.isDualCasting = false;
     }
 
     void MagicState::OnShoutStop() {
         if (!_session.active || _shout.modeShoutID == 0 || _shout.finished) return;
         if (_shout.isPower) return;
-#ifdef DEBUG
-        spdlog::info("[State] OnShoutStop: modeShoutID={:#010x} waitingStopEvent={}", _shout.modeShoutID,
-                     _shout.waitingStopEvent);
-#endif
+        IM_TRACE(State, "[State] OnShoutStop: modeShoutID={:#010x} waitingStopEvent={}", _shout.modeShoutID,
+                 _shout.waitingStopEvent);
 
         const auto ss = SpellSettingsDB::Get().GetOrCreate(_shout.modeShoutID);
         const bool isHold = (ss.mode == ActivationMode::Hold);
@@ -267,23 +210,23 @@ namespace IntegratedMagic {
 
     void MagicState::PumpAutomaticHand(Slots::Hand hand) {
         auto& hm = ModeFor(hand);
-        if (!hm.autoActive || !hm.waitingChargeComplete) return;
+        if (!hm.Charging()) return;
 
         auto* player = GetPlayer();
         if (!player || !_session.active || _session.activeSlot < 0) {
-            FinishHand(hand);
+            Dispatch(hand, HandEvent::Finish);
             return;
         }
 
         const auto id = Slots::GetSlotSpell(_session.activeSlot, hand);
         if (id == 0) {
-            FinishHand(hand);
+            Dispatch(hand, HandEvent::Finish);
             return;
         }
 
         const auto* spell = RE::TESForm::LookupByID<RE::SpellItem>(id);
         if (!spell) {
-            FinishHand(hand);
+            Dispatch(hand, HandEvent::Finish);
             return;
         }
 
@@ -291,69 +234,53 @@ namespace IntegratedMagic {
             IsLeft(hand) ? RE::MagicSystem::CastingSource::kLeftHand : RE::MagicSystem::CastingSource::kRightHand;
 
         if (auto const* caster = MagicAction::GetCaster(player, src); !IsChargeComplete(caster, spell)) return;
-#ifdef DEBUG
-        spdlog::info("[State] PumpAutomaticHand: hand={} CHARGE COMPLETE - stopping auto attack",
-                     IsLeft(hand) ? "Left" : "Right");
-#endif
-        hm.waitingChargeComplete = false;
-        hm.chargeComplete = true;
+        IM_TRACE(State, "[State] PumpAutomaticHand: hand={} CHARGE COMPLETE - stopping auto attack",
+                 IsLeft(hand) ? "Left" : "Right");
         StopAutoAttack(hand);
+        Dispatch(hand, HandEvent::ChargeComplete);
     }
 
     void MagicState::PumpAutoStartFallback(Slots::Hand hand, float dt) {
-        using enum ActivationMode;
         auto& hm = ModeFor(hand);
-        if (!_session.active) return;
-#ifdef DEBUG
-        const char* handStr = IsLeft(hand) ? "Left" : "Right";
-#endif
-        if (hm.waitingAutoAfterEquip) {
-            hm.waitingEnableBumperSecs += dt > 0.f ? dt : 0.f;
-
-            if (constexpr float kFallbackDelay = 0.25f; hm.waitingEnableBumperSecs >= kFallbackDelay) {
-#ifdef DEBUG
-                spdlog::info("[State] PumpAutoStartFallback: hand={} FALLBACK after {:.3f}s", handStr,
-                             hm.waitingEnableBumperSecs);
-#endif
-                hm.waitingAutoAfterEquip = false;
-                if (!_aa.Held(hand)) {
-                    StartAutoAttack(hand);
-                    hm.waitingBeginCast = true;
-                    hm.beginCastWaitSecs = 0.f;
-                }
+        if (!_session.active || !hm.waitingAutoAfterEquip) return;
+
+        hm.waitingEnableBumperSecs += dt > 0.f ? dt : 0.f;
+        if (constexpr float kFallbackDelay = 0.25f; hm.waitingEnableBumperSecs >= kFallbackDelay) {
+            IM_TRACE(State, "[State] PumpAutoStartFallback: hand={} FALLBACK after {:.3f}s",
+                     IsLeft(hand) ? "Left" : "Right", hm.waitingEnableBumperSecs);
+            hm.waitingAutoAfterEquip = false;
+            if (!_aa.Held(hand)) {
+                StartAutoAttack(hand);
+                hm.waitingBeginCast = true;
             }
-            return;
+            if (hm.waitingBeginCast) ArmBeginCastWait(hand);
         }
+    }
 
-        if (!hm.waitingBeginCast) return;
-        if (!_session.attackEnabled) {
-            hm.beginCastWaitSecs = 0.f;
-            return;
-        }
+    void MagicState::ArmBeginCastWait(Slots::Hand hand) {
+        Timers::Arm(Timers::Timer::BeginCastWait, static_cast<std::uint32_t>(hand), kBeginCastTimeoutSec);
+    }
+
+    void MagicState::OnBeginCastTimeout(Slots::Hand hand) {
+        auto& hm = ModeFor(hand);
+        if (!_session.active || !_session.attackEnabled || !hm.waitingBeginCast || hm.waitingAutoAfterEquip) return;
 
-        constexpr float kBeginCastTimeout = 0.1f;
         constexpr int kMaxRetries = 3;
-        hm.beginCastWaitSecs += dt > 0.f ? dt : 0.f;
-        if (hm.beginCastWaitSecs < kBeginCastTimeout) return;
-        hm.beginCastWaitSecs = 0.f;
-
-        const bool hasLimit = (hm.mode == Automatic);
-#ifdef DEBUG
-        spdlog::info("[State] PumpAutoStartFallback: hand={} BeginCast timeout! retry={}/{} hasLimit={}", handStr,
-                     hm.beginCastRetries, kMaxRetries, hasLimit);
-#endif
+        const bool hasLimit = (hm.mode == ActivationMode::Automatic);
+        const char* handStr = IsLeft(hand) ? "Left" : "Right";
+        IM_TRACE(State, "[State] OnBeginCastTimeout: hand={} BeginCast timeout! retry={}/{} hasLimit={}", handStr,
+                 hm.beginCastRetries, kMaxRetries, hasLimit);
         if (!hasLimit || hm.beginCastRetries < kMaxRetries) {
             ++hm.beginCastRetries;
             if (!DelayFor(hand).pending) {
                 StopAutoAttack(hand);
                 ScheduleDelayedStart(hand);
             }
+            ArmBeginCastWait(hand);
         } else {
-#ifdef DEBUG
-            spdlog::info("[State] PumpAutoStartFallback: hand={} MAX RETRIES -> FinishHand", handStr);
-#endif
+            IM_TRACE(State, "[State] OnBeginCastTimeout: hand={} MAX RETRIES -> Timeout", handStr);
             hm.waitingBeginCast = false;
-            FinishHand(hand);
+            Dispatch(hand, HandEvent::Timeout);
         }
     }
 
@@ -372,19 +299,13 @@ namespace IntegratedMagic {
             d.secs = 0.f;
 
             auto& hm = ModeFor(h);
-#ifdef DEBUG
-            spdlog::info(
-                "[State] PumpDelayedStarts: hand={} delay elapsed! autoActive={} holdActive={} "
-                "wantAutoAttack={} finished={}",
-                IsLeft(h) ? "Left" : "Right", hm.autoActive, hm.holdActive, hm.wantAutoAttack, hm.finished);
-#endif
-            if ((hm.autoActive || (hm.holdActive && hm.wantAutoAttack)) && !hm.finished) {
-#ifdef DEBUG
-                spdlog::info("[State] PumpDelayedStarts: hand={} -> StartAutoAttack", IsLeft(h) ? "Left" : "Right");
-#endif
+            IM_TRACE(State, "[State] PumpDelayedStarts: hand={} delay elapsed! phase={} wantAutoAttack={}",
+                     IsLeft(h) ? "Left" : "Right", HandMachine::PhaseName(hm.phase), hm.wantAutoAttack);
+            if (hm.DrivesAutoAttack()) {
+                IM_TRACE(State, "[State] PumpDelayedStarts: hand={} -> StartAutoAttack", IsLeft(h) ? "Left" : "Right");
                 StartAutoAttack(h);
                 hm.waitingBeginCast = true;
-                hm.beginCastWaitSecs = 0.f;
+                ArmBeginCastWait(h);
             }
         };
 
@@ -394,40 +315,18 @@ namespace IntegratedMagic {
     }
 
     void MagicState::PumpAutomatic(float dt) {
-        if (_restore.pendingPowerRestore) {
-            if (_restore.pendingPowerRestoreDelaySecs > 0.f) {
-                _restore.pendingPowerRestoreDelaySecs -= dt > 0.f ? dt : 0.f;
-                return;
-            }
-#ifdef DEBUG
-            spdlog::info("[State] PumpAutomatic: pendingPowerRestore -> RestoreSnapshot");
-#endif
-            _restore.pendingPowerRestore = false;
-            _restore.pendingPowerRestoreDelaySecs = 0.f;
-            if (auto* player = GetPlayer()) {
-                RestoreSnapshot(player);
-                if (auto* mgr = RE::ActorEquipManager::GetSingleton()) {
-                    auto idx = BuildInventoryIndex(player);
-                    ReequipPrevExtraEquipped(player, mgr, idx, _restore.prevExtraEquipped);
-                }
-            }
-            _restore.snapshot = {};
-            return;
-        }
+        RefreshResolvedSlots();
+        if (_restore.pendingPowerRestore) return;
 
         if (_restore.pendingRestoreAfterSheathe) {
             if (auto* player = GetPlayer()) {
-                _restore.sheatheWaitSecs += dt > 0.f ? dt : 0.f;
-                const bool timedOut = _restore.sheatheWaitSecs >= RestoreContext::kSheatheWaitTimeoutSec;
                 const bool giveUp = player->IsInCombat() ||
                                     player->AsActorState()->GetWeaponState() == RE::WEAPON_STATE::kWantToDraw ||
-                                    timedOut;
+                                    _restore.sheatheWaitTimedOut;
                 ;
                 if (_restore.sheatheAnimComplete || giveUp) {
-                    _restore.sheatheWaitSecs = 0.f;
-#ifdef DEBUG
-                    spdlog::info("[State] PumpAutomatic: pendingRestoreAfterSheathe -> restore (giveUp={})", giveUp);
-#endif
+                    _restore.sheatheWaitTimedOut = false;
+                    IM_TRACE(State, "[State] PumpAutomatic: pendingRestoreAfterSheathe -> restore (giveUp={})", giveUp);
                     _restore.pendingRestoreAfterSheathe = false;
                     _restore.sheatheAnimComplete = false;
                     RestoreSnapshot(player);
@@ -443,9 +342,7 @@ namespace IntegratedMagic {
         }
 
         if (_restore.pendingRestore) {
-#ifdef DEBUG
-            spdlog::info("[State] PumpAutomatic: pendingRestore -> RestoreSnapshot + deactivate");
-#endif
+            IM_TRACE(State, "[State] PumpAutomatic: pendingRestore -> RestoreSnapshot + deactivate");
             _restore.pendingRestore = false;
             if (auto* player = GetPlayer()) {
                 StopShoutPress();
@@ -466,23 +363,11 @@ namespace IntegratedMagic {
         PumpAutoStartFallback(Right, dt);
         PumpAutomaticHand(Left);
         PumpAutomaticHand(Right);
-        PumpSpellFireFinalize(dt);
 
         if (!_session.active) return;
 
         if (ShouldForceInterrupt()) {
-#ifdef DEBUG
-            spdlog::info("[State] PumpAutomatic: ShouldForceInterrupt -> ForceExit");
-#endif
-            ForceExit();
-            return;
-        }
-
-        _session.activeTimeoutSecs += dt > 0.f ? dt : 0.f;
-        if (_session.activeTimeoutSecs > kMaxActiveTimeoutSecs) {
-#ifdef DEBUG
-            spdlog::info("[State] PumpAutomatic: TIMEOUT -> ForceExit");
-#endif
+            IM_TRACE(State, "[State] PumpAutomatic: ShouldForceInterrupt -> ForceExit");
             ForceExit();
             return;
         }
@@ -491,14 +376,10 @@ namespace IntegratedMagic {
             (SpellSettingsDB::Get().GetOrCreate(_shout.modeShoutID).mode == ActivationMode::Automatic)) {
             constexpr float kPowerAutoDuration = 0.2f;
             _shout.powerAutoSecs += dt > 0.f ? dt : 0.f;
-#ifdef DEBUG
-            spdlog::info("[State] PumpAutomatic: power auto secs={:.3f}/{:.3f}", _shout.powerAutoSecs,
-                         kPowerAutoDuration);
-#endif
+            IM_TRACE(State, "[State] PumpAutomatic: power auto secs={:.3f}/{:.3f}", _shout.powerAutoSecs,
+                     kPowerAutoDuration);
             if (_shout.powerAutoSecs >= kPowerAutoDuration) {
-#ifdef DEBUG
-                spdlog::info("[State] PumpAutomatic: power auto duration elapsed -> StopShoutPress + finish");
-#endif
+                IM_TRACE(State, "[State] PumpAutomatic: power auto duration elapsed -> StopShoutPress + finish");
                 StopShoutPress();
                 _shout.finished = true;
                 TryFinalizeExit();
@@ -511,61 +392,69 @@ namespace IntegratedMagic {
 
         auto& hm = ModeFor(hand);
 
-        if (hm.autoActive && !hm.finished && hm.chargeComplete) {
-            if (hm.pressAutocast) {
-                hm.autoActive = false;
-                hm.chargeComplete = false;
-                hm.waitingChargeComplete = false;
-                hm.pressAutocast = false;
-                return;
-            }
+        if (!hm.Charged()) return;
+        if (hm.phase == HandPhase::PressCharged) {
+            Dispatch(hand, HandEvent::SpellFire);
+            return;
+        }
 
-            if (_session.isDualCasting) {
-                FinishHand(Slots::Hand::Left);
-                FinishHand(Slots::Hand::Right);
-                _session.isDualCasting = false;
+        if (_session.isDualCasting) {
+            Dispatch(Slots::Hand::Left, HandEvent::Finish);
+            Dispatch(Slots::Hand::Right, HandEvent::Finish);
+            _session.isDualCasting = false;
 
-                ScheduleSpellFireFinalize(Slots::Hand::Left);
-                ScheduleSpellFireFinalize(Slots::Hand::Right);
-            } else {
-                FinishHand(hand);
-                ScheduleSpellFireFinalize(hand);
-            }
+            ScheduleSpellFireFinalize(Slots::Hand::Left);
+            ScheduleSpellFireFinalize(Slots::Hand::Right);
+        } else {
+            Dispatch(hand, HandEvent::SpellFire);
+            ScheduleSpellFireFinalize(hand);
         }
     }
 
     void MagicState::ScheduleSpellFireFinalize(Slots::Hand hand) {
+        ModeFor(hand).waitingSpellFireFinalize = true;
+        Timers::Arm(Timers::Timer::SpellFireFinalize, static_cast<std::uint32_t>(hand), kSpellFireFinalizeDelaySec);
+    }
+
+    void MagicState::OnSpellFireFinalizeDue(Slots::Hand hand) {
         auto& hm = ModeFor(hand);
-        hm.waitingSpellFireFinalize = true;
-        hm.spellFireFinalizeSecs = 0.f;
+        if (!hm.waitingSpellFireFinalize) return;
+        hm.waitingSpellFireFinalize = false;
+        if (_session.active) TryFinalizeExit();
     }
 
-    void MagicState::PumpSpellFireFinalize(float dt) {
-        if (!_session.active) {
-            _left.waitingSpellFireFinalize = false;
-            _left.spellFireFinalizeSecs = 0.f;
-            _right.waitingSpellFireFinalize = false;
-            _right.spellFireFinalizeSecs = 0.f;
-            return;
+    void MagicState::OnPowerRestoreDue() {
+        if (!_restore.pendingPowerRestore) return;
+        IM_TRACE(State, "[State] OnPowerRestoreDue: pendingPowerRestore -> RestoreSnapshot");
+        _restore.pendingPowerRestore = false;
+        if (auto* player = GetPlayer()) {
+            RestoreSnapshot(player);
+            if (auto* mgr = RE::ActorEquipManager::GetSingleton()) {
+                auto idx = BuildInventoryIndex(player);
+                ReequipPrevExtraEquipped(player, mgr, idx, _restore.prevExtraEquipped);
+            }
         }
+        _restore.snapshot = {};
+    }
 
-        constexpr float kSpellFireFinalizeDelay = 0.7f;
-
-        auto pumpOne = [&](Slots::Hand hand) {
-            auto& hm = ModeFor(hand);
-            if (!hm.waitingSpellFireFinalize) return;
-
-            hm.spellFireFinalizeSecs += dt > 0.f ? dt : 0.f;
-            if (hm.spellFireFinalizeSecs < kSpellFireFinalizeDelay) return;
-
-            hm.waitingSpellFireFinalize = false;
-            hm.spellFireFinalizeSecs = 0.f;
-
-            TryFinalizeExit();
-        };
+    void MagicState::OnActiveTimeout() {
+        if (!_session.active) return;
+        FlightRecorder::Record(FlightRecorder::Event::ActiveTimeout, _session.activeSlot, FlightRecorder::kNoHand, 0,
+                               static_cast<std::uint32_t>(kMaxActiveTimeoutSecs));
+        IM_TRACE(State, "[State] OnActiveTimeout: TIMEOUT -> ForceExit");
+        ForceExit();
+    }
 
-        using enum Slots::Hand;
-        pumpOne(Left);
-        pumpOne(Right);
+    void MagicState::RegisterTimers() {
+        using Timers::Timer;
+        Timers::SetHandler(Timer::BeginCastWait,
+                           [](std::uint32_t i) { Get().OnBeginCastTimeout(static_cast<Slots::Hand>(i)); });
+        Timers::SetHandler(Timer::SpellFireFinalize,
+                           [](std::uint32_t i) { Get().OnSpellFireFinalizeDue(static_cast<Slots::Hand>(i)); });
+        Timers::SetHandler(Timer::PowerRestoreDelay, [](std::uint32_t) { Get().OnPowerRestoreDue(); });
+        Timers::SetHandler(Timer::SheatheWait, [](std::uint32_t) {
+            if (auto& st = Get(); st._restore.pendingRestoreAfterSheathe) st._restore.sheatheWaitTimedOut = true;
+        });
+        Timers::SetHandler(Timer::ActiveTimeout, [](std::uint32_t) { Get().OnActiveTimeout(); });
     }
-}
\ No newline at end of file
+}
@@ -3,6 +3,9 @@
 #include "Action.h"
 #include "Config/Config.h"
 #include "Config/Slots.h"
+#include "Diagnostics/FlightRecorder.h"
+#include "Diagnostics/Latency.h"
+#include "Diagnostics/Trace.h"
 #include "InventoryUtil.h"
 #include "PCH.h"
 #include "Persistence/SpellSettingsDB.h"
@@ -19,40 +22,39 @@ namespace IntegratedMagic {
     }
 
     void MagicState::DisableHand(Slots::Hand hand) {
-#ifdef DEBUG
-        spdlog::info("[State] DisableHand: hand={}", IsLeft(hand) ? "Left" : "Right");
-#endif
+        IM_TRACE(State, "[State] DisableHand: hand={}", IsLeft(hand) ? "Left" : "Right");
         StopAutoAttack(hand);
         ModeFor(hand) = {};
-        ModeFor(hand).finished = true;
+        ModeFor(hand).phase = HandPhase::Finished;
         SetModeSpellsFromHand(hand, nullptr);
     }
 
     void MagicState::FinishHand(Slots::Hand hand) {
-#ifdef DEBUG
-        spdlog::info("[State] FinishHand: hand={}", IsLeft(hand) ? "Left" : "Right");
-#endif
+        IM_TRACE(State, "[State] FinishHand: hand={}", IsLeft(hand) ? "Left" : "Right");
         auto& hm = ModeFor(hand);
-        hm.finished = true;
-        hm.holdActive = false;
-        hm.autoActive = false;
-        hm.pressActive = false;
+        hm.phase = HandPhase::Finished;
         hm.waitingAutoAfterEquip = false;
-        hm.waitingChargeComplete = false;
-        hm.holdFiredAndWaitingCastStop = false;
         hm.waitingBeginCast = false;
-        hm.beginCastWaitSecs = 0.f;
         hm.beginCastRetries = 0;
         StopAutoAttack(hand);
         CancelDelayedStart(hand);
     }
 
-    void MagicState::TogglePressHand(Slots::Hand hand, const SpellSettings& ss) {
+    bool MagicState::Dispatch(Slots::Hand hand, HandEvent ev) {
         auto& hm = ModeFor(hand);
-        hm.mode = ss.mode;
-        hm.wantAutoAttack = ss.autoAttack;
-        hm.pressActive = !hm.pressActive;
-        if (!hm.pressActive) FinishHand(hand);
+        const auto next = HandMachine::Next(hm.phase, ev);
+        if (next == hm.phase) return false;
+        FlightRecorder::Record(FlightRecorder::Event::HandPhase, _session.activeSlot, std::to_underlying(hand),
+                               std::to_underlying(hm.phase),
+                               (static_cast<std::uint32_t>(std::to_underlying(ev)) << 8) | std::to_underlying(next));
+        IM_TRACE(State, "[State] Dispatch: hand={} event={} {} -> {}", IsLeft(hand) ? "Left" : "Right",
+                 HandMachine::EventName(ev), HandMachine::PhaseName(hm.phase), HandMachine::PhaseName(next));
+        if (next == HandPhase::Finished) {
+            FinishHand(hand);
+        } else {
+            hm.phase = next;
+        }
+        return true;
     }
 
     void MagicState::EnterHand(Slots::Hand hand, const SpellSettings& ss) {
@@ -61,18 +63,15 @@ namespace IntegratedMagic {
         hm = {};
         hm.mode = ss.mode;
         hm.wantAutoAttack = ss.autoAttack;
-#ifdef DEBUG
         const char* handStr = IsLeft(hand) ? "Left" : "Right";
-#endif
         const auto& cfg = IntegratedMagic::GetMagicConfig();
         switch (ss.mode) {
             case Hold:
-                hm.holdActive = true;
+                hm.phase = HandPhase::Hold;
                 if (hm.wantAutoAttack) {
                     hm.waitingAutoAfterEquip = true;
                     hm.waitingEnableBumperSecs = 0.f;
                     hm.waitingBeginCast = true;
-                    hm.beginCastWaitSecs = 0.f;
                     hm.beginCastRetries = 0;
                     _session.attackEnabled = false;
                     if (cfg.skipEquipAnimationPatch) {
@@ -81,21 +80,17 @@ namespace IntegratedMagic {
                         _cast.castStopsToSkip = 0;
                     }
                 }
-#ifdef DEBUG
-                spdlog::info(
-                    "[State] EnterHand: hand={} mode=Hold wantAutoAttack={} "
-                    "waitingAutoAfterEquip={} castStopsToSkip={}",
-                    handStr, hm.wantAutoAttack, hm.waitingAutoAfterEquip, _cast.castStopsToSkip);
-#endif
+                IM_TRACE(State,
+                         "[State] EnterHand: hand={} mode=Hold wantAutoAttack={} "
+                         "waitingAutoAfterEquip={} castStopsToSkip={}",
+                         handStr, hm.wantAutoAttack, hm.waitingAutoAfterEquip, _cast.castStopsToSkip);
                 break;
             case Automatic:
-                hm.autoActive = true;
-                hm.waitingChargeComplete = true;
+                hm.phase = HandPhase::AutoCharging;
                 hm.waitingAutoAfterEquip = true;
                 hm.wantAutoAttack = true;
                 hm.waitingEnableBumperSecs = 0.f;
                 hm.waitingBeginCast = true;
-                hm.beginCastWaitSecs = 0.f;
                 hm.beginCastRetries = 0;
                 _session.attackEnabled = false;
                 if (cfg.skipEquipAnimationPatch) {
@@ -103,23 +98,17 @@ namespace IntegratedMagic {
                 } else {
                     _cast.castStopsToSkip = 0;
                 }
-#ifdef DEBUG
-                spdlog::info(
-                    "[State] EnterHand: hand={} mode=Automatic waitingChargeComplete=true "
-                    "waitingAutoAfterEquip=true castStopsToSkip={}",
-                    handStr, _cast.castStopsToSkip);
-#endif
+                IM_TRACE(State,
+                         "[State] EnterHand: hand={} mode=Automatic waitingAutoAfterEquip=true castStopsToSkip={}",
+                         handStr, _cast.castStopsToSkip);
                 break;
             case Press:
-                hm.pressActive = true;
+                hm.phase = HandPhase::Press;
                 if (hm.wantAutoAttack) {
-                    hm.autoActive = true;
-                    hm.pressAutocast = true;
-                    hm.waitingChargeComplete = true;
+                    hm.phase = HandPhase::PressCharging;
                     hm.waitingAutoAfterEquip = true;
                     hm.waitingEnableBumperSecs = 0.f;
                     hm.waitingBeginCast = true;
-                    hm.beginCastWaitSecs = 0.f;
                     hm.beginCastRetries = 0;
                     _session.attackEnabled = false;
                     if (cfg.skipEquipAnimationPatch) {
@@ -128,13 +117,51 @@ namespace IntegratedMagic {
                         _cast.castStopsToSkip = 0;
                     }
                 }
-#ifdef DEBUG
-                spdlog::info(
-                    "[State] EnterHand: hand={} mode=Press wantAutoAttack={} pressAutocast={} castStopsToSkip={}",
-                    handStr, hm.wantAutoAttack, hm.pressAutocast, _cast.castStopsToSkip);
-#endif
+                IM_TRACE(State, "[State] EnterHand: hand={} mode=Press wantAutoAttack={} phase={} castStopsToSkip={}",
+                         handStr, hm.wantAutoAttack, HandMachine::PhaseName(hm.phase), _cast.castStopsToSkip);
                 break;
         }
+        FlightRecorder::Record(FlightRecorder::Event::EnterHand, _session.activeSlot, std::to_underlying(hand),
+                               static_cast<std::uint8_t>(std::to_underlying(ss.mode)), std::to_underlying(hm.phase));
+    }
+
+    void MagicState::RefreshResolvedSlots() {
+        const auto& cfg = GetMagicConfig();
+        auto& db = SpellSettingsDB::Get();
+        const auto slotVersion = cfg.SlotVersion();
+        const auto dbVersion = db.Version();
+        if (_resolvedValid && slotVersion == _resolvedSlotVersion && dbVersion == _resolvedDbVersion) return;
+        _resolvedSlotVersion = slotVersion;
+        _resolvedDbVersion = dbVersion;
+        _resolvedValid = true;
+
+        using enum Slots::Hand;
+        const auto n = cfg.SlotCount();
+        for (std::uint32_t i = 0; i < MagicConfig::kMaxSlots; ++i) {
+            auto& r = _resolved[i];
+            r = {};
+            if (i >= n) continue;
+            const auto slot = static_cast<int>(i);
+
+            r.shoutID = Slots::GetSlotShout(slot);
+            if (r.shoutID != 0u) {
+                r.shoutForm = RE::TESForm::LookupByID(r.shoutID);
+                if (!r.shoutForm) continue;
+                r.shoutSettings = db.GetOrCreate(r.shoutID, r.shoutForm);
+                r.shoutIsPower = (r.shoutForm->As<RE::SpellItem>() != nullptr);
+                continue;
+            }
+
+            r.rightID = Slots::GetSlotSpell(slot, Right);
+            r.leftID = Slots::GetSlotSpell(slot, Left);
+            r.rightSpell = r.rightID ? RE::TESForm::LookupByID<RE::SpellItem>(r.rightID) : nullptr;
+            r.leftSpell = r.leftID ? RE::TESForm::LookupByID<RE::SpellItem>(r.leftID) : nullptr;
+            if (r.rightSpell) r.rightSettings = db.GetOrCreate(r.rightID, r.rightSpell);
+            if (r.leftSpell) r.leftSettings = db.GetOrCreate(r.leftID, r.leftSpell);
+            r.leftTwoHanded = SpellClassify::IsTwoHandedSpell(r.leftSpell);
+        }
+        IM_TRACE(State, "[State] RefreshResolvedSlots: slots={} slotVersion={} dbVersion={}", n, slotVersion,
+                 dbVersion);
     }
 
     bool MagicState::PrepareSlotEntry(int slot, SlotEntry& out) {
@@ -142,43 +169,42 @@ namespace IntegratedMagic {
         auto* player = GetPlayer();
         if (!player || !Slots::IsValidSlot(slot)) return false;
         out.player = player;
+        RefreshResolvedSlots();
+        const auto& r = _resolved[static_cast<std::size_t>(slot)];
 
         if (Slots::IsShoutSlot(slot)) {
             out.isShout = true;
-            out.shoutID = Slots::GetSlotShout(slot);
-            out.shoutForm = out.shoutID ? RE::TESForm::LookupByID(out.shoutID) : nullptr;
+            out.shoutID = r.shoutID;
+            out.shoutForm = r.shoutForm;
             if (!out.shoutForm) return false;
-            out.shoutSettings = SpellSettingsDB::Get().GetOrCreate(out.shoutID, out.shoutForm);
+            out.shoutSettings = r.shoutSettings;
 
             EnsureActiveWithSnapshot(player, slot, false);
             _shout.modeShoutID = out.shoutID;
             _shout.finished = false;
-            _shout.isPower = (out.shoutForm->As<RE::SpellItem>() != nullptr);
+            _shout.isPower = r.shoutIsPower;
             _shout.powerAutoSecs = 0.f;
             _left = {};
-            _left.finished = true;
+            _left.phase = HandPhase::Finished;
             _right = {};
-            _right.finished = true;
+            _right.phase = HandPhase::Finished;
             _session.modeSpellLeft = nullptr;
             _session.modeSpellRight = nullptr;
-#ifdef DEBUG
-            spdlog::info("[State] PrepareSlotEntry: shout slot={} shoutID={:#010x} isPower={} mode={}", slot,
-                         out.shoutID, _shout.isPower, static_cast<int>(std::to_underlying(out.shoutSettings.mode)));
-#endif
+            IM_TRACE(State, "[State] PrepareSlotEntry: shout slot={} shoutID={:#010x} isPower={} mode={}", slot,
+                     out.shoutID, _shout.isPower, static_cast<int>(std::to_underlying(out.shoutSettings.mode)));
             return true;
         }
 
-        using enum Slots::Hand;
-        out.rightID = Slots::GetSlotSpell(slot, Right);
-        out.leftID = Slots::GetSlotSpell(slot, Left);
-        out.rightSpell = out.rightID ? RE::TESForm::LookupByID<RE::SpellItem>(out.rightID) : nullptr;
-        out.leftSpell = out.leftID ? RE::TESForm::LookupByID<RE::SpellItem>(out.leftID) : nullptr;
+        out.rightID = r.rightID;
+        out.leftID = r.leftID;
+        out.rightSpell = r.rightSpell;
+        out.leftSpell = r.leftSpell;
         out.hasRight = (out.rightSpell != nullptr);
         out.hasLeft = (out.leftSpell != nullptr);
         if (!out.hasRight && !out.hasLeft) return false;
-
-        if (out.hasRight) out.rightSettings = SpellSettingsDB::Get().GetOrCreate(out.rightID, out.rightSpell);
-        if (out.hasLeft) out.leftSettings = SpellSettingsDB::Get().GetOrCreate(out.leftID, out.leftSpell);
+        out.rightSettings = r.rightSettings;
+        out.leftSettings = r.leftSettings;
+        out.leftTwoHanded = r.leftTwoHanded;
 
         EnsureActiveWithSnapshot(player, slot);
         _session.modeSpellRight = out.rightSpell;
@@ -200,19 +226,15 @@ namespace IntegratedMagic {
     }
 
     void MagicState::StartShoutPress() {
-#ifdef DEBUG
-        spdlog::info("[State] StartShoutPress: held={} modeShoutID={:#010x}", _shout.held, _shout.modeShoutID);
-#endif
+        IM_TRACE(State, "[State] StartShoutPress: held={} modeShoutID={:#010x}", _shout.held, _shout.modeShoutID);
         _shout.held = true;
         _shout.heldSecs = 0.f;
         detail::DispatchShout(1.0f, 0.0f);
     }
 
     void MagicState::StopShoutPress() {
-#ifdef DEBUG
-        spdlog::info("[State] StopShoutPress: held={} heldSecs={:.3f} modeShoutID={:#010x}", _shout.held,
-                     _shout.heldSecs, _shout.modeShoutID);
-#endif
+        IM_TRACE(State, "[State] StopShoutPress: held={} heldSecs={:.3f} modeShoutID={:#010x}", _shout.held,
+                 _shout.heldSecs, _shout.modeShoutID);
         if (!_shout.held) return;
         const float held = (_shout.heldSecs > 0.f) ? _shout.heldSecs : 0.1f;
         detail::DispatchShout(0.0f, held);
@@ -220,21 +242,82 @@ namespace IntegratedMagic {
         _shout.heldSecs = 0.f;
     }
 
+    void MagicState::PreEquipSlot(int slot) {
+        if (_session.active || _preEquip.Active()) return;
+        if (_restore.pendingRestore || _restore.pendingRestoreAfterSheathe || _restore.pendingPowerRestore) return;
+        if (!Slots::IsValidSlot(slot) || Slots::IsShoutSlot(slot)) return;
+        auto* player = GetPlayer();
+        if (!player) return;
+
+        using enum Slots::Hand;
+        RefreshResolvedSlots();
+        const auto& r = _resolved[static_cast<std::size_t>(slot)];
+        auto* rightSpell = r.rightSpell;
+        auto* leftSpell = r.leftSpell;
+        const bool leftTwoHanded = r.leftTwoHanded;
+        if (rightSpell && !HasEnoughMagickaForSpell(player, rightSpell)) rightSpell = nullptr;
+        if (leftSpell && !HasEnoughMagickaForSpell(player, leftSpell)) leftSpell = nullptr;
+        if (!rightSpell && !leftSpell) return;
+
+        IM_TRACE(State, "[State] PreEquipSlot: slot={} right={:#010x} left={:#010x}", slot,
+                 rightSpell ? rightSpell->GetFormID() : 0u, leftSpell ? leftSpell->GetFormID() : 0u);
+        CaptureSnapshot(player);
+        _restore.prevExtraEquipped.clear();
+        _preEquip.slot = slot;
+        _preEquip.rightSpell = rightSpell;
+        _preEquip.leftSpell = leftSpell;
+
+        _inSlotSetup = true;
+        UpdatePrevExtraEquippedForOverlay([this, player, rightSpell, leftSpell, leftTwoHanded] {
+            if (rightSpell) {
+                MagicAction::EquipSpellInHand(player, rightSpell, Right);
+                MarkDirty(Right);
+            }
+            if (leftSpell) {
+                MagicAction::EquipSpellInHand(player, leftSpell, Left);
+                MarkDirty(Left);
+                if (!rightSpell && leftTwoHanded) MarkDirty(Right);
+            }
+        });
+        _inSlotSetup = false;
+        _session.modeSpellRight = rightSpell;
+        _session.modeSpellLeft = leftSpell;
+    }
+
+    void MagicState::CancelPreEquip() {
+        if (!_preEquip.Active()) return;
+        IM_TRACE(State, "[State] CancelPreEquip: slot={} -> RestoreSnapshot", _preEquip.slot);
+        _preEquip.Reset();
+        if (auto* player = GetPlayer()) {
+            RestoreSnapshot(player);
+        } else {
+            _restore.snapshot.valid = false;
+            _restore.ClearDirty();
+        }
+        _restore.prevExtraEquipped.clear();
+        _session.modeSpellLeft = nullptr;
+        _session.modeSpellRight = nullptr;
+    }
+
     void MagicState::OnSlotPressed(int slot) {
-#ifdef DEBUG
-        spdlog::info("[State] OnSlotPressed: slot={} active={} activeSlot={} modeShoutID={:#010x}", slot,
-                     _session.active, _session.activeSlot, _shout.modeShoutID);
-#endif
+        FlightRecorder::Record(FlightRecorder::Event::SlotPressed, slot);
+        IM_TRACE(State, "[State] OnSlotPressed: slot={} active={} activeSlot={} modeShoutID={:#010x}", slot,
+                 _session.active, _session.activeSlot, _shout.modeShoutID);
         using enum Slots::Hand;
         using enum ActivationMode;
 
+        if (_preEquip.Active() && _preEquip.slot != slot) CancelPreEquip();
+
         if (Slots::IsShoutSlot(slot)) {
             if (_session.active && slot == _session.activeSlot && _shout.modeShoutID != 0) {
                 if (_shout.finished) return;
-                if (SpellSettingsDB::Get().GetOrCreate(_shout.modeShoutID).mode == Press) {
-#ifdef DEBUG
-                    spdlog::info("[State] OnSlotPressed: shout Press toggle -> StopShoutPress + finish");
-#endif
+                RefreshResolvedSlots();
+                const auto& r = _resolved[static_cast<std::size_t>(slot)];
+                const auto mode = (r.shoutID == _shout.modeShoutID)
+                                      ? r.shoutSettings.mode
+                                      : SpellSettingsDB::Get().GetOrCreate(_shout.modeShoutID).mode;
+                if (mode == Press) {
+                    IM_TRACE(State, "[State] OnSlotPressed: shout Press toggle -> StopShoutPress + finish");
                     StopShoutPress();
                     _shout.finished = true;
                     TryFinalizeExit();
@@ -250,23 +333,18 @@ namespace IntegratedMagic {
             if (!PrepareSlotEntry(slot, e)) return;
             if ((e.shoutSettings.mode == Hold || e.shoutSettings.mode == Automatic) && !_shout.isPower &&
                 e.player->GetVoiceRecoveryTime() > 0.f) {
-#ifdef DEBUG
-                spdlog::info("[State] OnSlotPressed: shout on cooldown -> early exit");
-#endif
+                IM_TRACE(State, "[State] OnSlotPressed: shout on cooldown -> early exit");
                 _shout.finished = true;
                 TryFinalizeExit();
                 return;
             }
-#ifdef DEBUG
-            spdlog::info("[State] OnSlotPressed: EquipShoutInVoice shoutID={:#010x} isPower={} mode={}", e.shoutID,
-                         _shout.isPower, static_cast<int>(std::to_underlying(e.shoutSettings.mode)));
-#endif
+            IM_TRACE(State, "[State] OnSlotPressed: EquipShoutInVoice shoutID={:#010x} isPower={} mode={}", e.shoutID,
+                     _shout.isPower, static_cast<int>(std::to_underlying(e.shoutSettings.mode)));
             MagicAction::EquipShoutInVoice(e.player, e.shoutForm);
             _restore.dirtyShout = true;
-#ifdef DEBUG
-            spdlog::info("[State] OnSlotPressed: calling StartShoutPress (mode={})",
-                         static_cast<int>(std::to_underlying(e.shoutSettings.mode)));
-#endif
+            Latency::Mark(Latency::Stage::Equipped);
+            IM_TRACE(State, "[State] OnSlotPressed: calling StartShoutPress (mode={})",
+                     static_cast<int>(std::to_underlying(e.shoutSettings.mode)));
             StartShoutPress();
             if (e.shoutSettings.mode == Automatic) _shout.powerAutoSecs = 0.f;
             return;
@@ -275,17 +353,15 @@ namespace IntegratedMagic {
         if (_session.active && slot == _session.activeSlot) {
             const bool needL = (_session.modeSpellLeft != nullptr);
             const bool needR = (_session.modeSpellRight != nullptr);
-            const bool pressL = needL && _left.mode == Press && _left.pressActive;
-            const bool pressR = needR && _right.mode == Press && _right.pressActive;
+            const bool pressL = needL && _left.mode == Press && _left.PressActive();
+            const bool pressR = needR && _right.mode == Press && _right.PressActive();
             if (!pressL && !pressR) return;
+            if (pressL) Dispatch(Left, HandEvent::Pressed);
+            if (pressR) Dispatch(Right, HandEvent::Pressed);
             if (pressL && pressR) {
-                FinishHand(Left);
-                FinishHand(Right);
                 ExitAllNow();
                 return;
             }
-            if (pressL) FinishHand(Left);
-            if (pressR) FinishHand(Right);
             TryFinalizeExit();
             return;
         }
@@ -298,6 +374,7 @@ namespace IntegratedMagic {
 
         SlotEntry e{};
         if (!PrepareSlotEntry(slot, e)) return;
+        const auto pre = std::exchange(_preEquip, PreEquipState{});
 
         if (e.hasRight && !HasEnoughMagickaForSpell(e.player, e.rightSpell)) {
             e.hasRight = false;
@@ -352,20 +429,21 @@ namespace IntegratedMagic {
 
         auto* player = e.player;
         _inSlotSetup = true;
-        UpdatePrevExtraEquippedForOverlay([this, player, &e] {
+        UpdatePrevExtraEquippedForOverlay([this, player, &e, &pre] {
             if (e.hasRight) {
-                MagicAction::EquipSpellInHand(player, e.rightSpell, Right);
+                if (pre.rightSpell != e.rightSpell) MagicAction::EquipSpellInHand(player, e.rightSpell, Right);
                 MarkDirty(Right);
             }
             if (e.hasLeft) {
-                MagicAction::EquipSpellInHand(player, e.leftSpell, Left);
+                if (pre.leftSpell != e.leftSpell) MagicAction::EquipSpellInHand(player, e.leftSpell, Left);
                 MarkDirty(Left);
-                if (!e.hasRight && SpellClassify::IsTwoHandedSpell(e.leftSpell)) {
+                if (!e.hasRight && e.leftTwoHanded) {
                     MarkDirty(Right);
                 }
             }
         });
         _inSlotSetup = false;
+        Latency::Mark(Latency::Stage::Equipped);
 
         if (e.hasRight) {
             SetModeSpellsFromHand(Right, e.rightSpell);
@@ -382,29 +460,22 @@ namespace IntegratedMagic {
     }
 
     void MagicState::OnSlotReleased(int slot) {
-#ifdef DEBUG
-        spdlog::info("[State] OnSlotReleased: slot={} active={} activeSlot={} modeShoutID={:#010x} isPower={} held={}",
-                     slot, _session.active, _session.activeSlot, _shout.modeShoutID, _shout.isPower, _shout.held);
-#endif
+        IM_TRACE(State,
+                 "[State] OnSlotReleased: slot={} active={} activeSlot={} modeShoutID={:#010x} isPower={} held={}",
+                 slot, _session.active, _session.activeSlot, _shout.modeShoutID, _shout.isPower, _shout.held);
         if (!_session.active || slot != _session.activeSlot) return;
 
         if (_shout.modeShoutID != 0) {
             const auto mode = SpellSettingsDB::Get().GetOrCreate(_shout.modeShoutID).mode;
-#ifdef DEBUG
-            spdlog::info("[State] OnSlotReleased: shout path mode={}", static_cast<int>(std::to_underlying(mode)));
-#endif
+            IM_TRACE(State, "[State] OnSlotReleased: shout path mode={}", static_cast<int>(std::to_underlying(mode)));
             if (mode == ActivationMode::Hold) {
                 StopShoutPress();
                 if (_shout.isPower) {
-#ifdef DEBUG
-                    spdlog::info("[State] OnSlotReleased: power Hold release -> finishing + TryFinalizeExit");
-#endif
+                    IM_TRACE(State, "[State] OnSlotReleased: power Hold release -> finishing + TryFinalizeExit");
                     _shout.finished = true;
                     TryFinalizeExit();
                 } else {
-#ifdef DEBUG
-                    spdlog::info("[State] OnSlotReleased: shout Hold release -> waitingStopEvent");
-#endif
+                    IM_TRACE(State, "[State] OnSlotReleased: shout Hold release -> waitingStopEvent");
                     _shout.waitingStopEvent = true;
                 }
             }
@@ -414,29 +485,28 @@ namespace IntegratedMagic {
         using enum Slots::Hand;
         auto handleHoldRelease = [&](Slots::Hand hand) {
             auto& hm = ModeFor(hand);
-            if (!hm.holdActive) return;
-            hm.holdActive = false;
+            if (!hm.HoldActive()) return;
 
             const auto id = Slots::GetSlotSpell(_session.activeSlot, hand);
             const auto* spell = id ? RE::TESForm::LookupByID<RE::SpellItem>(id) : nullptr;
             if (!spell || spell->GetChargeTime() <= 0.f) {
-                FinishHand(hand);
+                Dispatch(hand, HandEvent::Released);
                 return;
             }
 
             const auto src =
                 IsLeft(hand) ? RE::MagicSystem::CastingSource::kLeftHand : RE::MagicSystem::CastingSource::kRightHand;
             if (auto const* caster = MagicAction::GetCaster(GetPlayer(), src); !IsChargeComplete(caster, spell)) {
-                FinishHand(hand);
+                Dispatch(hand, HandEvent::Released);
                 return;
             }
             if (!hm.wantAutoAttack) {
-                FinishHand(hand);
+                Dispatch(hand, HandEvent::Released);
                 return;
             }
 
             StopAutoAttack(hand);
-            hm.holdFiredAndWaitingCastStop = true;
+            Dispatch(hand, HandEvent::ReleasedCharged);
         };
 
         handleHoldRelease(Left);
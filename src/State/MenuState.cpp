@@ -0,0 +1,138 @@
+#include "MenuState.h"
+
+#include <array>
+#include <atomic>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Config/Config.h"
+#include "PCH.h"
+
+namespace IntegratedMagic::MenuState {
+    namespace {
+        constexpr std::size_t kMaxMenus = 64;
+        constexpr std::size_t kCategoryCount = 4;
+
+        constexpr std::array kInputBlockedDefault{
+            "InventoryMenu"sv, "MagicMenu"sv, "StatsMenu"sv, "MapMenu"sv, "Journal Menu"sv, "FavoritesMenu"sv,
+            "ContainerMenu"sv, "BarterMenu"sv, "Training Menu"sv, "Crafting Menu"sv, "GiftMenu"sv, "Lockpicking Menu"sv,
+            "Sleep/Wait Menu"sv, "Loading Menu"sv, "Main Menu"sv, "Console"sv, "TweenMenu"sv,
+            "Mod Configuration Menu"sv,
+        };
+
+        constexpr std::array kHudSoftBlockedDefault{
+            "InventoryMenu"sv, "StatsMenu"sv, "MapMenu"sv, "Journal Menu"sv, "ContainerMenu"sv, "BarterMenu"sv,
+            "Crafting Menu"sv, "Lockpicking Menu"sv, "Sleep/Wait Menu"sv, "Dialogue Menu"sv, "Console"sv,
+            "Mod Configuration Menu"sv, "MagicMenu"sv, "TweenMenu"sv, "BestiaryMenu"sv, "OstimSceneMenu"sv,
+            "Dialogue Topic Menu"sv,
+        };
+
+        constexpr std::array kHudHardBlockedDefault{"Main Menu"sv, "Loading Menu"sv, "Fader Menu"sv};
+
+        constexpr std::array kCastInterruptDefault{
+            "ContainerMenu"sv, "InventoryMenu"sv, "MagicMenu"sv, "MapMenu"sv, "Journal Menu"sv, "Dialogue Menu"sv,
+        };
+
+        std::vector<RE::BSFixedString> g_names;
+        std::array<std::atomic<std::uint64_t>, kCategoryCount> g_categoryMask{};
+        std::atomic<std::uint64_t> g_magicMenuBit{0};
+        std::atomic<std::uint64_t> g_open{0};
+
+        std::uint64_t BitOf(const RE::BSFixedString& name) {
+            for (std::size_t i = 0; i < g_names.size(); ++i) {
+                if (g_names[i].data() == name.data()) return 1uLL << i;
+            }
+            return 0uLL;
+        }
+
+        std::uint64_t Intern(std::string_view name) {
+            while (!name.empty() && name.front() == ' ') name.remove_prefix(1);
+            while (!name.empty() && name.back() == ' ') name.remove_suffix(1);
+            if (name.empty()) return 0uLL;
+
+            const RE::BSFixedString fs{std::string{name}.c_str()};
+            if (const auto bit = BitOf(fs)) return bit;
+            if (g_names.size() >= kMaxMenus) {
+                spdlog::warn("[MenuState] Intern: more than {} menus configured, ignoring '{}'", kMaxMenus, name);
+                return 0uLL;
+            }
+            g_names.push_back(fs);
+            return 1uLL << (g_names.size() - 1);
+        }
+
+        std::uint64_t BuildMask(const std::string& configured, std::span<const std::string_view> defaults) {
+            std::uint64_t mask = 0uLL;
+            if (configured.empty()) {
+                for (auto name : defaults) mask |= Intern(name);
+                return mask;
+            }
+            std::string_view rest{configured};
+            while (!rest.empty()) {
+                const auto comma = rest.find(',');
+                mask |= Intern(rest.substr(0, comma));
+                if (comma == std::string_view::npos) break;
+                rest.remove_prefix(comma + 1);
+            }
+            return mask;
+        }
+
+        void SetCategory(Category category, std::uint64_t mask) {
+            g_categoryMask[static_cast<std::size_t>(category)].store(mask, std::memory_order_relaxed);
+        }
+
+        class MenuStateSink : public RE::BSTEventSink<RE::MenuOpenCloseEvent> {
+        public:
+            RE::BSEventNotifyControl ProcessEvent(const RE::MenuOpenCloseEvent* ev,
+                                                  RE::BSTEventSource<RE::MenuOpenCloseEvent>*) override {
+                if (!ev) return RE::BSEventNotifyControl::kContinue;
+                const auto bit = BitOf(ev->menuName);
+                if (!bit) return RE::BSEventNotifyControl::kContinue;
+                if (ev->opening)
+                    g_open.fetch_or(bit, std::memory_order_relaxed);
+                else
+                    g_open.fetch_and(~bit, std::memory_order_relaxed);
+                return RE::BSEventNotifyControl::kContinue;
+            }
+        };
+    }
+
+    void Register() {
+        auto* ui = RE::UI::GetSingleton();
+        if (!ui) return;
+
+        const auto& cfg = GetMagicConfig();
+        SetCategory(Category::InputBlocked, BuildMask(cfg.inputBlockedMenus, kInputBlockedDefault));
+        SetCategory(Category::HudSoftBlocked, BuildMask(cfg.hudSoftBlockedMenus, kHudSoftBlockedDefault));
+        SetCategory(Category::HudHardBlocked, BuildMask(cfg.hudHardBlockedMenus, kHudHardBlockedDefault));
+        SetCategory(Category::CastInterrupt, BuildMask(cfg.castInterruptMenus, kCastInterruptDefault));
+        g_magicMenuBit.store(Intern(RE::MagicMenu::MENU_NAME), std::memory_order_relaxed);
+
+        std::uint64_t open = 0uLL;
+        for (std::size_t i = 0; i < g_names.size(); ++i) {
+            if (ui->IsMenuOpen(g_names[i])) open |= (1uLL << i);
+        }
+        g_open.store(open, std::memory_order_relaxed);
+
+        static MenuStateSink sink;
+        ui->AddEventSink<RE::MenuOpenCloseEvent>(&sink);
+#ifdef DEBUG
+        spdlog::info("[MenuState] Register: tracking {} menus, open={:#018x}", g_names.size(), open);
+#endif
+    }
+
+    bool AnyOpen(Category category) {
+        const auto mask = g_categoryMask[static_cast<std::size_t>(category)].load(std::memory_order_relaxed);
+        return (g_open.load(std::memory_order_relaxed) & mask) != 0uLL;
+    }
+
+    bool IsMagicMenuOpen() {
+        return (g_open.load(std::memory_order_relaxed) & g_magicMenuBit.load(std::memory_order_relaxed)) != 0uLL;
+    }
+
+    bool InCategory(const RE::BSFixedString& menuName, Category category) {
+        return (BitOf(menuName) & g_categoryMask[static_cast<std::size_t>(category)].load(std::memory_order_relaxed)) !=
+               0uLL;
+    }
+}
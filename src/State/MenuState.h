@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+#include "PCH.h"
+
+namespace IntegratedMagic::MenuState {
+
+    enum class Category : std::uint8_t { InputBlocked = 0, HudSoftBlocked, HudHardBlocked, CastInterrupt };
+
+    void Register();
+
+    [[nodiscard]] bool AnyOpen(Category category);
+
+    [[nodiscard]] bool IsMagicMenuOpen();
+
+    [[nodiscard]] bool InCategory(const RE::BSFixedString& menuName, Category category);
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "PCH.h"
+#include "State/FormTraits.h"
 
 namespace IntegratedMagic::SpellClassify {
     inline constexpr RE::FormID kRightHandSlotID = 0x00013F42u;
@@ -15,18 +16,14 @@ namespace IntegratedMagic::SpellClassify {
     }
 
     [[nodiscard]] inline bool IsTwoHandedSpell(const RE::SpellItem* spell) {
-        if (!spell) return false;
-        using ST = RE::MagicSystem::SpellType;
-        const auto t = spell->GetSpellType();
-        if (t == ST::kPower || t == ST::kLesserPower || t == ST::kVoicePower) return false;
-        return GetSpellEquipSlotID(spell) == kBothHandsSlotID;
+        return spell && FormTraits::Get(spell).hand == FormTraits::HandClass::TwoHanded;
     }
 
     [[nodiscard]] inline bool IsRightHandOnlySpell(const RE::SpellItem* spell) {
-        return spell && GetSpellEquipSlotID(spell) == kRightHandSlotID;
+        return spell && FormTraits::Get(spell).hand == FormTraits::HandClass::RightOnly;
     }
 
     [[nodiscard]] inline bool IsLeftHandOnlySpell(const RE::SpellItem* spell) {
-        return spell && GetSpellEquipSlotID(spell) == kLeftHandSlotID;
+        return spell && FormTraits::Get(spell).hand == FormTraits::HandClass::LeftOnly;
     }
 }
\ No newline at end of file
@@ -1,13 +1,17 @@
 #pragma once
 
+#include <array>
 #include <vector>
 
+#include "Config/Config.h"
 #include "Config/Slots.h"
 #include "Config/SpellType.h"
+#include "HandMachine.h"
 #include "InventoryUtil.h"
 #include "PCH.h"
 #include "Persistence/SpellSettingsDB.h"
 #include "SyntheticInput.h"
+#include "Timers.h"
 
 namespace IntegratedMagic {
     struct SpellSettings;
@@ -23,22 +27,24 @@ namespace IntegratedMagic {
 
     struct HandMode {
         IntegratedMagic::ActivationMode mode{IntegratedMagic::ActivationMode::Hold};
+        HandPhase phase{HandPhase::Idle};
         bool wantAutoAttack{true};
-        bool pressActive{false};
-        bool holdActive{false};
-        bool autoActive{false};
-        bool waitingChargeComplete{false};
-        bool chargeComplete{false};
         bool waitingAutoAfterEquip{false};
-        bool holdFiredAndWaitingCastStop{false};
-        bool finished{false};
-        bool pressAutocast{false};
         float waitingEnableBumperSecs{0.0f};
         bool waitingBeginCast{false};
-        float beginCastWaitSecs{0.f};
         int beginCastRetries{0};
         bool waitingSpellFireFinalize{false};
-        float spellFireFinalizeSecs{0.f};
+
+        bool Finished() const noexcept { return phase == HandPhase::Finished; }
+        bool HoldActive() const noexcept { return phase == HandPhase::Hold; }
+        bool HoldFired() const noexcept { return phase == HandPhase::HoldReleased; }
+        bool PressActive() const noexcept {
+            return phase == HandPhase::Press || phase == HandPhase::PressCharging || phase == HandPhase::PressCharged;
+        }
+        bool Charging() const noexcept { return phase == HandPhase::AutoCharging || phase == HandPhase::PressCharging; }
+        bool Charged() const noexcept { return phase == HandPhase::AutoCharged || phase == HandPhase::PressCharged; }
+        bool AutoActive() const noexcept { return Charging() || Charged(); }
+        bool DrivesAutoAttack() const noexcept { return AutoActive() || (HoldActive() && wantAutoAttack); }
     };
 
     struct SessionState {
@@ -47,7 +53,6 @@ namespace IntegratedMagic {
         bool isDualCasting{false};
         bool attackEnabled{false};
         bool wasHandsDown{false};
-        float activeTimeoutSecs{0.f};
         int firstInterrupt{0};
         int dualCastSkipCastStops{0};
 
@@ -67,9 +72,8 @@ namespace IntegratedMagic {
         bool pendingRestoreAfterSheathe{false};
         bool sheatheAnimComplete{false};
         bool pendingPowerRestore{false};
-        float pendingPowerRestoreDelaySecs{0.f};
         static constexpr float kPowerRestoreDelaySec = 0.05f;
-        float sheatheWaitSecs{0.f};
+        bool sheatheWaitTimedOut{false};
         static constexpr float kSheatheWaitTimeoutSec = 1.0f;
 
         void ClearDirty() { dirtyLeft = dirtyRight = dirtyShout = false; }
@@ -108,12 +112,25 @@ namespace IntegratedMagic {
         void Reset() { *this = {}; }
     };
 
+    struct PreEquipState {
+        int slot{-1};
+        RE::SpellItem* leftSpell{nullptr};
+        RE::SpellItem* rightSpell{nullptr};
+
+        bool Active() const noexcept { return slot >= 0; }
+        void Reset() { *this = {}; }
+    };
+
     class MagicState {
     public:
         static MagicState& Get();
+        static void RegisterTimers();
 
         void OnSlotPressed(int slot);
         void OnSlotReleased(int slot);
+        void PreEquipSlot(int slot);
+        void CancelPreEquip();
+        int PreEquippedSlot() const noexcept { return _preEquip.slot; }
 
         void OnBeginCast(Slots::Hand hand);
         void OnCastStop();
@@ -139,7 +156,7 @@ namespace IntegratedMagic {
         bool IsWaitingSheatheRestore() const noexcept {
             return _restore.pendingRestoreAfterSheathe && !_restore.sheatheAnimComplete;
         }
-        bool IsPressMode() const noexcept { return _left.pressActive || _right.pressActive; }
+        bool IsPressMode() const noexcept { return _left.PressActive() || _right.PressActive(); }
         void NotifySheatheComplete() noexcept { _restore.sheatheAnimComplete = true; }
         void OnSpellFired(Slots::Hand hand);
         const HandMode& LeftMode() const noexcept { return _left; }
@@ -165,12 +182,27 @@ namespace IntegratedMagic {
             SpellSettings rightSettings{};
             bool hasLeft{false};
             bool hasRight{false};
+            bool leftTwoHanded{false};
             bool isShout{false};
             std::uint32_t shoutID{0};
             RE::TESForm* shoutForm{nullptr};
             SpellSettings shoutSettings{};
         };
 
+        struct ResolvedSlot {
+            std::uint32_t leftID{0};
+            std::uint32_t rightID{0};
+            std::uint32_t shoutID{0};
+            RE::SpellItem* leftSpell{nullptr};
+            RE::SpellItem* rightSpell{nullptr};
+            RE::TESForm* shoutForm{nullptr};
+            SpellSettings leftSettings{};
+            SpellSettings rightSettings{};
+            SpellSettings shoutSettings{};
+            bool leftTwoHanded{false};
+            bool shoutIsPower{false};
+        };
+
         void ResetHandStates() {
             _left = {};
             _right = {};
@@ -180,7 +212,6 @@ namespace IntegratedMagic {
             _session.isDualCasting = false;
             _session.dualCastSkipCastStops = 0;
             _session.firstInterrupt = 0;
-            _session.activeTimeoutSecs = 0.f;
             _session.modeSpellLeft = nullptr;
             _session.modeSpellRight = nullptr;
             CancelAllDelayedStarts();
@@ -244,17 +275,22 @@ namespace IntegratedMagic {
         void PrepareForOverwriteToSlot(int newSlot);
         void DisableHand(Slots::Hand hand);
 
+        void RefreshResolvedSlots();
         bool PrepareSlotEntry(int slot, SlotEntry& out);
         void EnterHand(Slots::Hand hand, const SpellSettings& ss);
-        void TogglePressHand(Slots::Hand hand, const SpellSettings& ss);
+        bool Dispatch(Slots::Hand hand, HandEvent ev);
         void FinishHand(Slots::Hand hand);
         void SetModeSpellsFromHand(Slots::Hand hand, RE::SpellItem* spell);
 
         void PumpDelayedStarts(float dt);
         void PumpAutomaticHand(Slots::Hand hand);
         void PumpAutoStartFallback(Slots::Hand hand, float dt);
+        void ArmBeginCastWait(Slots::Hand hand);
+        void OnBeginCastTimeout(Slots::Hand hand);
         void ScheduleSpellFireFinalize(Slots::Hand hand);
-        void PumpSpellFireFinalize(float dt);
+        void OnSpellFireFinalizeDue(Slots::Hand hand);
+        void OnPowerRestoreDue();
+        void OnActiveTimeout();
 
         void StartShoutPress();
         void StopShoutPress();
@@ -272,9 +308,17 @@ namespace IntegratedMagic {
         AutoAttackState _aa{};
         ShoutState _shout{};
         CastFlags _cast{};
+        PreEquipState _preEquip{};
         bool _inSlotSetup{false};
 
+        std::array<ResolvedSlot, MagicConfig::kMaxSlots> _resolved{};
+        std::uint32_t _resolvedSlotVersion{0};
+        std::uint32_t _resolvedDbVersion{0};
+        bool _resolvedValid{false};
+
         static constexpr float kDelayedStartSec = 0.050f;
+        static constexpr float kBeginCastTimeoutSec = 0.1f;
+        static constexpr float kSpellFireFinalizeDelaySec = 0.7f;
         static constexpr float kMaxActiveTimeoutSecs = 30.f;
     };
 
@@ -1,8 +1,12 @@
 #include "SyntheticInput.h"
 
-#include <mutex>
-#include <queue>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
 
+#include "Diagnostics/Latency.h"
 #include "PCH.h"
 
 namespace IntegratedMagic::detail {
@@ -13,19 +17,132 @@ namespace IntegratedMagic::detail {
     const RE::BSFixedString& RightAttackEvent() { return kRightAttackEvent; }
     const RE::BSFixedString& LeftAttackEvent() { return kLeftAttackEvent; }
 
-    struct SyntheticInputState {
-        std::mutex mutex;
-        std::queue<RE::ButtonEvent*> pending;
+    inline constexpr std::int16_t kNoPoolIdx = -1;
+
+    struct PendingInput {
+        RE::ButtonEvent* ev{nullptr};
+        bool retained{false};
+        std::int16_t poolIdx{kNoPoolIdx};
+    };
+
+    class PendingInputRing {
+    public:
+        static constexpr std::size_t kCapacity = 256;
+
+        PendingInputRing() {
+            for (std::size_t i = 0; i < kCapacity; ++i) _cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+
+        bool TryPush(const PendingInput& item) noexcept {
+            auto pos = _tail.load(std::memory_order_relaxed);
+            for (;;) {
+                auto& cell = _cells[pos & kMask];
+                const auto seq = cell.seq.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+                if (diff == 0) {
+                    if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        cell.item = item;
+                        cell.seq.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = _tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool TryPop(PendingInput& out) noexcept {
+            auto& cell = _cells[_head & kMask];
+            if (cell.seq.load(std::memory_order_acquire) != _head + 1) return false;
+            out = cell.item;
+            cell.seq.store(_head + kCapacity, std::memory_order_release);
+            ++_head;
+            return true;
+        }
+
+    private:
+        static constexpr std::size_t kMask = kCapacity - 1;
+        static_assert((kCapacity & kMask) == 0, "Ring capacity must be a power of two.");
+
+        struct Cell {
+            std::atomic<std::size_t> seq{0};
+            PendingInput item{};
+        };
+
+        std::array<Cell, kCapacity> _cells{};
+        alignas(64) std::atomic<std::size_t> _tail{0};
+        alignas(64) std::size_t _head{0};
     };
 
-    static SyntheticInputState& GetSynth() {
-        static SyntheticInputState s;
-        return s;
+    static PendingInputRing& GetRing() {
+        static PendingInputRing r;
+        return r;
+    }
+
+    enum class PooledKind : std::uint8_t { RightAttack = 0, LeftAttack = 1, Shout = 2 };
+
+    enum class PooledState : std::uint8_t { Free = 0, Queued = 1, InFlight = 2 };
+
+    struct PooledEvent {
+        RE::ButtonEvent* ev{nullptr};
+        std::atomic<PooledState> state{PooledState::Free};
+    };
+
+    inline constexpr std::size_t kPoolKinds = 3;
+    inline constexpr std::size_t kPoolPerKind = 4;
+    inline constexpr std::size_t kRetainedPoolBase = kPoolKinds * kPoolPerKind;
+    inline constexpr std::size_t kRetainedPoolSize = 16;
+    inline constexpr std::size_t kPoolSize = kRetainedPoolBase + kRetainedPoolSize;
+
+    static std::array<PooledEvent, kPoolSize> g_pool{};
+    static std::array<PendingInput, PendingInputRing::kCapacity> g_inFlight{};
+    static std::size_t g_inFlightCount{0};
+
+    struct PoolCounters {
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> misses{0};
+        std::atomic<std::uint32_t> outstanding{0};
+    };
+
+    static std::atomic<std::uint64_t> g_overflowCount{0};
+    static std::array<PoolCounters, 2> g_poolCounters{};
+
+    static PoolCounters& CountersFor(SyntheticPool pool) { return g_poolCounters[static_cast<std::size_t>(pool)]; }
+
+    static PoolCounters& CountersFor(std::int16_t idx) {
+        return CountersFor(static_cast<std::size_t>(idx) >= kRetainedPoolBase ? SyntheticPool::Retained
+                                                                              : SyntheticPool::Dispatch);
+    }
+
+    static void ReleasePooled(std::int16_t idx) {
+        g_pool[static_cast<std::size_t>(idx)].state.store(PooledState::Free, std::memory_order_release);
+        CountersFor(idx).outstanding.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    static void DestroyEvent(RE::ButtonEvent* ev) {
+        std::destroy_at(ev);
+        RE::free(ev);
+    }
+
+    static void PushPending(RE::ButtonEvent* ev, bool retained, std::int16_t poolIdx = kNoPoolIdx) {
+        if (GetRing().TryPush(PendingInput{ev, retained, poolIdx})) return;
+        g_overflowCount.fetch_add(1, std::memory_order_relaxed);
+        if (poolIdx != kNoPoolIdx)
+            ReleasePooled(poolIdx);
+        else
+            DestroyEvent(ev);
     }
 
-    static SyntheticInputState& GetRetain() {
-        static SyntheticInputState s;
-        return s;
+    static void AppendEvent(RE::InputEvent*& head, RE::InputEvent*& tail, RE::InputEvent* ev) {
+        ev->next = nullptr;
+        if (!head) {
+            head = tail = ev;
+        } else {
+            tail->next = ev;
+            tail = ev;
+        }
     }
 
     static RE::ButtonEvent* MakeAttackButtonEvent(bool leftHand, float value, float heldSecs) {
@@ -34,62 +151,136 @@ namespace IntegratedMagic::detail {
         return RE::ButtonEvent::Create(RE::INPUT_DEVICE::kMouse, ue, id, value, heldSecs);
     }
 
-    static RE::InputEvent* DrainQueue(SyntheticInputState& st, RE::InputEvent* head) {
-        std::queue<RE::ButtonEvent*> local;
-        {
-            std::scoped_lock lk(st.mutex);
-            local.swap(st.pending);
+    static RE::ButtonEvent* CreateForKind(PooledKind kind, float value, float heldSecs) {
+        switch (kind) {
+            case PooledKind::Shout:
+                return RE::ButtonEvent::Create(RE::INPUT_DEVICE::kKeyboard, kShoutUserEvent, 0, value, heldSecs);
+            case PooledKind::LeftAttack:
+                return MakeAttackButtonEvent(true, value, heldSecs);
+            default:
+                return MakeAttackButtonEvent(false, value, heldSecs);
         }
-        if (local.empty()) return head;
+    }
 
-        RE::InputEvent* synthHead = nullptr;
-        RE::InputEvent* synthTail = nullptr;
-        while (!local.empty()) {
-            auto* ev = local.front();
-            local.pop();
-            if (!ev) continue;
-            ev->next = nullptr;
-            if (!synthHead) {
-                synthHead = synthTail = ev;
-            } else {
-                synthTail->next = ev;
-                synthTail = ev;
-            }
+    static std::int16_t AcquirePooled(SyntheticPool pool, std::size_t base, std::size_t count) {
+        for (std::size_t i = base; i < base + count; ++i) {
+            auto expected = PooledState::Free;
+            if (g_pool[i].state.compare_exchange_strong(expected, PooledState::Queued, std::memory_order_acquire))
+                return static_cast<std::int16_t>(i);
+        }
+        CountersFor(pool).misses.fetch_add(1, std::memory_order_relaxed);
+        return kNoPoolIdx;
+    }
+
+    static void SubmitPooled(std::int16_t idx) {
+        auto& p = g_pool[static_cast<std::size_t>(idx)];
+        p.ev->next = nullptr;
+        auto& counters = CountersFor(idx);
+        counters.hits.fetch_add(1, std::memory_order_relaxed);
+        counters.outstanding.fetch_add(1, std::memory_order_relaxed);
+        PushPending(p.ev, static_cast<std::size_t>(idx) >= kRetainedPoolBase, idx);
+    }
+
+    static void DispatchPooled(PooledKind kind, float value, float heldSecs) {
+        const auto idx = AcquirePooled(SyntheticPool::Dispatch, static_cast<std::size_t>(kind) * kPoolPerKind,
+                                       kPoolPerKind);
+        if (idx == kNoPoolIdx) {
+            if (auto* ev = CreateForKind(kind, value, heldSecs)) PushPending(ev, false);
+            return;
+        }
+        auto& p = g_pool[static_cast<std::size_t>(idx)];
+        if (!p.ev) p.ev = CreateForKind(kind, value, heldSecs);
+        if (!p.ev) {
+            p.state.store(PooledState::Free, std::memory_order_release);
+            return;
         }
-        if (!head) return synthHead;
-        synthTail->next = head;
-        return synthHead;
+        p.ev->value = value;
+        p.ev->heldDownSecs = heldSecs;
+        SubmitPooled(idx);
     }
 
     void EnqueueSyntheticAttack(RE::ButtonEvent* ev) {
         if (!ev) return;
-        auto& st = GetSynth();
-        std::scoped_lock lk(st.mutex);
-        st.pending.push(ev);
+        PushPending(ev, false);
     }
 
-    void EnqueueRetainedEvent(RE::INPUT_DEVICE dev, std::uint32_t idCode, const RE::BSFixedString& userEvent,
-                              float value, float heldSecs) {
-        auto* ev = RE::ButtonEvent::Create(dev, userEvent, idCode, value, heldSecs);
-        if (!ev) return;
-        auto& st = GetRetain();
-        std::scoped_lock lk(st.mutex);
-        st.pending.push(ev);
+    void EnqueueRetainedEvent(RE::INPUT_DEVICE dev, std::uint32_t idCode, RE::BSFixedString userEvent, float value,
+                              float heldSecs) {
+        const auto idx = AcquirePooled(SyntheticPool::Retained, kRetainedPoolBase, kRetainedPoolSize);
+        if (idx == kNoPoolIdx) {
+            if (auto* ev = RE::ButtonEvent::Create(dev, userEvent, idCode, value, heldSecs)) PushPending(ev, true);
+            return;
+        }
+        auto& p = g_pool[static_cast<std::size_t>(idx)];
+        if (!p.ev) p.ev = RE::ButtonEvent::Create(dev, userEvent, idCode, value, heldSecs);
+        if (!p.ev) {
+            p.state.store(PooledState::Free, std::memory_order_release);
+            return;
+        }
+        p.ev->device = dev;
+        p.ev->idCode = idCode;
+        p.ev->userEvent = std::move(userEvent);
+        p.ev->value = value;
+        p.ev->heldDownSecs = heldSecs;
+        SubmitPooled(idx);
     }
 
+    std::uint64_t SyntheticInputOverflowCount() { return g_overflowCount.load(std::memory_order_relaxed); }
+
     RE::InputEvent* FlushSyntheticInput(RE::InputEvent* head) {
-        head = DrainQueue(GetSynth(), head);
-        head = DrainQueue(GetRetain(), head);
+        RE::InputEvent* retainHead = nullptr;
+        RE::InputEvent* retainTail = nullptr;
+        RE::InputEvent* synthHead = nullptr;
+        RE::InputEvent* synthTail = nullptr;
+
+        // Stops once every in-flight cell is taken; anything left in the ring goes out with the next poll.
+        PendingInput item{};
+        while (g_inFlightCount < g_inFlight.size() && GetRing().TryPop(item)) {
+            if (!item.ev) continue;
+            if (item.poolIdx != kNoPoolIdx)
+                g_pool[static_cast<std::size_t>(item.poolIdx)].state.store(PooledState::InFlight,
+                                                                           std::memory_order_relaxed);
+            g_inFlight[g_inFlightCount++] = item;
+            if (item.retained) {
+                AppendEvent(retainHead, retainTail, item.ev);
+            } else {
+                AppendEvent(synthHead, synthTail, item.ev);
+                Latency::Mark(Latency::Stage::AttackFlushed);
+            }
+        }
+
+        if (synthTail) {
+            synthTail->next = head;
+            head = synthHead;
+        }
+        if (retainTail) {
+            retainTail->next = head;
+            head = retainHead;
+        }
         return head;
     }
 
+    void RecycleSyntheticInput() {
+        for (std::size_t i = 0; i < g_inFlightCount; ++i) {
+            const auto& item = g_inFlight[i];
+            if (item.poolIdx != kNoPoolIdx)
+                ReleasePooled(item.poolIdx);
+            else
+                DestroyEvent(item.ev);
+        }
+        g_inFlightCount = 0;
+    }
+
+    SyntheticPoolStats GetSyntheticPoolStats(SyntheticPool pool) {
+        const auto& c = CountersFor(pool);
+        return SyntheticPoolStats{c.hits.load(std::memory_order_relaxed), c.misses.load(std::memory_order_relaxed),
+                                  c.outstanding.load(std::memory_order_relaxed)};
+    }
+
     void DispatchAttack(Slots::Hand hand, float value, float heldSecs) {
         const bool left = (hand == Slots::Hand::Left);
-        EnqueueSyntheticAttack(MakeAttackButtonEvent(left, value, heldSecs));
+        DispatchPooled(left ? PooledKind::LeftAttack : PooledKind::RightAttack, value, heldSecs);
     }
 
-    void DispatchShout(float value, float heldSecs) {
-        auto* ev = RE::ButtonEvent::Create(RE::INPUT_DEVICE::kKeyboard, kShoutUserEvent, 0, value, heldSecs);
-        if (ev) EnqueueSyntheticAttack(ev);
-    }
+    void DispatchShout(float value, float heldSecs) { DispatchPooled(PooledKind::Shout, value, heldSecs); }
 }
\ No newline at end of file
@@ -10,13 +10,29 @@ namespace IntegratedMagic::detail {
     const RE::BSFixedString& RightAttackEvent();
     const RE::BSFixedString& LeftAttackEvent();
 
+    // Takes ownership of ev; it is destroyed by RecycleSyntheticInput after the poll that flushes it.
     void EnqueueSyntheticAttack(RE::ButtonEvent* ev);
 
-    void EnqueueRetainedEvent(RE::INPUT_DEVICE dev, std::uint32_t idCode, const RE::BSFixedString& userEvent,
-                              float value, float heldSecs);
+    void EnqueueRetainedEvent(RE::INPUT_DEVICE dev, std::uint32_t idCode, RE::BSFixedString userEvent, float value,
+                              float heldSecs);
 
     RE::InputEvent* FlushSyntheticInput(RE::InputEvent* head);
 
+    void RecycleSyntheticInput();
+
+    std::uint64_t SyntheticInputOverflowCount();
+
+    struct SyntheticPoolStats {
+        std::uint64_t hits{0};
+        std::uint64_t misses{0};
+        std::uint32_t outstanding{0};
+    };
+
+    // Dispatch holds the attack and shout events, Retained the reinjected key events.
+    enum class SyntheticPool : std::uint8_t { Dispatch = 0, Retained = 1 };
+
+    SyntheticPoolStats GetSyntheticPoolStats(SyntheticPool pool);
+
     void DispatchAttack(Slots::Hand hand, float value, float heldSecs);
     void DispatchShout(float value, float heldSecs);
 
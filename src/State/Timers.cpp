@@ -0,0 +1,166 @@
+#include "Timers.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <mutex>
+
+#include "PCH.h"
+
+namespace IntegratedMagic::Timers {
+    namespace {
+        constexpr std::size_t kKinds = static_cast<std::size_t>(Timer::kCount);
+        constexpr std::size_t kNodes = kKinds * kMaxTimerIndex;
+        constexpr std::int64_t kWheelSlots = 256;
+        constexpr std::int64_t kTickUs = 1000;
+        constexpr std::uint16_t kNil = 0xFFFF;
+
+        static_assert(kNodes < kNil, "Timer node ids must fit in uint16_t.");
+
+        enum class NodeState : std::uint8_t { Idle, Armed, Firing };
+
+        struct Node {
+            std::int64_t deadline{0};
+            std::uint16_t prev{kNil};
+            std::uint16_t next{kNil};
+            NodeState state{NodeState::Idle};
+        };
+
+        class Wheel {
+        public:
+            Wheel() { _heads.fill(kNil); }
+
+            void SetHandler(Timer timer, Handler handler) {
+                std::scoped_lock _{_mtx};
+                _handlers[static_cast<std::size_t>(timer)] = handler;
+            }
+
+            void Arm(std::uint16_t id, float secs) {
+                std::scoped_lock _{_mtx};
+                auto& n = _nodes[id];
+                if (n.state == NodeState::Armed) Unlink(id);
+                const auto us = static_cast<std::int64_t>(std::ceil(std::max(secs, 0.f) * 1'000'000.f));
+                n.deadline = std::max((_nowUs + us + kTickUs - 1) / kTickUs, _lastTick + 1);
+                n.state = NodeState::Armed;
+                Link(id);
+            }
+
+            void Cancel(std::uint16_t id) {
+                std::scoped_lock _{_mtx};
+                auto& n = _nodes[id];
+                if (n.state == NodeState::Armed) Unlink(id);
+                n.state = NodeState::Idle;
+            }
+
+            [[nodiscard]] bool IsArmed(std::uint16_t id) {
+                std::scoped_lock _{_mtx};
+                return _nodes[id].state == NodeState::Armed;
+            }
+
+            void Advance(float dt) {
+                if (!(dt > 0.f)) return;
+                std::size_t fired = 0;
+                {
+                    std::scoped_lock _{_mtx};
+                    _nowSecs += static_cast<double>(dt);
+                    _nowUs = static_cast<std::int64_t>(std::llround(_nowSecs * 1'000'000.0));
+                    const auto nowTick = _nowUs / kTickUs;
+                    const auto steps = std::min(nowTick - _lastTick, kWheelSlots);
+                    for (std::int64_t i = 1; i <= steps; ++i) {
+                        auto id = _heads[static_cast<std::size_t>((_lastTick + i) & (kWheelSlots - 1))];
+                        while (id != kNil) {
+                            const auto next = _nodes[id].next;
+                            if (_nodes[id].deadline <= nowTick) {
+                                Unlink(id);
+                                _nodes[id].state = NodeState::Firing;
+                                _fired[fired++] = id;
+                            }
+                            id = next;
+                        }
+                    }
+                    _lastTick = nowTick;
+                }
+
+                for (std::size_t i = 0; i < fired; ++i) {
+                    const auto id = _fired[i];
+                    Handler handler = nullptr;
+                    {
+                        std::scoped_lock _{_mtx};
+                        if (_nodes[id].state != NodeState::Firing) continue;
+                        _nodes[id].state = NodeState::Idle;
+                        handler = _handlers[id / kMaxTimerIndex];
+                    }
+                    if (handler) handler(id % kMaxTimerIndex);
+                }
+            }
+
+        private:
+            void Link(std::uint16_t id) {
+                auto& n = _nodes[id];
+                auto& head = _heads[static_cast<std::size_t>(n.deadline & (kWheelSlots - 1))];
+                n.prev = kNil;
+                n.next = head;
+                if (head != kNil) _nodes[head].prev = id;
+                head = id;
+            }
+
+            void Unlink(std::uint16_t id) {
+                auto& n = _nodes[id];
+                if (n.prev != kNil)
+                    _nodes[n.prev].next = n.next;
+                else
+                    _heads[static_cast<std::size_t>(n.deadline & (kWheelSlots - 1))] = n.next;
+                if (n.next != kNil) _nodes[n.next].prev = n.prev;
+                n.prev = n.next = kNil;
+            }
+
+            std::mutex _mtx;
+            std::array<Node, kNodes> _nodes{};
+            std::array<std::uint16_t, kWheelSlots> _heads{};
+            std::array<Handler, kKinds> _handlers{};
+            std::array<std::uint16_t, kNodes> _fired{};
+            double _nowSecs{0.0};
+            std::int64_t _nowUs{0};
+            std::int64_t _lastTick{0};
+        };
+
+        Wheel& GetWheel() {
+            static Wheel wheel;
+            return wheel;
+        }
+
+        std::uint16_t NodeId(Timer timer, std::uint32_t index) {
+            return static_cast<std::uint16_t>(static_cast<std::uint32_t>(timer) * kMaxTimerIndex + index);
+        }
+
+        bool Valid(Timer timer, std::uint32_t index) {
+            return static_cast<std::size_t>(timer) < kKinds && index < kMaxTimerIndex;
+        }
+    }
+
+    void SetHandler(Timer timer, Handler handler) {
+        if (static_cast<std::size_t>(timer) >= kKinds) return;
+        GetWheel().SetHandler(timer, handler);
+    }
+
+    void Arm(Timer timer, std::uint32_t index, float secs) {
+        if (!Valid(timer, index)) return;
+        GetWheel().Arm(NodeId(timer, index), secs);
+    }
+
+    void Cancel(Timer timer, std::uint32_t index) {
+        if (!Valid(timer, index)) return;
+        GetWheel().Cancel(NodeId(timer, index));
+    }
+
+    void CancelAll(Timer timer) {
+        for (std::uint32_t i = 0; i < kMaxTimerIndex; ++i) Cancel(timer, i);
+    }
+
+    bool IsArmed(Timer timer, std::uint32_t index) {
+        if (!Valid(timer, index)) return false;
+        return GetWheel().IsArmed(NodeId(timer, index));
+    }
+
+    void Advance(float dt) { GetWheel().Advance(dt); }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+namespace IntegratedMagic::Timers {
+
+    enum class Timer : std::uint8_t {
+        ExclusiveConfirm = 0,
+        SimWindow,
+        SlotTrigger,
+        BeginCastWait,
+        SpellFireFinalize,
+        PowerRestoreDelay,
+        SheatheWait,
+        ActiveTimeout,
+        kCount
+    };
+
+    inline constexpr std::uint32_t kMaxTimerIndex = 64;
+
+    using Handler = void (*)(std::uint32_t index);
+
+    void SetHandler(Timer timer, Handler handler);
+
+    void Arm(Timer timer, std::uint32_t index, float secs);
+    void Cancel(Timer timer, std::uint32_t index);
+    void CancelAll(Timer timer);
+    [[nodiscard]] bool IsArmed(Timer timer, std::uint32_t index);
+
+    void Advance(float dt);
+}
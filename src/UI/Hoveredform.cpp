@@ -2,7 +2,7 @@
 
 #include "PCH.h"
 #include "State/EquipSink.h"
-#include "State/SpellClassify.h"
+#include "State/FormTraits.h"
 
 namespace IntegratedMagic::HoveredForm {
     namespace {
@@ -53,26 +53,29 @@ namespace IntegratedMagic::HoveredForm {
             return MagicType::None;
         }
 
-        auto* form = RE::TESForm::LookupByID(formID);
-        if (!form) {
+        const auto traits = FormTraits::Get(formID);
+        if (!traits.Valid()) {
 #ifdef DEBUG
             spdlog::info("[HoveredForm] GetHoveredMagicType: formID={:#010x} not found -> None", formID);
 #endif
             return MagicType::None;
         }
 
-        if (form->As<RE::TESShout>()) return MagicType::Shout;
-
-        if (auto const* spell = form->As<RE::SpellItem>()) {
-            using ST = RE::MagicSystem::SpellType;
-            const auto t = spell->GetSpellType();
-            if (t == ST::kPower || t == ST::kLesserPower) return MagicType::Power;
-
-            using namespace SpellClassify;
-            if (IsTwoHandedSpell(spell)) return MagicType::TwoHandedSpell;
-            if (IsRightHandOnlySpell(spell)) return MagicType::RightOnlySpell;
-            if (IsLeftHandOnlySpell(spell)) return MagicType::LeftOnlySpell;
-            return MagicType::Spell;
+        if (traits.IsShout()) return MagicType::Shout;
+
+        if (traits.IsSpell()) {
+            if (traits.spellType == SpellType::Power) return MagicType::Power;
+            switch (traits.hand) {
+                using enum FormTraits::HandClass;
+                case TwoHanded:
+                    return MagicType::TwoHandedSpell;
+                case RightOnly:
+                    return MagicType::RightOnlySpell;
+                case LeftOnly:
+                    return MagicType::LeftOnlySpell;
+                default:
+                    return MagicType::Spell;
+            }
         }
 
 #ifdef DEBUG
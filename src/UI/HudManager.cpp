@@ -9,54 +9,19 @@
 #include "PCH.h"
 #include "PopupDrawer.h"
 #include "SlotDrawer.h"
+#include "State/MenuState.h"
 #include "State/State.h"
 
 namespace IntegratedMagic::HUD {
 
     bool IsHardBlocked() {
         if (!RE::PlayerCharacter::GetSingleton()) return true;
-        auto* ui = RE::UI::GetSingleton();
-        if (!ui) return true;
-        static const RE::BSFixedString mainMenu{"Main Menu"};
-        static const RE::BSFixedString loadingMenu{"Loading Menu"};
-        static const RE::BSFixedString faderMenu{"Fader Menu"};
-        return ui->IsMenuOpen(mainMenu) || ui->IsMenuOpen(loadingMenu) || ui->IsMenuOpen(faderMenu);
+        return MenuState::AnyOpen(MenuState::Category::HudHardBlocked);
     }
 
-    bool IsSoftBlocked() {
-        auto* ui = RE::UI::GetSingleton();
-        if (!ui) return true;
-        static const RE::BSFixedString magicMenu{"MagicMenu"};
-        static const RE::BSFixedString tweenMenu{"TweenMenu"};
-        static const RE::BSFixedString inventoryMenu{"InventoryMenu"};
-        static const RE::BSFixedString statsMenu{"StatsMenu"};
-        static const RE::BSFixedString mapMenu{"MapMenu"};
-        static const RE::BSFixedString journalMenu{"Journal Menu"};
-        static const RE::BSFixedString containerMenu{"ContainerMenu"};
-        static const RE::BSFixedString barterMenu{"BarterMenu"};
-        static const RE::BSFixedString craftingMenu{"Crafting Menu"};
-        static const RE::BSFixedString lockpickingMenu{"Lockpicking Menu"};
-        static const RE::BSFixedString sleepWaitMenu{"Sleep/Wait Menu"};
-        static const RE::BSFixedString dialogueMenu{"Dialogue Menu"};
-        static const RE::BSFixedString console{"Console"};
-        static const RE::BSFixedString mcm{"Mod Configuration Menu"};
-        static const RE::BSFixedString bestiary{"BestiaryMenu"};
-        static const RE::BSFixedString ostim{"OstimSceneMenu"};
-        static const RE::BSFixedString dialogueTopicMenu{"Dialogue Topic Menu"};
-        return ui->IsMenuOpen(inventoryMenu) || ui->IsMenuOpen(statsMenu) || ui->IsMenuOpen(mapMenu) ||
-               ui->IsMenuOpen(journalMenu) || ui->IsMenuOpen(containerMenu) || ui->IsMenuOpen(barterMenu) ||
-               ui->IsMenuOpen(craftingMenu) || ui->IsMenuOpen(lockpickingMenu) || ui->IsMenuOpen(sleepWaitMenu) ||
-               ui->IsMenuOpen(dialogueMenu) || ui->IsMenuOpen(console) || ui->IsMenuOpen(mcm) ||
-               ui->IsMenuOpen(magicMenu) || ui->IsMenuOpen(tweenMenu) || ui->IsMenuOpen(bestiary) ||
-               ui->IsMenuOpen(ostim) || ui->IsMenuOpen(dialogueTopicMenu);
-    }
+    bool IsSoftBlocked() { return MenuState::AnyOpen(MenuState::Category::HudSoftBlocked); }
 
-    bool IsInMagicMenu() {
-        auto* ui = RE::UI::GetSingleton();
-        if (!ui) return false;
-        static const RE::BSFixedString magicMenu{"MagicMenu"};
-        return ui->IsMenuOpen(magicMenu);
-    }
+    bool IsInMagicMenu() { return MenuState::IsMagicMenuOpen(); }
 
     bool EvaluateHudVisibility() {
         using enum IntegratedMagic::HudVisibilityFlag;
@@ -7,11 +7,16 @@
 #include <utility>
 
 #include "Config/Config.h"
+#include "Config/Slots.h"
 #include "Config/SpellType.h"
+#include "Diagnostics/FlightRecorder.h"
+#include "Diagnostics/Latency.h"
+#include "Diagnostics/Trace.h"
 #include "Input/Input.h"
 #include "PCH.h"
 #include "Persistence/SpellSettingsDB.h"
 #include "SKSEMenuFramework.h"
+#include "State/State.h"
 #include "UI/HudManager.h"
 #include "UI/PolyFill.h"
 #include "UI/Strings.h"
@@ -26,6 +31,7 @@ namespace {
 
     bool g_pending = false;
     constexpr int kHudPopupSlot = -1;
+    constexpr int kBankCycleSlot = -2;
     int g_selectedSlot = 0;
     FieldCaptureState g_fieldCapture{};
 
@@ -44,9 +50,7 @@ namespace {
 
     void ClearSlotData(IntegratedMagic::MagicConfig& cfg, int slot) {
         const auto idx = static_cast<std::size_t>(slot);
-        cfg.slotSpellFormIDLeft[idx].store(0u, std::memory_order_relaxed);
-        cfg.slotSpellFormIDRight[idx].store(0u, std::memory_order_relaxed);
-        cfg.slotShoutFormID[idx].store(0u, std::memory_order_relaxed);
+        for (auto& bank : cfg.banks) bank.Clear(idx);
         auto& icfg = cfg.slotInput[idx];
         icfg.KeyboardScanCode1.store(-1, std::memory_order_relaxed);
         icfg.KeyboardScanCode2.store(-1, std::memory_order_relaxed);
@@ -54,6 +58,7 @@ namespace {
         icfg.GamepadButton1.store(-1, std::memory_order_relaxed);
         icfg.GamepadButton2.store(-1, std::memory_order_relaxed);
         icfg.GamepadButton3.store(-1, std::memory_order_relaxed);
+        icfg.Trigger.store(0, std::memory_order_relaxed);
     }
 
     bool SlotHasHotkey(const IntegratedMagic::InputConfig& icfg) {
@@ -232,6 +237,21 @@ namespace {
             ImGuiMCP::EndTable();
         }
 
+        if (showModifier) {
+            ImGuiMCP::Spacing();
+            const std::string triggerNames = IntegratedMagic::Strings::Get("Trigger_Chord", "Chord") + '\0' +
+                                             IntegratedMagic::Strings::Get("Trigger_Sequence", "Sequence") + '\0' +
+                                             IntegratedMagic::Strings::Get("Trigger_DoubleTap", "Double tap") + '\0' +
+                                             IntegratedMagic::Strings::Get("Trigger_Hold", "Hold") + '\0';
+            int triggerIdx = icfg.Trigger.load(std::memory_order_relaxed);
+            ImGuiMCP::SetNextItemWidth(180.0f);
+            if (ImGuiMCP::Combo(IntegratedMagic::Strings::Get("Item_Trigger", "Trigger##trigger").c_str(), &triggerIdx,
+                                triggerNames.c_str())) {
+                icfg.Trigger.store(triggerIdx, std::memory_order_relaxed);
+                dirty = true;
+            }
+        }
+
         if (g_fieldCapture.active) {
             ImGuiMCP::Spacing();
             const auto msg = std::format(
@@ -242,6 +262,55 @@ namespace {
         }
     }
 
+    void DrawSlotBanks(IntegratedMagic::MagicConfig& cfg, bool& dirty) {
+        namespace S = IntegratedMagic::Strings;
+        ImGuiMCP::Spacing();
+        ImGuiMCP::SeparatorText(S::Get("Banks_Label", "Slot Banks").c_str());
+
+        const auto oldCount = static_cast<int>(cfg.BankCount());
+        int n = oldCount;
+        ImGuiMCP::SetNextItemWidth(180.0f);
+        if (ImGuiMCP::InputInt(S::Get("Item_BankCount", "Bank count").c_str(), &n)) {
+            const int minBanks =
+                IntegratedMagic::MagicState::Get().IsActive() ? static_cast<int>(cfg.ActiveBankIndex()) + 1 : 1;
+            n = std::clamp(n, minBanks, static_cast<int>(IntegratedMagic::MagicConfig::kMaxBanks));
+            cfg.bankCount.store(static_cast<std::uint32_t>(n), std::memory_order_relaxed);
+            dirty = true;
+            for (int b = n; b < oldCount; ++b) {
+                auto& bank = cfg.banks[static_cast<std::size_t>(b)];
+                for (std::size_t slot = 0; slot < IntegratedMagic::MagicConfig::kMaxSlots; ++slot) bank.Clear(slot);
+                bank.name.clear();
+            }
+            if (cfg.ActiveBankIndex() >= cfg.BankCount()) IntegratedMagic::Slots::SetActiveBank(0);
+        }
+        if (ImGuiMCP::IsItemHovered()) {
+            ImGuiMCP::SetTooltip("%s", S::Get("Tooltip_BankCount",
+                                              "Each bank holds its own spells for every slot.\n"
+                                              "The Bank Cycle hotkey switches to the next bank.")
+                                           .c_str());
+        }
+
+        const auto active = cfg.ActiveBankIndex();
+        for (std::uint32_t b = 0; b < cfg.BankCount(); ++b) {
+            const auto& name = cfg.banks[b].name;
+            const auto label =
+                std::format("{}##bank{}", name.empty() ? std::format("{} {}", S::Get("Bank_Default", "Bank"), b + 1)
+                                                       : name,
+                            b);
+            if (b > 0) ImGuiMCP::SameLine();
+            if (ImGuiMCP::RadioButton(label.c_str(), b == active)) IntegratedMagic::Slots::SetActiveBank(b);
+        }
+
+        auto& bank = cfg.Bank();
+        std::array<char, 64> buf{};
+        bank.name.copy(buf.data(), buf.size() - 1);
+        ImGuiMCP::SetNextItemWidth(180.0f);
+        if (ImGuiMCP::InputText(S::Get("Item_BankName", "Bank name").c_str(), buf.data(), buf.size())) {
+            bank.name = buf.data();
+            dirty = true;
+        }
+    }
+
     void DrawGeneralTab(IntegratedMagic::MagicConfig& cfg, bool& dirty) {
         ImGuiMCP::Spacing();
 
@@ -265,8 +334,11 @@ namespace {
                     g_selectedSlot = n > 0 ? 0 : kHudPopupSlot;
                 }
             }
+            cfg.TouchSlots();
         }
 
+        DrawSlotBanks(cfg, dirty);
+
         ImGuiMCP::Spacing();
         ImGuiMCP::SeparatorText(IntegratedMagic::Strings::Get("HUD_Visibility_Label", "HUD Visibility").c_str());
 
@@ -363,6 +435,42 @@ namespace {
         }
     }
 
+    std::string ConflictTargetName(int other) {
+        namespace S = IntegratedMagic::Strings;
+        if (other == Input::HotkeyConflict::kHudPopup) return S::Get("List_HudPopup", "HUD Popup");
+        if (other == Input::HotkeyConflict::kModifier) return S::Get("Conflict_Modifier", "Modifier key");
+        if (other == Input::HotkeyConflict::kBankCycle) return S::Get("List_BankCycle", "Bank Cycle");
+        if (other == Input::HotkeyConflict::kGameControl) return S::Get("Conflict_GameControl", "Game control");
+        return S::Get(std::format("List_Magic{}", other + 1), std::format("Magic {}", other + 1));
+    }
+
+    void DrawHotkeyConflicts() {
+        namespace S = IntegratedMagic::Strings;
+        const auto conflicts = Input::GetHotkeyConflicts();
+
+        ImGuiMCP::Spacing();
+        ImGuiMCP::SeparatorText(S::Get("Conflict_Header", "Hotkey conflicts").c_str());
+        if (conflicts.empty()) {
+            ImGuiMCP::TextDisabled("%s", S::Get("Conflict_None", "None, every combo fires without delay").c_str());
+            return;
+        }
+        for (const auto& c : conflicts) {
+            const auto line = std::format("{} / {} ({})", ConflictTargetName(c.slot), ConflictTargetName(c.other),
+                                          c.gamepad ? S::Get("Conflict_Gamepad", "gamepad")
+                                                    : S::Get("Conflict_Keyboard", "keyboard"));
+            ImGuiMCP::BulletText("%s", line.c_str());
+            if (ImGuiMCP::IsItemHovered()) {
+                const auto tip = c.other == Input::HotkeyConflict::kGameControl
+                                     ? S::Get("Tooltip_ConflictGameControl",
+                                              "A key of this combo is bound to a game control, so the slot holds\n"
+                                              "it back briefly until the combo is complete.")
+                                     : S::Get("Tooltip_Conflict", "One combo is contained in the other, so these slots "
+                                                                  "wait\nbriefly to confirm which combo was meant.");
+                ImGuiMCP::SetTooltip("%s", tip.c_str());
+            }
+        }
+    }
+
     void DrawControlsTab(IntegratedMagic::MagicConfig& cfg, bool& dirty) {
         const auto n = static_cast<int>(cfg.SlotCount());
 
@@ -401,6 +509,17 @@ namespace {
             }
         }
 
+        {
+            const bool hasKey = SlotHasHotkey(cfg.bankCycleInput);
+            const auto label = std::format("{}  {}", IntegratedMagic::Strings::Get("List_BankCycle", "Bank Cycle"),
+                                           hasKey ? "*" : "-");
+            if (ImGuiMCP::Selectable(label.c_str(), g_selectedSlot == kBankCycleSlot) &&
+                (g_selectedSlot != kBankCycleSlot)) {
+                CancelFieldCapture();
+                g_selectedSlot = kBankCycleSlot;
+            }
+        }
+
         ImGuiMCP::EndChild();
         ImGuiMCP::SameLine();
 
@@ -409,12 +528,17 @@ namespace {
         if (g_selectedSlot == kHudPopupSlot) {
             DrawDetailPanel(cfg.hudPopupInput, IntegratedMagic::Strings::Get("Detail_HudPopup", "HUD Popup").c_str(),
                             dirty, cfg, false);
+        } else if (g_selectedSlot == kBankCycleSlot) {
+            DrawDetailPanel(cfg.bankCycleInput,
+                            IntegratedMagic::Strings::Get("Detail_BankCycle", "Bank Cycle").c_str(), dirty, cfg, false);
         } else if (g_selectedSlot >= 0 && g_selectedSlot < n) {
             const auto title = IntegratedMagic::Strings::Get(std::format("Detail_Magic{}", g_selectedSlot + 1),
                                                              std::format("Magic {}", g_selectedSlot + 1));
             DrawDetailPanel(cfg.slotInput[static_cast<std::size_t>(g_selectedSlot)], title.c_str(), dirty, cfg);
         }
 
+        DrawHotkeyConflicts();
+
         ImGuiMCP::EndChild();
     }
 
@@ -1368,6 +1492,123 @@ namespace {
                                                     "the slot.")
                           .c_str());
         }
+
+        if (bool v5 = cfg.speculativePreEquipPatch; ImGuiMCP::Checkbox(
+                IntegratedMagic::Strings::Get("Item_SpeculativePreEquip", "Pre-equip while confirming combo").c_str(),
+                &v5)) {
+            cfg.speculativePreEquipPatch = v5;
+            dirty = true;
+        }
+        if (ImGuiMCP::IsItemHovered()) {
+            ImGuiMCP::SetTooltip(
+                "%s", IntegratedMagic::Strings::Get("Tooltip_SpeculativePreEquip",
+                                                    "Starts equipping a multi-key slot's spells as soon as its full\n"
+                                                    "combo is held, while the combo is still being confirmed.\n"
+                                                    "The previous equipment is restored if the combo is cancelled.")
+                          .c_str());
+        }
+
+        if (bool v6 = cfg.adaptiveInputWindowsPatch; ImGuiMCP::Checkbox(
+                IntegratedMagic::Strings::Get("Item_AdaptiveInputWindows", "Adapt combo timing to my input").c_str(),
+                &v6)) {
+            cfg.adaptiveInputWindowsPatch = v6;
+            dirty = true;
+        }
+        if (ImGuiMCP::IsItemHovered()) {
+            ImGuiMCP::SetTooltip(
+                "%s", IntegratedMagic::Strings::Get("Tooltip_AdaptiveInputWindows",
+                                                    "Learns how quickly you press and release each multi-key combo\n"
+                                                    "and tunes the confirm and same-time windows per slot.\n"
+                                                    "Learned timings are kept in IntegratedMagic_ChordTiming.ini.")
+                          .c_str());
+        }
+
+        if (cfg.adaptiveInputWindowsPatch) {
+            int pct = cfg.adaptiveWindowPercentile;
+            ImGuiMCP::SetNextItemWidth(180.0f);
+            if (ImGuiMCP::InputInt(
+                    IntegratedMagic::Strings::Get("Item_AdaptiveWindowPercentile", "Timing percentile").c_str(), &pct,
+                    1, 5)) {
+                cfg.adaptiveWindowPercentile = std::clamp(pct, 50, 99);
+                dirty = true;
+            }
+            if (ImGuiMCP::IsItemHovered()) {
+                ImGuiMCP::SetTooltip(
+                    "%s", IntegratedMagic::Strings::Get("Tooltip_AdaptiveWindowPercentile",
+                                                        "Share of recorded combos the learned windows must cover.\n"
+                                                        "Higher values are more forgiving but react more slowly.")
+                              .c_str());
+            }
+        }
+    }
+
+    void DrawDiagnosticsTab(IntegratedMagic::MagicConfig& cfg, bool& dirty) {
+        namespace L = IntegratedMagic::Latency;
+        namespace S = IntegratedMagic::Strings;
+        namespace T = IntegratedMagic::Trace;
+
+        ImGuiMCP::SeparatorText(S::Get("Diag_Latency", "Hotkey to cast latency (ms since key down)").c_str());
+
+        if (const ImGuiMCP::ImGuiTableFlags kTableFlags =
+                ImGuiMCP::ImGuiTableFlags_BordersOuter | ImGuiMCP::ImGuiTableFlags_BordersInnerV |
+                ImGuiMCP::ImGuiTableFlags_RowBg | ImGuiMCP::ImGuiTableFlags_SizingFixedFit;
+            ImGuiMCP::BeginTable("##LatencyTable", 7, kTableFlags)) {
+            ImGuiMCP::TableSetupColumn(S::Get("Diag_Col_Stage", "Stage").c_str(),
+                                       ImGuiMCP::ImGuiTableColumnFlags_WidthFixed, 120.0f);
+            for (const char* col : {"Count", "Mean", "p50", "p90", "p99", "Max"})
+                ImGuiMCP::TableSetupColumn(col, ImGuiMCP::ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGuiMCP::TableHeadersRow();
+
+            for (std::size_t i = 0; i < L::kStageCount; ++i) {
+                const auto stage = static_cast<L::Stage>(i);
+                const auto sum = L::Summarize(stage);
+                ImGuiMCP::TableNextRow();
+                ImGuiMCP::TableSetColumnIndex(0);
+                ImGuiMCP::TextUnformatted(L::StageName(stage));
+                ImGuiMCP::TableSetColumnIndex(1);
+                ImGuiMCP::TextUnformatted(std::to_string(sum.count).c_str());
+                const std::array<std::uint64_t, 5> values{sum.meanUs, sum.p50Us, sum.p90Us, sum.p99Us, sum.maxUs};
+                for (std::size_t c = 0; c < values.size(); ++c) {
+                    ImGuiMCP::TableSetColumnIndex(static_cast<int>(c) + 2);
+                    const auto txt = sum.count ? std::format("{:.1f}", static_cast<double>(values[c]) / 1000.0) : "-";
+                    ImGuiMCP::TextUnformatted(txt.c_str());
+                }
+            }
+            ImGuiMCP::EndTable();
+        }
+
+        ImGuiMCP::Spacing();
+        if (ImGuiMCP::Button(S::Get("Diag_DumpLatency", "Dump to file").c_str())) {
+            (void)L::DumpToFile();
+        }
+        ImGuiMCP::SameLine();
+        if (ImGuiMCP::Button(S::Get("Diag_ResetLatency", "Reset").c_str())) {
+            L::Reset();
+        }
+
+        ImGuiMCP::SeparatorText(S::Get("Diag_FlightRecorder", "Flight recorder").c_str());
+        ImGuiMCP::TextDisabled("%s", S::Get("Diag_FlightRecorder_Tip",
+                                            "Last transitions of the magic state, saved automatically on forced exits.")
+                                         .c_str());
+        if (ImGuiMCP::Button(S::Get("Diag_DumpFlightRecorder", "Dump timeline").c_str())) {
+            (void)IntegratedMagic::FlightRecorder::Dump("Menu");
+        }
+
+        ImGuiMCP::SeparatorText(S::Get("Diag_Trace", "Trace categories").c_str());
+        for (std::size_t c = 0; c < T::kCategoryCount; ++c) {
+            const auto* name = T::CategoryName(static_cast<T::Category>(c));
+            const auto bit = 1u << c;
+            if (bool on = (cfg.traceCategories & bit) != 0;
+                ImGuiMCP::Checkbox(std::format("{}##trace{}", name, c).c_str(), &on)) {
+                cfg.traceCategories = on ? (cfg.traceCategories | bit) : (cfg.traceCategories & ~bit);
+                T::SetMask(cfg.traceCategories);
+                dirty = true;
+            }
+            if (c + 1 < T::kCategoryCount) ImGuiMCP::SameLine();
+        }
+        if (const auto dropped = T::DroppedCount(); dropped > 0)
+            ImGuiMCP::TextDisabled("%s", std::format("{} {}", dropped, S::Get("Diag_TraceDropped", "records dropped"))
+                                             .c_str());
     }
 }
 
@@ -1414,6 +1655,10 @@ void __stdcall IntegratedMagic::MENU::DrawSettings() {
             DrawPatchesTab(cfg, dirty);
             ImGuiMCP::EndTabItem();
         }
+        if (ImGuiMCP::BeginTabItem(IntegratedMagic::Strings::Get("Tab_Diagnostics", "Diagnostics").c_str())) {
+            DrawDiagnosticsTab(cfg, dirty);
+            ImGuiMCP::EndTabItem();
+        }
         ImGuiMCP::EndTabBar();
     }
 
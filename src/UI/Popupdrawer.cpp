@@ -12,6 +12,7 @@
 #include "PCH.h"
 #include "Persistence/SpellSettingsDB.h"
 #include "State/Assign.h"
+#include "State/FormTraits.h"
 #include "State/SpellClassify.h"
 #include "State/State.h"
 #include "UI/HoveredForm.h"
@@ -380,15 +381,15 @@ namespace IntegratedMagic::HUD::PopupDrawer {
                     const float slotTop = center.y - st.popupSlotRadius - iconReserve;
 
                     if (shoutID || slotIs2H) {
-                        auto* f = RE::TESForm::LookupByID(dispShoutID);
-                        const std::string name = f ? f->GetName() : "???";
-                        DrawWrappedLabelAbove(name.c_str(), center.x - st.popupSlotRadius, st.popupSlotRadius * 2.f,
-                                              slotTop, 4.f, true);
+                        const char* name = FormTraits::Get(dispShoutID).name;
+                        DrawWrappedLabelAbove(name ? name : "???", center.x - st.popupSlotRadius,
+                                              st.popupSlotRadius * 2.f, slotTop, 4.f, true);
                     } else if (rSp || lSp) {
                         const float halfWidth = st.popupSlotRadius;
                         if (lSp)
-                            DrawWrappedLabelAbove(lSp->GetName(), center.x - st.popupSlotRadius, halfWidth, slotTop);
-                        if (rSp) DrawWrappedLabelAbove(rSp->GetName(), center.x, halfWidth, slotTop);
+                            DrawWrappedLabelAbove(FormTraits::Get(lSp).name, center.x - st.popupSlotRadius, halfWidth,
+                                                  slotTop);
+                        if (rSp) DrawWrappedLabelAbove(FormTraits::Get(rSp).name, center.x, halfWidth, slotTop);
                     }
                 }
 
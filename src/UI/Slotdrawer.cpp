@@ -10,6 +10,7 @@
 #include "Config/Slots.h"
 #include "Input/Input.h"
 #include "PCH.h"
+#include "State/FormTraits.h"
 #include "State/SpellClassify.h"
 #include "State/State.h"
 #include "UI/HudState.h"
@@ -36,19 +37,19 @@ namespace IntegratedMagic::HUD::SlotDrawer {
             ImU32 glow;
         };
 
-        Palette SchoolPalette(RE::ActorValue av) {
+        Palette SchoolPalette(FormTraits::School school) {
             const auto& st = Style();
-            switch (av) {
-                using enum RE::ActorValue;
-                case kAlteration:
+            switch (school) {
+                using enum FormTraits::School;
+                case Alteration:
                     return {st.alterationFill, st.alterationGlow};
-                case kConjuration:
+                case Conjuration:
                     return {st.conjurationFill, st.conjurationGlow};
-                case kDestruction:
+                case Destruction:
                     return {st.destructionFill, st.destructionGlow};
-                case kIllusion:
+                case Illusion:
                     return {st.illusionFill, st.illusionGlow};
-                case kRestoration:
+                case Restoration:
                     return {st.restorationFill, st.restorationGlow};
                 default:
                     return {st.defaultFill, st.defaultGlow};
@@ -57,11 +58,12 @@ namespace IntegratedMagic::HUD::SlotDrawer {
 
         Palette SpellPalette(RE::SpellItem const* spell) {
             if (!spell) return {Style().emptyFill, IM_COL32(0, 0, 0, 0)};
-            const auto* fx = spell->GetCostliestEffectItem();
-            if (!fx || !fx->baseEffect) return SchoolPalette(RE::ActorValue::kNone);
-            auto av = fx->baseEffect->GetMagickSkill();
-            if (av == RE::ActorValue::kNone) av = fx->baseEffect->data.primaryAV;
-            return SchoolPalette(av);
+            return SchoolPalette(FormTraits::Get(spell).school);
+        }
+
+        const char* DisplayName(const RE::TESForm* form) {
+            const char* name = FormTraits::Get(form).name;
+            return name ? name : "";
         }
 
         inline float DynamicRingRadius(int n, float slotR, float baseR, float gap = 8.f) {
@@ -742,28 +744,27 @@ namespace IntegratedMagic::HUD::SlotDrawer {
                 const float slotTop = center.y - slotR - iconReserve;
 
                 if (shID || is2H) {
-                    const RE::FormID dispID = shID ? shID : lID;
-                    auto const* f = RE::TESForm::LookupByID(dispID);
-                    const char* name = f ? f->GetName() : "";
-                    DrawWrappedLabelAbove(name, center.x - slotR, slotR * 2.f, slotTop, 4.f, true);
+                    const char* name = FormTraits::Get(shID ? shID : lID).name;
+                    DrawWrappedLabelAbove(name ? name : "", center.x - slotR, slotR * 2.f, slotTop, 4.f, true);
                 } else if (rSp || lSp) {
                     const bool sameSpell = rSp && lSp && (rSp->GetFormID() == lSp->GetFormID());
                     const bool onlyOne = (rSp != nullptr) != (lSp != nullptr);
 
                     if (sameSpell || onlyOne) {
                         const RE::SpellItem* sp = rSp ? rSp : lSp;
-                        DrawWrappedLabelAbove(sp->GetName(), center.x - slotR, slotR * 2.f, slotTop, 4.f, true);
+                        DrawWrappedLabelAbove(DisplayName(sp), center.x - slotR, slotR * 2.f, slotTop, 4.f, true);
                     } else {
                         constexpr float kPipeGap = 6.f;
                         const float pipeW = ImGui::CalcTextSize("|").x;
                         const float halfPipe = pipeW * 0.5f;
 
-                        DrawWrappedLabelAbove(lSp->GetName(), center.x - slotR, slotR - halfPipe - kPipeGap, slotTop);
+                        DrawWrappedLabelAbove(DisplayName(lSp), center.x - slotR, slotR - halfPipe - kPipeGap,
+                                              slotTop);
 
                         const float pipeH = ImGui::GetTextLineHeight();
                         ImGui::SetCursorScreenPos({center.x - halfPipe, slotTop - 4.f - pipeH});
 
-                        DrawWrappedLabelAbove(rSp->GetName(), center.x + halfPipe + kPipeGap,
+                        DrawWrappedLabelAbove(DisplayName(rSp), center.x + halfPipe + kPipeGap,
                                               slotR - halfPipe - kPipeGap, slotTop);
                     }
                 }
@@ -103,13 +103,8 @@ namespace IntegratedMagic {
 
         if (auto it = formid_icons_.find(formID); it != formid_icons_.end()) return it->second;
 
-        auto* form = RE::TESForm::LookupByID(formID);
-        if (!form) return GetIcon(SpellIconType::spell_default);
-
-        if (form->As<RE::TESShout>()) return GetIcon(SpellIconType::shout);
-
-        if (auto const* spell = form->As<RE::SpellItem>()) return GetSpellIcon(spell);
-
+        const auto traits = FormTraits::Get(formID);
+        if (traits.IsShout() || traits.IsSpell()) return GetIcon(traits.icon);
         return GetIcon(SpellIconType::spell_default);
     }
 
@@ -227,45 +222,7 @@ namespace IntegratedMagic {
         return kEmpty;
     }
 
-    SpellIconType TextureManager::ClassifySpell(const RE::SpellItem* spell) {
-        using enum IntegratedMagic::SpellIconType;
-        if (!spell) return spell_default;
-
-        using SpellType = RE::MagicSystem::SpellType;
-        if (spell->GetSpellType() == SpellType::kLesserPower || spell->GetSpellType() == SpellType::kPower)
-            return power;
-        if (spell->GetSpellType() == SpellType::kVoicePower) return shout;
-
-        const auto* fx = spell->GetCostliestEffectItem();
-        if (!fx || !fx->baseEffect) return spell_default;
-
-        auto school = fx->baseEffect->GetMagickSkill();
-        if (school == RE::ActorValue::kNone) school = fx->baseEffect->data.primaryAV;
-
-        switch (school) {
-            using enum RE::ActorValue;
-
-            case kAlteration:
-                return alteration;
-            case kConjuration:
-                return conjuration;
-            case kIllusion:
-                return illusion;
-            case kRestoration:
-                return restoration;
-
-            case kDestruction: {
-                const auto resist = fx->baseEffect->data.resistVariable;
-                if (resist == RE::ActorValue::kResistFire) return destruction_fire;
-                if (resist == RE::ActorValue::kResistShock) return destruction_shock;
-                if (resist == RE::ActorValue::kResistFrost) return destruction_frost;
-                return destruction;
-            }
-
-            default:
-                return spell_default;
-        }
-    }
+    SpellIconType TextureManager::ClassifySpell(const RE::SpellItem* spell) { return FormTraits::Get(spell).icon; }
 
     bool TextureManager::LoadSVG(const char* path, Image& out, int targetSize) {
         auto* device = RE::BSGraphics::Renderer::GetDevice();
@@ -6,25 +6,11 @@
 #include <string>
 
 #include "PCH.h"
+#include "State/FormTraits.h"
 #include "StyleConfig.h"
 
 namespace IntegratedMagic {
 
-    enum class SpellIconType : std::int32_t {
-        spell_default = 0,
-        alteration,
-        conjuration,
-        illusion,
-        restoration,
-        destruction,
-        destruction_fire,
-        destruction_frost,
-        destruction_shock,
-        power,
-        shout,
-        total
-    };
-
     enum class UiTextureType : std::int32_t { slot_bg = 0, slot_bg_active = 1, slot_bg_empty = 2, total };
 
     constexpr int kGamepadButtonCount = 16;
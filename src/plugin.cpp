@@ -1,4 +1,5 @@
 #include "Config/Config.h"
+#include "Diagnostics/Trace.h"
 #include "Hooks.h"
 #include "Input/Input.h"
 #include "PCH.h"
@@ -6,6 +7,8 @@
 #include "Persistence/SpellSettingsDB.h"
 #include "State/CastGuardEvents.h"
 #include "State/EquipSink.h"
+#include "State/MenuState.h"
+#include "State/State.h"
 #include "UI/MENU.h"
 #include "UI/Strings.h"
 #include "UI/StyleConfig.h"
@@ -30,33 +33,50 @@ namespace {
         }
     }
 
-    IntegratedMagic::SaveSpellSlots ReadSlotsFromConfig() {
-        auto const& cfg = IntegratedMagic::GetMagicConfig();
+    IntegratedMagic::SaveSpellSlots ReadBankFromConfig(const IntegratedMagic::SlotBank& bank, std::uint32_t n) {
         IntegratedMagic::SaveSpellSlots s{};
-        const auto n = cfg.SlotCount();
         s.left.resize(n, 0u);
         s.right.resize(n, 0u);
         s.shout.resize(n, 0u);
         for (std::uint32_t i = 0; i < n; ++i) {
-            s.left[i] = cfg.slotSpellFormIDLeft[static_cast<std::size_t>(i)].load(std::memory_order_relaxed);
-            s.right[i] = cfg.slotSpellFormIDRight[static_cast<std::size_t>(i)].load(std::memory_order_relaxed);
-            s.shout[i] = cfg.slotShoutFormID[static_cast<std::size_t>(i)].load(std::memory_order_relaxed);
+            s.left[i] = bank.spellLeft[static_cast<std::size_t>(i)].load(std::memory_order_relaxed);
+            s.right[i] = bank.spellRight[static_cast<std::size_t>(i)].load(std::memory_order_relaxed);
+            s.shout[i] = bank.shout[static_cast<std::size_t>(i)].load(std::memory_order_relaxed);
         }
         return s;
     }
 
-    void ApplySlotsToConfig(const IntegratedMagic::SaveSpellSlots& s) {
-        auto& cfg = IntegratedMagic::GetMagicConfig();
+    IntegratedMagic::SaveSpellSlots ReadSlotsFromConfig() {
+        auto const& cfg = IntegratedMagic::GetMagicConfig();
         const auto n = cfg.SlotCount();
+        auto s = ReadBankFromConfig(cfg.banks[0], n);
+        for (std::uint32_t b = 1; b < cfg.BankCount(); ++b) s.extraBanks.push_back(ReadBankFromConfig(cfg.banks[b], n));
+        s.activeBank = cfg.ActiveBankIndex();
+        return s;
+    }
+
+    void ApplyBankToConfig(IntegratedMagic::SlotBank& bank, const IntegratedMagic::SaveSpellSlots& s,
+                           std::uint32_t n) {
         for (std::uint32_t i = 0; i < n; ++i) {
             const auto idx = static_cast<std::size_t>(i);
             const std::uint32_t l = (i < s.left.size()) ? s.left[i] : 0u;
             const std::uint32_t r = (i < s.right.size()) ? s.right[i] : 0u;
             const std::uint32_t sh = (i < s.shout.size()) ? s.shout[i] : 0u;
-            cfg.slotSpellFormIDLeft[idx].store(l, std::memory_order_relaxed);
-            cfg.slotSpellFormIDRight[idx].store(r, std::memory_order_relaxed);
-            cfg.slotShoutFormID[idx].store(sh, std::memory_order_relaxed);
+            bank.spellLeft[idx].store(l, std::memory_order_relaxed);
+            bank.spellRight[idx].store(r, std::memory_order_relaxed);
+            bank.shout[idx].store(sh, std::memory_order_relaxed);
+        }
+    }
+
+    void ApplySlotsToConfig(const IntegratedMagic::SaveSpellSlots& s) {
+        auto& cfg = IntegratedMagic::GetMagicConfig();
+        const auto n = cfg.SlotCount();
+        ApplyBankToConfig(cfg.banks[0], s, n);
+        for (std::uint32_t b = 1; b < IntegratedMagic::MagicConfig::kMaxBanks; ++b) {
+            const auto* src = (b - 1 < s.extraBanks.size()) ? &s.extraBanks[b - 1] : nullptr;
+            ApplyBankToConfig(cfg.banks[b], src ? *src : IntegratedMagic::SaveSpellSlots{}, n);
         }
+        if (!cfg.SetActiveBank(s.activeBank)) cfg.SetActiveBank(0);
     }
 
     std::string ExtractKey(std::string s) {
@@ -99,8 +119,10 @@ namespace {
             auto logger = std::make_shared<spdlog::logger>("global", sink);
             spdlog::set_default_logger(logger);
             spdlog::set_level(spdlog::level::info);
-            spdlog::flush_on(spdlog::level::info);
+            spdlog::flush_on(spdlog::level::warn);
+            spdlog::flush_every(std::chrono::seconds(1));
             spdlog::info("Logger iniciado.");
+            IntegratedMagic::Trace::Start();
         }
     }
 
@@ -116,8 +138,12 @@ namespace {
                 IntegratedMagic::GetMagicConfig().Load();
                 IntegratedMagic::SpellSettingsDB::Get().Load();
                 IntegratedMagic::MENU::Register();
+                Input::RegisterTimers();
+                Input::LoadChordTiming();
+                IntegratedMagic::MagicState::RegisterTimers();
                 Input::OnConfigChanged();
 
+                IntegratedMagic::MenuState::Register();
                 CastGuardEvents::Get().Register();
                 IntegratedMagic::EquipSink::RegisterEquipListener();
                 break;
@@ -134,6 +160,7 @@ namespace {
                     }
                 }
                 g_pendingEssPath.clear();
+                IntegratedMagic::GetMagicConfig().TouchSlots();
                 break;
             }
             case SKSE::MessagingInterface::kSaveGame: {
@@ -146,6 +173,7 @@ namespace {
                     IntegratedMagic::SaveSpellDB::Get().Upsert(key, ReadSlotsFromConfig());
                     IntegratedMagic::SaveSpellDB::Get().SaveToDisk();
                 }
+                Input::SaveChordTiming();
                 break;
             }
             case SKSE::MessagingInterface::kDeleteGame: {
@@ -0,0 +1,178 @@
+#include <array>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+#include "HostTests.h"
+#include "State/HandMachine.h"
+
+namespace IntegratedMagic::HostTests {
+    namespace {
+        using P = HandPhase;
+        using E = HandEvent;
+        using HandMachine::EventName;
+        using HandMachine::kEventCount;
+        using HandMachine::kPhaseCount;
+        using HandMachine::PhaseName;
+
+        // The phases MagicState::EnterHand puts a hand in; Idle is never re-entered.
+        constexpr std::array kEntryPhases{P::Hold, P::AutoCharging, P::Press, P::PressCharging};
+
+        struct Rule {
+            P from;
+            E on;
+            P to;
+        };
+
+        // Written from the cast flows rather than copied from BuildTable, so a table edit has to be made twice.
+        constexpr std::array kRules{
+            Rule{P::Hold, E::Released, P::Finished},
+            Rule{P::Hold, E::ReleasedCharged, P::HoldReleased},
+            Rule{P::HoldReleased, E::CastStop, P::Finished},
+            Rule{P::AutoCharging, E::ChargeComplete, P::AutoCharged},
+            Rule{P::AutoCharging, E::Interrupt, P::Finished},
+            Rule{P::AutoCharged, E::CastStop, P::Finished},
+            Rule{P::AutoCharged, E::SpellFire, P::Finished},
+            Rule{P::AutoCharged, E::Interrupt, P::Finished},
+            Rule{P::Press, E::Pressed, P::Finished},
+            Rule{P::PressCharging, E::Pressed, P::Finished},
+            Rule{P::PressCharging, E::ChargeComplete, P::PressCharged},
+            Rule{P::PressCharging, E::Interrupt, P::Finished},
+            Rule{P::PressCharged, E::Pressed, P::Finished},
+            Rule{P::PressCharged, E::CastStop, P::Press},
+            Rule{P::PressCharged, E::SpellFire, P::Press},
+            Rule{P::PressCharged, E::Interrupt, P::Finished},
+        };
+
+        P Expected(P from, E on) {
+            if (on == E::Timeout || on == E::Finish) return P::Finished;
+            for (const auto& r : kRules) {
+                if (r.from == from && r.on == on) return r.to;
+            }
+            return from;
+        }
+
+        bool IsGameEvent(E e) { return e != E::Timeout && e != E::Finish; }
+
+        int CheckTable() {
+            int failures = 0;
+            for (std::size_t p = 0; p < kPhaseCount; ++p) {
+                for (std::size_t e = 0; e < kEventCount; ++e) {
+                    const auto from = static_cast<P>(p);
+                    const auto on = static_cast<E>(e);
+                    const auto got = HandMachine::Next(from, on);
+                    if (got == Expected(from, on)) continue;
+                    std::fprintf(stderr, "hand_machine: %s --%s--> %s, expected %s\n", PhaseName(from), EventName(on),
+                                 PhaseName(got), PhaseName(Expected(from, on)));
+                    ++failures;
+                }
+            }
+            return failures;
+        }
+
+        // Shortest run of game events (no Timeout/Finish) that takes `from` to Finished, or empty if there is none.
+        std::vector<E> PathToFinished(P from) {
+            std::array<int, kPhaseCount> prevPhase{};
+            std::array<int, kPhaseCount> prevEvent{};
+            prevPhase.fill(-1);
+            prevPhase[static_cast<std::size_t>(from)] = static_cast<int>(from);
+            std::deque<P> open{from};
+            while (!open.empty()) {
+                const auto q = open.front();
+                open.pop_front();
+                if (q == P::Finished) break;
+                for (std::size_t e = 0; e < kEventCount; ++e) {
+                    const auto on = static_cast<E>(e);
+                    if (!IsGameEvent(on)) continue;
+                    const auto n = static_cast<std::size_t>(HandMachine::Next(q, on));
+                    if (prevPhase[n] != -1) continue;
+                    prevPhase[n] = static_cast<int>(q);
+                    prevEvent[n] = static_cast<int>(e);
+                    open.push_back(static_cast<P>(n));
+                }
+            }
+            std::vector<E> path;
+            auto at = static_cast<std::size_t>(P::Finished);
+            if (prevPhase[at] == -1) return path;
+            while (at != static_cast<std::size_t>(from)) {
+                path.insert(path.begin(), static_cast<E>(prevEvent[at]));
+                at = static_cast<std::size_t>(prevPhase[at]);
+            }
+            return path;
+        }
+
+        // Walks every event sequence up to `depth` from each entry phase. A hand must never fall back to Idle, must
+        // stay Finished once there, and must always keep a game-event path to Finished.
+        int CheckSequences(std::size_t depth, std::uint64_t& walked, std::array<bool, kPhaseCount>& reached) {
+            std::array<bool, kPhaseCount> canFinish{};
+            for (std::size_t p = 0; p < kPhaseCount; ++p)
+                canFinish[p] = static_cast<P>(p) == P::Finished || !PathToFinished(static_cast<P>(p)).empty();
+
+            int failures = 0;
+            std::vector<std::size_t> seq(depth, 0);
+            for (const auto entry : kEntryPhases) {
+                reached[static_cast<std::size_t>(entry)] = true;
+                for (bool more = true; more && failures < 10;) {
+                    ++walked;
+                    auto phase = entry;
+                    for (std::size_t i = 0; i < depth; ++i) {
+                        const auto next = HandMachine::Next(phase, static_cast<E>(seq[i]));
+                        reached[static_cast<std::size_t>(next)] = true;
+                        const char* broken = nullptr;
+                        if (next == P::Idle)
+                            broken = "fell back to Idle";
+                        else if (phase == P::Finished && next != P::Finished)
+                            broken = "left Finished";
+                        else if (!canFinish[static_cast<std::size_t>(next)])
+                            broken = "can no longer finish";
+                        if (broken) {
+                            std::fprintf(stderr, "hand_machine: %s", PhaseName(entry));
+                            for (std::size_t j = 0; j <= i; ++j)
+                                std::fprintf(stderr, " %s", EventName(static_cast<E>(seq[j])));
+                            std::fprintf(stderr, " -> %s %s\n", PhaseName(next), broken);
+                            ++failures;
+                            break;
+                        }
+                        phase = next;
+                    }
+                    more = false;
+                    for (std::size_t i = depth; i-- > 0;) {
+                        if (++seq[i] < kEventCount) {
+                            more = true;
+                            break;
+                        }
+                        seq[i] = 0;
+                    }
+                }
+            }
+            return failures;
+        }
+    }
+
+    // hand_machine [depth]: checks every (phase, event) pair of the hand transition table against an independent
+    // spec, then every event sequence up to depth from each entry phase.
+    int HandMachineCase(Args args) {
+        const auto depth = static_cast<std::size_t>(ArgOr(args, 0, 6));
+        int failures = CheckTable();
+
+        std::uint64_t walked = 0;
+        std::array<bool, kPhaseCount> reached{};
+        failures += CheckSequences(depth, walked, reached);
+
+        for (std::size_t p = 0; p < kPhaseCount; ++p) {
+            const auto phase = static_cast<P>(p);
+            if (phase == P::Idle) continue;
+            if (!reached[p]) {
+                std::fprintf(stderr, "hand_machine: %s is unreachable from the entry phases\n", PhaseName(phase));
+                ++failures;
+            }
+            if (phase == P::Finished) continue;
+            std::printf("hand_machine: %-13s finishes via", PhaseName(phase));
+            for (const auto e : PathToFinished(phase)) std::printf(" %s", EventName(e));
+            std::printf("\n");
+        }
+        std::printf("hand_machine: %zu pairs, %llu sequences of depth %zu, %d failure(s)\n", kPhaseCount * kEventCount,
+                    static_cast<unsigned long long>(walked), depth, failures);
+        return failures == 0 ? 0 : 1;
+    }
+}
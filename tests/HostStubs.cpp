@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+
+#include "Config/Config.h"
+#include "Config/Slots.h"
+#include "Input/ChordTiming.h"
+#include "Input/HotkeyCache.h"
+#include "PCH.h"
+#include "State/MenuState.h"
+
+namespace IntegratedMagic {
+    MagicConfig::MagicConfig() = default;
+
+    std::uint32_t MagicConfig::SlotCount() const noexcept {
+        return std::clamp(slotCount.load(std::memory_order_relaxed), 1u, kMaxSlots);
+    }
+
+    std::uint32_t MagicConfig::BankCount() const noexcept {
+        return std::clamp(bankCount.load(std::memory_order_relaxed), 1u, kMaxBanks);
+    }
+
+    std::uint32_t MagicConfig::ActiveBankIndex() const noexcept {
+        return static_cast<std::uint32_t>(&Bank() - banks.data());
+    }
+
+    MagicConfig& GetMagicConfig() {
+        static MagicConfig g{};
+        return g;
+    }
+
+    // The magic menu blocks input, so the host never has it open while filtering.
+    bool MenuState::IsMagicMenuOpen() { return false; }
+
+    // Banks only swap spells, which the input core never reads.
+    void Slots::CycleBank(int) {}
+}
+
+RE::ButtonEvent* RE::ButtonEvent::Create(INPUT_DEVICE a_device, const BSFixedString& a_userEvent,
+                                         std::uint32_t a_idCode, float a_value, float a_heldDownSecs) {
+    auto* ev = static_cast<ButtonEvent*>(std::malloc(sizeof(ButtonEvent)));
+    if (!ev) return nullptr;
+    std::construct_at(ev);
+    ev->device = a_device;
+    ev->eventType = INPUT_EVENT_TYPE::kButton;
+    ev->userEvent = a_userEvent;
+    ev->idCode = a_idCode;
+    ev->value = a_value;
+    ev->heldDownSecs = a_heldDownSecs;
+    return ev;
+}
+
+namespace Input::detail {
+    // No ControlMap on the host; the replay traces only exercise the plugin's own bindings.
+    KeyMask GameControlKeys(bool) { return {}; }
+
+    void ObserveChordTiming(std::size_t, std::uint64_t, std::uint64_t, bool, std::chrono::steady_clock::time_point) {}
+
+    float ConfirmWindowSec(std::size_t, PendingSrc) { return kExclusiveConfirmDelaySec; }
+
+    float SimWindowSec(std::size_t, PendingSrc) { return kExclusiveConfirmDelaySec; }
+}
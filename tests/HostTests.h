@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <string_view>
+
+namespace IntegratedMagic::HostTests {
+
+    using Args = std::span<char* const>;
+
+    [[nodiscard]] inline std::uint64_t ArgOr(Args args, std::size_t i, std::uint64_t fallback) {
+        return i < args.size() ? std::strtoull(args[i], nullptr, 0) : fallback;
+    }
+
+    int HandMachineCase(Args args);
+    int InputFuzz(Args args);
+    int InputReplay(Args args);
+    int SlotEdges(Args args);
+    int SyntheticRing(Args args);
+}
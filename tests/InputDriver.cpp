@@ -0,0 +1,111 @@
+#include "InputDriver.h"
+
+#include "Input/ChordMachine.h"
+#include "Input/ExclusivePending.h"
+#include "Input/HotkeyCache.h"
+#include "Input/HudToggle.h"
+#include "Input/InputState.h"
+#include "Input/ReplaySystem.h"
+#include "State/SyntheticInput.h"
+#include "State/Timers.h"
+
+namespace IntegratedMagic::Host {
+    namespace {
+        using namespace Input::detail;
+
+        void UpdateDownState(const Button& ev) {
+            const bool down = ev.IsDown();
+            if (ev.dev == RE::INPUT_DEVICE::kGamepad) {
+                if (g_gpDown.Store(ev.code, down)) StepChordMachine(RE::INPUT_DEVICE::kGamepad, ev.code, down);
+                return;
+            }
+            const int code = (ev.dev == RE::INPUT_DEVICE::kMouse) ? kMouseButtonBase + ev.code : ev.code;
+            if (g_kbDown.Store(code, down)) StepChordMachine(RE::INPUT_DEVICE::kKeyboard, code, down);
+        }
+
+        bool g_prevBlocked = false;
+    }
+
+    void ResetInput() {
+        static const bool registered = [] {
+            RegisterExclusiveTimers();
+            RegisterChordTimers();
+            return true;
+        }();
+        (void)registered;
+        LoadHotkeyCache_FromConfig();
+        ResetExclusiveState();
+        g_prevBlocked = false;
+    }
+
+    void RunFrame(float dt, std::span<const Button> events, FrameOutput& out, bool blocked) {
+        out.toEngine.clear();
+        out.kept.assign(events.size(), 1);
+        out.retained = 0;
+
+        DrainDeferredReplayEvents();
+
+        IntegratedMagic::Timers::Advance(blocked ? 0.f : dt);
+
+        if (g_prevBlocked && !blocked) ClearLikelyStuckKeysAfterMenuClose();
+        if (!g_prevBlocked && blocked) {
+            for (int i = 0; i < ActiveSlots(); ++i) DiscardExclusivePending(static_cast<std::size_t>(i));
+        }
+        g_prevBlocked = blocked;
+
+        for (const auto& ev : events) {
+            if (ev.IsDown() || ev.IsUp()) UpdateDownState(ev);
+        }
+        UpdateHudToggleState();
+        UpdateBankCycleState(blocked);
+
+        if (blocked) {
+            g_pressedMask.store(0, std::memory_order_relaxed);
+        } else {
+            RecomputeSlotEdges();
+        }
+
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            const auto& ev = events[i];
+            if (ev.preFiltered) {
+                out.kept[i] = 0;
+                continue;
+            }
+            const auto before = RetainedOutstanding();
+            if (!blocked && ev.code >= 0 && ev.code < kMaxCode &&
+                (ShouldFilterAndSave(ev.dev, ev.code, ev.rawIdCode, ev.userEvent, ev.value, ev.heldSecs) ||
+                 ShouldFilterHudToggle(ev.dev, ev.code) || ShouldFilterBankCycle(ev.dev, ev.code))) {
+                out.retained += RetainedOutstanding() - before;
+                out.kept[i] = 0;
+                continue;
+            }
+            out.toEngine.push_back(ev);
+        }
+
+        for (int i = 0; i < ActiveSlots(); ++i) {
+            const auto s = static_cast<std::size_t>(i);
+            if (g_replay[s].Armed() && !HasDeferredReplayForSlot(s)) ResetReplayState(s);
+        }
+
+        out.pressed = g_pressedMask.exchange(0, std::memory_order_relaxed);
+        out.released = g_releasedMask.exchange(0, std::memory_order_relaxed);
+        SettlePreEquip();
+
+        std::vector<Button> replayed;
+        for (auto* e = IntegratedMagic::detail::FlushSyntheticInput(nullptr); e; e = e->next) {
+            if (const auto* btn = e->AsButtonEvent()) {
+                replayed.push_back({btn->GetDevice(), -1, btn->GetIDCode(), btn->QUserEvent(), btn->Value(),
+                                    btn->HeldDuration()});
+            }
+        }
+        IntegratedMagic::detail::RecycleSyntheticInput();
+        out.replayed = replayed.size();
+        out.toEngine.insert(out.toEngine.begin(), replayed.begin(), replayed.end());
+    }
+
+    std::size_t RetainedOutstanding() {
+        std::size_t n = g_deferred.count;
+        for (const auto& buf : g_retainedEvents) n += buf.size();
+        return n;
+    }
+}
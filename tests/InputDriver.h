@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "PCH.h"
+
+namespace IntegratedMagic::Host {
+
+    struct Button {
+        RE::INPUT_DEVICE dev{RE::INPUT_DEVICE::kKeyboard};
+        int code{0};
+        std::uint32_t rawIdCode{0};
+        RE::BSFixedString userEvent{};
+        float value{0.f};
+        float heldSecs{0.f};
+        // Removed before FilterEvents (by the detail popup), so only its down state is tracked.
+        bool preFiltered{false};
+
+        [[nodiscard]] bool IsDown() const noexcept { return value > 0.f && heldSecs == 0.f; }
+        [[nodiscard]] bool IsUp() const noexcept { return value == 0.f && heldSecs > 0.f; }
+    };
+
+    struct FrameOutput {
+        std::vector<Button> toEngine;
+        std::vector<std::uint8_t> kept;
+        std::uint64_t pressed{0};
+        std::uint64_t released{0};
+        std::size_t retained{0};
+        std::size_t replayed{0};
+    };
+
+    // Reloads the hotkey cache from GetMagicConfig() and clears all edge, pending and replay state, like
+    // Input::OnConfigChanged. Registers the input timers on first use.
+    void ResetInput();
+
+    // One input poll, in the same order as Input::ProcessAndFilter followed by FlushSyntheticInput. Replayed events
+    // lead toEngine, followed by the events the filter let through; kept[i] tells whether events[i] was one of them.
+    void RunFrame(float dt, std::span<const Button> events, FrameOutput& out, bool blocked = false);
+
+    [[nodiscard]] std::size_t RetainedOutstanding();
+}
@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Config/Config.h"
+#include "Diagnostics/Trace.h"
+#include "HostTests.h"
+#include "Input/ExclusivePending.h"
+#include "Input/HotkeyCache.h"
+#include "Input/InputState.h"
+#include "InputDriver.h"
+#include "PCH.h"
+
+namespace IntegratedMagic::HostTests {
+    namespace {
+        using Host::Button;
+
+        constexpr float kFrameSec = 1.f / 60.f;
+        constexpr float kSettleSec = 1.f;
+
+        struct Key {
+            RE::INPUT_DEVICE dev;
+            int code;
+            std::uint32_t raw;
+            RE::BSFixedString userEvent;
+        };
+
+        std::vector<Key> MakeKeys() {
+            std::vector<Key> keys;
+            for (int code : {0x02, 0x03, 0x10, kDIK_W, 0x12, kDIK_A, 0x1D, 0x2A, 0x38})
+                keys.push_back({RE::INPUT_DEVICE::kKeyboard, code, static_cast<std::uint32_t>(code),
+                                std::format("Kb{:#04x}", code)});
+            for (int btn : {0, 1})
+                keys.push_back(
+                    {RE::INPUT_DEVICE::kMouse, btn, static_cast<std::uint32_t>(btn), std::format("Mouse{}", btn)});
+            for (int idx : {8, 9, 10, 11, 12, 14, 15})
+                keys.push_back({RE::INPUT_DEVICE::kGamepad, idx, 1u << idx, std::format("Pad{}", idx)});
+            return keys;
+        }
+
+        int CacheCode(const Key& k) { return k.dev == RE::INPUT_DEVICE::kMouse ? kMouseButtonBase + k.code : k.code; }
+
+        class Fuzzer {
+        public:
+            explicit Fuzzer(std::uint64_t seed) : _rng(seed), _keys(MakeKeys()) {
+                _held.assign(_keys.size(), -1.f);
+                _engineDown.assign(_keys.size(), false);
+            }
+
+            void Randomize() {
+                auto& cfg = GetMagicConfig();
+                const int n = Pick(1, 6);
+                cfg.slotCount.store(static_cast<std::uint32_t>(n), std::memory_order_relaxed);
+                cfg.requireExclusiveHotkeyPatch = Chance(0.5);
+                cfg.pressBothAtSamePatch = Chance(0.5);
+                cfg.speculativePreEquipPatch = Chance(0.3);
+
+                std::vector<int> kbPool;
+                std::vector<int> gpPool;
+                for (const auto& k : _keys)
+                    (k.dev == RE::INPUT_DEVICE::kGamepad ? gpPool : kbPool).push_back(CacheCode(k));
+
+                for (std::size_t s = 0; s < MagicConfig::kMaxSlots; ++s) {
+                    auto& in = cfg.slotInput[s];
+                    std::array<int, 3> kb{-1, -1, -1};
+                    std::array<int, 3> gp{-1, -1, -1};
+                    auto trigger = HotkeyTrigger::Chord;
+                    if (s < static_cast<std::size_t>(n)) {
+                        Draw(kbPool, kb);
+                        Draw(gpPool, gp);
+                        if (Chance(0.3)) trigger = static_cast<HotkeyTrigger>(Pick(1, 3));
+                    }
+                    in.KeyboardScanCode1 = kb[0];
+                    in.KeyboardScanCode2 = kb[1];
+                    in.KeyboardScanCode3 = kb[2];
+                    in.GamepadButton1 = gp[0];
+                    in.GamepadButton2 = gp[1];
+                    in.GamepadButton3 = gp[2];
+                    in.Trigger = static_cast<int>(trigger);
+                }
+
+                cfg.modifierKeyboardPosition = Chance(0.3) ? Pick(1, 3) : 0;
+                cfg.modifierGamepadPosition = Chance(0.3) ? Pick(1, 3) : 0;
+                Propagate(cfg.modifierKeyboardPosition, kKbFields, n);
+                Propagate(cfg.modifierGamepadPosition, kGpFields, n);
+
+                Host::ResetInput();
+                _bound.clear();
+                for (std::size_t i = 0; i < _keys.size(); ++i) {
+                    const auto& bySlot = _keys[i].dev == RE::INPUT_DEVICE::kGamepad ? g_gpSlotsByCode : g_kbSlotsByCode;
+                    if (bySlot[static_cast<std::size_t>(CacheCode(_keys[i]))] & ActiveSlotMask()) _bound.push_back(i);
+                }
+                _comboSeen = 0;
+            }
+
+            bool Run(std::uint64_t frames) {
+                Randomize();
+                std::uint64_t untilSettle = Pick(30, 300);
+                for (std::uint64_t f = 0; f < frames; ++f) {
+                    if (--untilSettle == 0) {
+                        if (!Settle()) return false;
+                        if (Chance(0.25)) Randomize();
+                        untilSettle = Pick(30, 300);
+                        continue;
+                    }
+                    GenerateFrame();
+                    if (!Step(NextDt())) return false;
+                }
+                return Settle();
+            }
+
+            void Report(double secs) const {
+                std::printf("input_fuzz: frames=%llu events=%llu retained=%llu replayed=%llu dropped=%llu "
+                            "settles=%llu\n",
+                            ull(_frames), ull(_events), ull(_retained), ull(_replayed), ull(_retained - _replayed),
+                            ull(_settles));
+                std::printf("input_fuzz: %.3fs in the input core, %.0f events/s, %.0f frames/s\n", secs,
+                            static_cast<double>(_events) / secs, static_cast<double>(_frames) / secs);
+            }
+
+            [[nodiscard]] double CoreSeconds() const { return _coreSecs; }
+
+        private:
+            static unsigned long long ull(std::uint64_t v) { return static_cast<unsigned long long>(v); }
+
+            int Pick(int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(_rng); }
+            bool Chance(double p) { return std::bernoulli_distribution(p)(_rng); }
+
+            void Draw(std::vector<int> pool, std::array<int, 3>& out) {
+                static constexpr std::array<double, 4> kWeights{0.15, 0.35, 0.35, 0.15};
+                const auto n = std::discrete_distribution<int>(kWeights.begin(), kWeights.end())(_rng);
+                std::ranges::shuffle(pool, _rng);
+                for (int i = 0; i < n; ++i) out[static_cast<std::size_t>(i)] = pool[static_cast<std::size_t>(i)];
+            }
+
+            using Field = std::atomic<int> InputConfig::*;
+            static constexpr std::array<Field, 3> kKbFields{&InputConfig::KeyboardScanCode1,
+                                                            &InputConfig::KeyboardScanCode2,
+                                                            &InputConfig::KeyboardScanCode3};
+            static constexpr std::array<Field, 3> kGpFields{&InputConfig::GamepadButton1, &InputConfig::GamepadButton2,
+                                                            &InputConfig::GamepadButton3};
+
+            static void Propagate(int pos, const std::array<Field, 3>& fields, int n) {
+                if (pos <= 0) return;
+                auto& cfg = GetMagicConfig();
+                const auto field = fields[static_cast<std::size_t>(pos - 1)];
+                const int canonical = (cfg.slotInput[0].*field).load(std::memory_order_relaxed);
+                for (int s = 1; s < n; ++s)
+                    (cfg.slotInput[static_cast<std::size_t>(s)].*field).store(canonical, std::memory_order_relaxed);
+            }
+
+            float NextDt() {
+                if (Chance(0.01)) return 0.25f;
+                return std::uniform_real_distribution<float>(1.f / 240.f, 1.f / 20.f)(_rng);
+            }
+
+            void Toggle(std::size_t i) {
+                const auto& k = _keys[i];
+                if (_held[i] < 0.f) {
+                    _frame.push_back({k.dev, k.code, k.raw, k.userEvent, 1.f, 0.f});
+                    _held[i] = 0.f;
+                } else {
+                    _frame.push_back({k.dev, k.code, k.raw, k.userEvent, 0.f, std::max(_held[i], 0.001f)});
+                    _held[i] = -1.f;
+                }
+            }
+
+            void GenerateFrame() {
+                _frame.clear();
+                for (std::size_t i = 0; i < _keys.size(); ++i) {
+                    const auto& k = _keys[i];
+                    if (_held[i] > 0.f) _frame.push_back({k.dev, k.code, k.raw, k.userEvent, 1.f, _held[i]});
+                }
+                const int toggles = std::discrete_distribution<int>({0.55, 0.3, 0.12, 0.03})(_rng);
+                for (int t = 0; t < toggles; ++t) {
+                    const bool bound = !_bound.empty() && Chance(0.85);
+                    Toggle(bound ? _bound[static_cast<std::size_t>(Pick(0, static_cast<int>(_bound.size()) - 1))]
+                                 : static_cast<std::size_t>(Pick(0, static_cast<int>(_keys.size()) - 1)));
+                }
+            }
+
+            std::size_t KeyIndex(RE::INPUT_DEVICE dev, std::uint32_t raw) const {
+                for (std::size_t i = 0; i < _keys.size(); ++i)
+                    if (_keys[i].dev == dev && _keys[i].raw == raw) return i;
+                return _keys.size();
+            }
+
+            bool Fail(const std::string& what) {
+                if (Trace::Mask() != 0) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                std::fprintf(stderr, "input_fuzz: frame %llu: %s\n", ull(_frames), what.c_str());
+                return false;
+            }
+
+            bool Step(float dt) {
+                using namespace Input::detail;
+                const int n = ActiveSlots();
+                for (const auto& ev : _frame) {
+                    if (!ev.IsDown() && !ev.IsUp()) continue;
+                    (ev.dev == RE::INPUT_DEVICE::kGamepad ? _padDown : _kbDown)
+                        .Store(CacheCode(_keys[KeyIndex(ev.dev, ev.rawIdCode)]), ev.IsDown());
+                    for (int slot = 0; slot < n; ++slot) {
+                        const auto& hk = g_cache[static_cast<std::size_t>(slot)];
+                        if (ComboDown(hk.kbMask, _kbDown) || ComboDown(hk.gpMask, _padDown)) _comboSeen |= 1uLL << slot;
+                    }
+                }
+
+                const auto warnings = spdlog::host::g_warnings.load();
+                const auto retainedOverflow = RetainedOverflowCount();
+                const auto t0 = std::chrono::steady_clock::now();
+                Host::RunFrame(dt, _frame, _out);
+                _coreSecs += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                ++_frames;
+                _events += _frame.size();
+                _retained += _out.retained;
+                _replayed += _out.replayed;
+
+                for (std::size_t i = 0; i < _keys.size(); ++i) {
+                    if (_held[i] >= 0.f) _held[i] += dt;
+                }
+                for (const auto& ev : _out.toEngine) {
+                    if (const auto i = KeyIndex(ev.dev, ev.rawIdCode); i < _keys.size())
+                        _engineDown[i] = ev.value > 0.f;
+                }
+
+                if (spdlog::host::g_warnings.load() != warnings) return Fail("input core logged a warning");
+                if (RetainedOverflowCount() != retainedOverflow) return Fail("a retained buffer overflowed");
+                for (std::size_t i = 0; i < _keys.size(); ++i) {
+                    if (EngineDownState(_keys[i].dev).Test(CacheCode(_keys[i])) != _engineDown[i])
+                        return Fail(std::format("input core lost track of whether the engine holds {}",
+                                                _keys[i].userEvent.c_str()));
+                }
+
+                for (auto p = _out.pressed; p; p &= p - 1) {
+                    const int slot = std::countr_zero(p);
+                    if (!(_comboSeen & (1uLL << slot)))
+                        return Fail(std::format("slot {} accepted without its combo ever fully down", slot));
+                }
+                for (int slot = 0; slot < n; ++slot) {
+                    const auto s = static_cast<std::size_t>(slot);
+                    const auto& hk = g_cache[s];
+                    const bool anyKey = AnyComboKeyDown(hk.kbMask, _kbDown) || AnyComboKeyDown(hk.gpMask, _padDown);
+                    const bool live = IsSlotDown(s) || g_slots[s].pendingSrc != PendingSrc::None;
+                    if (!anyKey && !live) _comboSeen &= ~(1uLL << slot);
+                }
+                return true;
+            }
+
+            bool Settle() {
+                using namespace Input::detail;
+                _frame.clear();
+                for (std::size_t i = 0; i < _keys.size(); ++i) {
+                    if (_held[i] >= 0.f) Toggle(i);
+                }
+                if (!Step(kFrameSec)) return false;
+                _frame.clear();
+                for (float t = 0.f; t < kSettleSec; t += kFrameSec) {
+                    if (!Step(kFrameSec)) return false;
+                }
+                ++_settles;
+
+                if (const auto down = g_slotDown.load(std::memory_order_relaxed))
+                    return Fail(std::format("g_slotDown={:#x} stuck after every key was released", down));
+                for (int slot = 0; slot < kMaxSlots; ++slot) {
+                    const auto s = static_cast<std::size_t>(slot);
+                    if (g_slots[s].pendingSrc != PendingSrc::None)
+                        return Fail(std::format("slot {} still has an exclusive pending", slot));
+                    if (g_replay[s].Armed()) return Fail(std::format("slot {} still expects a replay", slot));
+                }
+                if (const auto left = Host::RetainedOutstanding())
+                    return Fail(std::format("{} retained event(s) neither replayed nor dropped", left));
+                for (std::size_t i = 0; i < _keys.size(); ++i) {
+                    if (_engineDown[i])
+                        return Fail(
+                            std::format("engine still sees {} held after its release", _keys[i].userEvent.c_str()));
+                }
+                return true;
+            }
+
+            std::mt19937_64 _rng;
+            std::vector<Key> _keys;
+            std::vector<std::size_t> _bound;
+            std::vector<float> _held;
+            std::vector<bool> _engineDown;
+            KeyDownState _kbDown;
+            KeyDownState _padDown;
+            std::vector<Button> _frame;
+            Host::FrameOutput _out;
+            std::uint64_t _comboSeen{0};
+            std::uint64_t _frames{0};
+            std::uint64_t _events{0};
+            std::uint64_t _retained{0};
+            std::uint64_t _replayed{0};
+            std::uint64_t _settles{0};
+            double _coreSecs{0.0};
+        };
+    }
+
+    int InputFuzz(Args args) {
+        const auto frames = ArgOr(args, 0, 200'000);
+        const auto seed = ArgOr(args, 1, 0x1A11'5EED);
+        if (ArgOr(args, 2, 0) != 0) {
+            spdlog::host::g_verbose = true;
+            Trace::SetMask(0xFFFF'FFFFu);
+            Trace::Start();
+        }
+        std::printf("input_fuzz: seed=%#llx frames=%llu\n", static_cast<unsigned long long>(seed),
+                    static_cast<unsigned long long>(frames));
+        Fuzzer fuzz(seed);
+        const bool ok = fuzz.Run(frames);
+        fuzz.Report(fuzz.CoreSeconds());
+        return ok ? 0 : 1;
+    }
+}
@@ -0,0 +1,391 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Config/Config.h"
+#include "Config/ConfigPath.h"
+#include "HostTests.h"
+#include "Input/InputState.h"
+#include "Input/InputTrace.h"
+#include "Input/InputTraceFormat.h"
+#include "InputDriver.h"
+#include "PCH.h"
+
+namespace IntegratedMagic::HostTests {
+    namespace {
+        namespace Fmt = Input::detail::TraceFormat;
+        using Key = RE::BSWin32GamepadDevice::Key;
+
+        struct TraceEvent {
+            Fmt::EventType type{Fmt::EventType::Button};
+            RE::INPUT_DEVICE dev{RE::INPUT_DEVICE::kKeyboard};
+            bool kept{false};
+            std::uint32_t idCode{0};
+            float a{0.f};
+            float b{0.f};
+            std::string userEvent;
+        };
+
+        class TraceReader {
+        public:
+            explicit TraceReader(const std::filesystem::path& path) : _in(path, std::ios::binary) {}
+
+            [[nodiscard]] bool Open() {
+                char magic[4]{};
+                std::uint16_t version = 0;
+                if (!_in.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, Fmt::kMagic) || !Get(version))
+                    return Fail("not an input trace");
+                if (version != Fmt::kVersion) return Fail("unsupported trace version");
+                return true;
+            }
+
+            // Returns the next record tag, or 0 at the end of the trace.
+            [[nodiscard]] std::uint8_t NextTag() {
+                std::uint8_t tag = 0;
+                return Get(tag) ? tag : 0;
+            }
+
+            [[nodiscard]] bool ReadConfig(MagicConfig& cfg) {
+                std::uint8_t slots = 0;
+                std::uint8_t patches = 0;
+                std::int8_t modKb = 0;
+                std::int8_t modGp = 0;
+                if (!Get(slots) || !Get(patches) || !Get(modKb) || !Get(modGp)) return Fail("truncated config");
+                if (slots < 1 || slots > MagicConfig::kMaxSlots) return Fail("bad slot count");
+
+                cfg.slotCount.store(slots, std::memory_order_relaxed);
+                cfg.requireExclusiveHotkeyPatch = (patches & Fmt::kRequireExclusiveHotkey) != 0;
+                cfg.pressBothAtSamePatch = (patches & Fmt::kPressBothAtSame) != 0;
+                cfg.speculativePreEquipPatch = (patches & Fmt::kSpeculativePreEquip) != 0;
+                cfg.adaptiveInputWindowsPatch = (patches & Fmt::kAdaptiveInputWindows) != 0;
+                cfg.modifierKeyboardPosition = modKb;
+                cfg.modifierGamepadPosition = modGp;
+                for (std::size_t s = 0; s < slots; ++s) {
+                    if (!ReadInput(cfg.slotInput[s])) return false;
+                }
+                return ReadInput(cfg.hudPopupInput) && ReadInput(cfg.bankCycleInput);
+            }
+
+            [[nodiscard]] bool ReadFrame(float& dt, std::uint8_t& flags, std::vector<TraceEvent>& events) {
+                std::uint16_t count = 0;
+                if (!Get(dt) || !Get(flags) || !Get(count)) return Fail("truncated frame");
+                events.resize(count);
+                for (auto& ev : events) {
+                    std::uint8_t type = 0;
+                    std::uint8_t dev = 0;
+                    std::uint8_t kept = 0;
+                    std::uint8_t len = 0;
+                    if (!Get(type) || !Get(dev) || !Get(kept) || !Get(ev.idCode) || !Get(ev.a) || !Get(ev.b) ||
+                        !Get(len))
+                        return Fail("truncated event");
+                    ev.type = static_cast<Fmt::EventType>(type);
+                    ev.dev = static_cast<RE::INPUT_DEVICE>(dev);
+                    ev.kept = kept != 0;
+                    ev.userEvent.resize(len);
+                    if (!_in.read(ev.userEvent.data(), len)) return Fail("truncated user event");
+                }
+                return true;
+            }
+
+        private:
+            template <class T>
+            bool Get(T& v) {
+                return static_cast<bool>(_in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+            }
+
+            bool ReadInput(InputConfig& in) {
+                for (auto* field : {&in.KeyboardScanCode1, &in.KeyboardScanCode2, &in.KeyboardScanCode3,
+                                    &in.GamepadButton1, &in.GamepadButton2, &in.GamepadButton3, &in.Trigger}) {
+                    std::int32_t v = 0;
+                    if (!Get(v)) return Fail("truncated hotkey");
+                    field->store(v, std::memory_order_relaxed);
+                }
+                return true;
+            }
+
+            static bool Fail(const char* what) {
+                std::fprintf(stderr, "input_replay: %s\n", what);
+                return false;
+            }
+
+            std::ifstream _in;
+        };
+
+        // Mirrors FilterMouseForPopup: pointer motion and the popup's click/close buttons never reach FilterEvents.
+        bool ConsumedByPopup(Fmt::EventType type, RE::INPUT_DEVICE dev, std::uint32_t idCode) {
+            if (type != Fmt::EventType::Button) return true;
+            if (dev == RE::INPUT_DEVICE::kMouse) return idCode == 0 || idCode == 1;
+            if (dev != RE::INPUT_DEVICE::kGamepad) return false;
+            return idCode == static_cast<std::uint32_t>(Key::kX) || idCode == static_cast<std::uint32_t>(Key::kB) ||
+                   idCode == static_cast<std::uint32_t>(Key::kY);
+        }
+
+        // Whether ProcessAndFilter leaves an event in the chain, given the decision of the filters modelled by
+        // Host::RunFrame.
+        bool Survives(Fmt::EventType type, std::uint8_t flags, bool filterKept) {
+            const bool blocked = (flags & Fmt::kBlockedByMenus) != 0;
+            if (type != Fmt::EventType::Button) return (flags & Fmt::kDetailPopupOpen) == 0;
+            return filterKept && !((flags & Fmt::kHotkeyCapture) && !blocked);
+        }
+
+        Host::Button ToButton(RE::INPUT_DEVICE dev, std::uint32_t idCode, std::string_view userEvent, float value,
+                              float heldSecs, std::uint8_t flags) {
+            const int raw = static_cast<int>(idCode);
+            const bool popup = (flags & Fmt::kDetailPopupOpen) && ConsumedByPopup(Fmt::EventType::Button, dev, idCode);
+            const int code = dev == RE::INPUT_DEVICE::kGamepad ? GamepadIdToIndex(raw) : raw;
+            return {dev, code, idCode, userEvent, value, heldSecs, popup};
+        }
+
+        struct ReplayReport {
+            std::uint64_t frames{0};
+            std::uint64_t events{0};
+            std::uint64_t dropped{0};
+            std::uint64_t mismatches{0};
+            std::vector<double> frameUs;
+        };
+
+        bool Replay(const std::filesystem::path& path, ReplayReport& report) {
+            TraceReader in(path);
+            if (!in.Open()) return false;
+
+            std::vector<TraceEvent> events;
+            std::vector<Host::Button> buttons;
+            std::vector<std::size_t> buttonIndex;
+            Host::FrameOutput out;
+            bool configured = false;
+            for (auto tag = in.NextTag(); tag != 0; tag = in.NextTag()) {
+                if (tag == Fmt::kConfigTag) {
+                    if (!in.ReadConfig(GetMagicConfig())) return false;
+                    Host::ResetInput();
+                    configured = true;
+                    continue;
+                }
+                float dt = 0.f;
+                std::uint8_t flags = 0;
+                if (tag != Fmt::kFrameTag || !in.ReadFrame(dt, flags, events)) {
+                    std::fprintf(stderr, "input_replay: bad record at frame %llu\n",
+                                 static_cast<unsigned long long>(report.frames));
+                    return false;
+                }
+                if (!configured) {
+                    std::fprintf(stderr, "input_replay: frame before the first config record\n");
+                    return false;
+                }
+
+                buttons.clear();
+                buttonIndex.assign(events.size(), 0);
+                for (std::size_t i = 0; i < events.size(); ++i) {
+                    const auto& ev = events[i];
+                    if (ev.type != Fmt::EventType::Button) continue;
+                    buttonIndex[i] = buttons.size();
+                    buttons.push_back(ToButton(ev.dev, ev.idCode, ev.userEvent, ev.a, ev.b, flags));
+                }
+
+                const auto t0 = std::chrono::steady_clock::now();
+                Host::RunFrame(dt, buttons, out, (flags & Fmt::kBlockedByMenus) != 0);
+                report.frameUs.push_back(
+                    std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+
+                for (std::size_t i = 0; i < events.size(); ++i) {
+                    const auto& ev = events[i];
+                    const bool isButton = ev.type == Fmt::EventType::Button;
+                    const bool kept = Survives(ev.type, flags, !isButton || out.kept[buttonIndex[i]] != 0);
+                    report.dropped += !kept;
+                    if (kept == ev.kept) continue;
+                    if (++report.mismatches <= 10) {
+                        std::fprintf(stderr,
+                                     "input_replay: frame %llu event %zu (type=%u dev=%u id=%#x value=%.2f held=%.3f "
+                                     "'%s'): recorded %s, replay %s\n",
+                                     static_cast<unsigned long long>(report.frames), i, static_cast<unsigned>(ev.type),
+                                     static_cast<unsigned>(ev.dev), ev.idCode, ev.a, ev.b, ev.userEvent.c_str(),
+                                     ev.kept ? "kept" : "dropped", kept ? "kept" : "dropped");
+                    }
+                }
+                report.events += events.size();
+                ++report.frames;
+            }
+            return true;
+        }
+
+        struct SessionKey {
+            RE::INPUT_DEVICE dev;
+            std::uint32_t idCode;
+            const char* userEvent;
+        };
+
+        constexpr std::array kSessionKeys{
+            SessionKey{RE::INPUT_DEVICE::kKeyboard, 0x2A, "Sprint"},
+            SessionKey{RE::INPUT_DEVICE::kKeyboard, 0x10, "Favorites"},
+            SessionKey{RE::INPUT_DEVICE::kKeyboard, 0x12, "Activate"},
+            SessionKey{RE::INPUT_DEVICE::kKeyboard, 0x30, ""},
+            SessionKey{RE::INPUT_DEVICE::kKeyboard, kDIK_W, "Forward"},
+            SessionKey{RE::INPUT_DEVICE::kMouse, 0, "Right Attack/Block"},
+            SessionKey{RE::INPUT_DEVICE::kMouse, 2, ""},
+            SessionKey{RE::INPUT_DEVICE::kGamepad, static_cast<std::uint32_t>(Key::kLeftShoulder), "Left Attack/Block"},
+            SessionKey{RE::INPUT_DEVICE::kGamepad, static_cast<std::uint32_t>(Key::kA), "Activate"},
+            SessionKey{RE::INPUT_DEVICE::kGamepad, static_cast<std::uint32_t>(Key::kB), "Tween Menu"},
+        };
+
+        void SetInput(InputConfig& in, std::array<int, 3> kb, std::array<int, 3> gp) {
+            in.KeyboardScanCode1 = kb[0];
+            in.KeyboardScanCode2 = kb[1];
+            in.KeyboardScanCode3 = kb[2];
+            in.GamepadButton1 = gp[0];
+            in.GamepadButton2 = gp[1];
+            in.GamepadButton3 = gp[2];
+            in.Trigger = static_cast<int>(HotkeyTrigger::Chord);
+        }
+
+        void ConfigureSession() {
+            auto& cfg = GetMagicConfig();
+            cfg.slotCount.store(3, std::memory_order_relaxed);
+            cfg.requireExclusiveHotkeyPatch = true;
+            cfg.pressBothAtSamePatch = false;
+            cfg.speculativePreEquipPatch = false;
+            cfg.modifierKeyboardPosition = 0;
+            cfg.modifierGamepadPosition = 0;
+            SetInput(cfg.slotInput[0], {0x2A, 0x10, -1}, {8, 10, -1});
+            SetInput(cfg.slotInput[1], {0x2A, 0x12, -1}, {8, 11, -1});
+            SetInput(cfg.slotInput[2], {kMouseButtonBase + 2, -1, -1}, {-1, -1, -1});
+            SetInput(cfg.hudPopupInput, {-1, -1, -1}, {-1, -1, -1});
+            SetInput(cfg.bankCycleInput, {0x2A, 0x30, -1}, {-1, -1, -1});
+        }
+
+        // Plays a random session through the real recorder, with the same filtering Replay models, and leaves every
+        // key released so a replay starts from the state the recording did.
+        bool RecordSession(std::uint64_t frames, std::uint64_t seed) {
+            std::mt19937_64 rng(seed);
+            const auto chance = [&rng](double p) { return std::bernoulli_distribution(p)(rng); };
+            std::array<float, kSessionKeys.size()> held{};
+            held.fill(-1.f);
+
+            ConfigureSession();
+            Host::ResetInput();
+            GetMagicConfig().recordInputTrace = true;
+
+            std::vector<RE::InputEvent*> chain;
+            std::vector<RE::ButtonEvent> presses;
+            std::vector<RE::MouseMoveEvent> moves;
+            std::vector<Host::Button> buttons;
+            Host::FrameOutput out;
+            std::uint8_t flags = 0;
+            for (std::uint64_t f = 0; f < frames; ++f) {
+                const bool winding = f + 120 >= frames;
+                const float dt = 1.f / 60.f * std::uniform_real_distribution<float>(0.5f, 1.5f)(rng);
+                if (!winding && chance(0.004)) flags ^= Fmt::kBlockedByMenus;
+                if (!winding && chance(0.002)) flags ^= Fmt::kDetailPopupOpen;
+                if (!winding && chance(0.001)) flags ^= Fmt::kHotkeyCapture;
+                if (winding) flags = 0;
+
+                chain.clear();
+                presses.clear();
+                presses.reserve(kSessionKeys.size());
+                moves.clear();
+                moves.reserve(2);
+                buttons.clear();
+                for (std::size_t k = 0; k < kSessionKeys.size(); ++k) {
+                    const auto& key = kSessionKeys[k];
+                    float value = 1.f;
+                    if (held[k] < 0.f) {
+                        if (winding || !chance(0.03)) continue;
+                        held[k] = 0.f;
+                    } else if (winding || chance(0.08)) {
+                        value = 0.f;
+                        held[k] += dt;
+                    } else {
+                        held[k] += dt;
+                    }
+                    auto& be = presses.emplace_back();
+                    be.device = key.dev;
+                    be.eventType = RE::INPUT_EVENT_TYPE::kButton;
+                    be.userEvent = key.userEvent;
+                    be.idCode = key.idCode;
+                    be.value = value;
+                    be.heldDownSecs = held[k];
+                    chain.push_back(&be);
+                    buttons.push_back(ToButton(key.dev, key.idCode, key.userEvent, value, held[k], flags));
+                    if (value == 0.f) held[k] = -1.f;
+                }
+                if (chance(0.3)) {
+                    auto& mm = moves.emplace_back();
+                    mm.device = RE::INPUT_DEVICE::kMouse;
+                    mm.eventType = RE::INPUT_EVENT_TYPE::kMouseMove;
+                    mm.userEvent = "Look";
+                    mm.mouseInputX = std::uniform_int_distribution<int>(-20, 20)(rng);
+                    mm.mouseInputY = std::uniform_int_distribution<int>(-20, 20)(rng);
+                    chain.insert(chain.begin() + static_cast<std::ptrdiff_t>(rng() % (chain.size() + 1)), &mm);
+                }
+                for (std::size_t i = 0; i < chain.size(); ++i)
+                    chain[i]->next = i + 1 < chain.size() ? chain[i + 1] : nullptr;
+
+                Input::detail::BeginInputTraceFrame(chain.empty() ? nullptr : chain.front(), dt, flags);
+                Host::RunFrame(dt, buttons, out, (flags & Fmt::kBlockedByMenus) != 0);
+
+                RE::InputEvent* keptHead = nullptr;
+                RE::InputEvent** link = &keptHead;
+                std::size_t b = 0;
+                for (auto* e : chain) {
+                    const auto type = e->AsButtonEvent() ? Fmt::EventType::Button : Fmt::EventType::MouseMove;
+                    const bool filterKept = type != Fmt::EventType::Button || out.kept[b++] != 0;
+                    if (!Survives(type, flags, filterKept)) continue;
+                    *link = e;
+                    link = &e->next;
+                }
+                *link = nullptr;
+                Input::detail::EndInputTraceFrame(keptHead);
+            }
+
+            GetMagicConfig().recordInputTrace = false;
+            Input::detail::BeginInputTraceFrame(nullptr, 0.f, 0);
+            if (Host::RetainedOutstanding() != 0 || g_kbDown.Count() != 0 || g_gpDown.Count() != 0) {
+                std::fprintf(stderr, "input_replay: recorded session did not wind down\n");
+                return false;
+            }
+            return true;
+        }
+
+        constexpr std::uint64_t kSessionFrames = 20'000;
+
+        double Percentile(std::vector<double> v, double p) {
+            if (v.empty()) return 0.0;
+            const auto i = static_cast<std::size_t>(p * static_cast<double>(v.size() - 1));
+            std::ranges::nth_element(v, v.begin() + static_cast<std::ptrdiff_t>(i));
+            return v[i];
+        }
+    }
+
+    // input_replay [trace]: replays a recorded IntegratedMagic_InputTrace.bin and reports decisions that differ from
+    // the recording plus the time spent per frame. Without a trace it records a generated session first.
+    int InputReplay(Args args) {
+        std::filesystem::path path;
+        if (!args.empty()) {
+            path = args[0];
+        } else {
+            if (!RecordSession(kSessionFrames, 0x7EACE)) return 1;
+            path = GetThisDllDir() / "IntegratedMagic_InputTrace.bin";
+        }
+
+        ReplayReport report;
+        if (!Replay(path, report)) return 1;
+
+        double total = 0.0;
+        for (const auto us : report.frameUs) total += us;
+        std::printf("input_replay: %s\n", path.string().c_str());
+        std::printf("input_replay: frames=%llu events=%llu dropped=%llu mismatches=%llu\n",
+                    static_cast<unsigned long long>(report.frames), static_cast<unsigned long long>(report.events),
+                    static_cast<unsigned long long>(report.dropped),
+                    static_cast<unsigned long long>(report.mismatches));
+        if (!report.frameUs.empty()) {
+            std::printf("input_replay: us/frame mean=%.2f p50=%.2f p99=%.2f max=%.2f\n",
+                        total / static_cast<double>(report.frameUs.size()), Percentile(report.frameUs, 0.5),
+                        Percentile(report.frameUs, 0.99), *std::ranges::max_element(report.frameUs));
+        }
+        return report.mismatches == 0 ? 0 : 1;
+    }
+}
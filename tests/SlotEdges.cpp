@@ -0,0 +1,96 @@
+#include <chrono>
+#include <cstdio>
+
+#include "Config/Config.h"
+#include "HostTests.h"
+#include "Input/ChordMachine.h"
+#include "Input/ExclusivePending.h"
+#include "Input/InputState.h"
+#include "InputDriver.h"
+#include "PCH.h"
+
+namespace IntegratedMagic::HostTests {
+    namespace {
+        using namespace Input::detail;
+
+        constexpr int kModifier = 0x1D;
+        constexpr int kFirstKey = 0x02;
+
+        void SetKey(int code, bool down) {
+            if (g_kbDown.Store(code, down)) StepChordMachine(RE::INPUT_DEVICE::kKeyboard, code, down);
+        }
+
+        void SetChord(int slot, bool down) {
+            SetKey(kModifier, down);
+            SetKey(kFirstKey + slot, down);
+        }
+
+        // Every slot gets its own two-key keyboard chord sharing one modifier, so each recompute runs the exclusive
+        // path for all 64 slots.
+        void Configure(bool exclusive) {
+            auto& cfg = GetMagicConfig();
+            cfg.slotCount.store(MagicConfig::kMaxSlots, std::memory_order_relaxed);
+            cfg.requireExclusiveHotkeyPatch = exclusive;
+            cfg.pressBothAtSamePatch = false;
+            cfg.speculativePreEquipPatch = false;
+            cfg.modifierKeyboardPosition = 0;
+            cfg.modifierGamepadPosition = 0;
+            for (std::size_t s = 0; s < MagicConfig::kMaxSlots; ++s) {
+                auto& in = cfg.slotInput[s];
+                in.KeyboardScanCode1 = kModifier;
+                in.KeyboardScanCode2 = kFirstKey + static_cast<int>(s);
+                in.KeyboardScanCode3 = -1;
+                in.GamepadButton1 = -1;
+                in.GamepadButton2 = -1;
+                in.GamepadButton3 = -1;
+                in.Trigger = static_cast<int>(HotkeyTrigger::Chord);
+            }
+            Host::ResetInput();
+        }
+
+        template <class Step>
+        double NsPerCall(std::uint64_t iterations, Step&& step) {
+            const auto t0 = std::chrono::steady_clock::now();
+            for (std::uint64_t i = 0; i < iterations; ++i) {
+                step(i);
+                RecomputeSlotEdges();
+                g_pressedMask.store(0, std::memory_order_relaxed);
+                g_releasedMask.store(0, std::memory_order_relaxed);
+            }
+            const auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+            return ns / static_cast<double>(iterations);
+        }
+
+        void Run(const char* name, std::uint64_t iterations, bool exclusive) {
+            Configure(exclusive);
+            const double idle = NsPerCall(iterations, [](std::uint64_t) {});
+
+            SetChord(5, true);
+            const double held = NsPerCall(iterations, [](std::uint64_t) {});
+            SetChord(5, false);
+            RecomputeSlotEdges();
+
+            const double churn = NsPerCall(iterations, [](std::uint64_t i) {
+                const auto slot = static_cast<int>((i / 2) % MagicConfig::kMaxSlots);
+                SetChord(slot, (i & 1) == 0);
+            });
+
+            std::printf("slot_edges: %-9s idle=%.1f held=%.1f churn=%.1f ns/call\n", name, idle, held, churn);
+        }
+    }
+
+    // slot_edges [iterations]: times RecomputeSlotEdges over 64 configured slots with nothing held, with one chord
+    // held and with a chord pressed or released before every call.
+    int SlotEdges(Args args) {
+        const auto iterations = ArgOr(args, 0, 100'000);
+        std::printf("slot_edges: slots=%u iterations=%llu sizeof(SlotInputState)=%zu sizeof(ReplayState)=%zu\n",
+                    MagicConfig::kMaxSlots, static_cast<unsigned long long>(iterations), sizeof(SlotInputState),
+                    sizeof(ReplayState));
+
+        const auto warnings = spdlog::host::g_warnings.load();
+        Run("plain", iterations, false);
+        Run("exclusive", iterations, true);
+        Configure(false);
+        return spdlog::host::g_warnings.load() == warnings ? 0 : 1;
+    }
+}
@@ -0,0 +1,169 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "HostTests.h"
+#include "PCH.h"
+#include "State/SyntheticInput.h"
+
+namespace IntegratedMagic::HostTests {
+    namespace {
+        namespace SI = IntegratedMagic::detail;
+
+        constexpr std::size_t kRingCapacity = 256;
+        constexpr std::uint64_t kMaxInFlight = kRingCapacity * 3 / 4;
+
+        enum class Stream : std::size_t { Retained = 0, Synthetic = 1, kCount };
+
+        const RE::BSFixedString kSynthEvent{"Host Synthetic"};
+        const RE::BSFixedString kRetainedEvent{"Host Retained"};
+
+        // Producer i tags its events with value i + 1 and uses heldSecs as a per-producer sequence number, so the
+        // consumer can check FIFO order per producer and stream whichever path an event took.
+        void Produce(std::size_t producer, std::uint64_t count, std::atomic<std::uint64_t>& pushed,
+                     const std::atomic<std::uint64_t>& consumed) {
+            const auto tag = static_cast<float>(producer + 1);
+            for (std::uint64_t k = 0; k < count; ++k) {
+                while (pushed.load(std::memory_order_relaxed) - consumed.load(std::memory_order_relaxed) >=
+                       kMaxInFlight)
+                    std::this_thread::yield();
+                const auto seq = static_cast<float>(k + 1);
+                switch (k % 4) {
+                    case 0:
+                        SI::EnqueueSyntheticAttack(
+                            RE::ButtonEvent::Create(RE::INPUT_DEVICE::kMouse, kSynthEvent, 0, tag, seq));
+                        break;
+                    case 1:
+                        SI::DispatchAttack((producer & 1) ? Slots::Hand::Left : Slots::Hand::Right, tag, seq);
+                        break;
+                    case 2:
+                        SI::DispatchShout(tag, seq);
+                        break;
+                    default:
+                        SI::EnqueueRetainedEvent(RE::INPUT_DEVICE::kGamepad, 0, kRetainedEvent, tag, seq);
+                        break;
+                }
+                pushed.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        class Consumer {
+        public:
+            explicit Consumer(std::size_t producers) : _last(producers) {}
+
+            bool Drain() {
+                const auto* head = SI::FlushSyntheticInput(nullptr);
+                bool synthSeen = false;
+                for (const auto* e = head; e; e = e->next) {
+                    const auto* btn = e->AsButtonEvent();
+                    if (!btn) return Fail("non-button event in the synthetic chain");
+                    const bool retained = btn->GetDevice() == RE::INPUT_DEVICE::kGamepad;
+                    if (retained && synthSeen) return Fail("retained event flushed after a synthetic one");
+                    synthSeen = synthSeen || !retained;
+
+                    const auto producer = static_cast<std::size_t>(btn->Value()) - 1;
+                    if (producer >= _last.size()) return Fail("event from an unknown producer");
+                    auto& last = _last[producer][static_cast<std::size_t>(retained ? Stream::Retained
+                                                                                  : Stream::Synthetic)];
+                    const auto seq = static_cast<std::uint64_t>(btn->HeldDuration());
+                    if (seq <= last) {
+                        std::fprintf(stderr, "synthetic_ring: producer %zu %s seq %llu after %llu\n", producer,
+                                     retained ? "retained" : "synthetic", static_cast<unsigned long long>(seq),
+                                     static_cast<unsigned long long>(last));
+                        return false;
+                    }
+                    last = seq;
+                    ++_received;
+                }
+                SI::RecycleSyntheticInput();
+                return true;
+            }
+
+            [[nodiscard]] std::uint64_t Received() const { return _received; }
+
+        private:
+            static bool Fail(const char* what) {
+                std::fprintf(stderr, "synthetic_ring: %s\n", what);
+                return false;
+            }
+
+            std::vector<std::array<std::uint64_t, static_cast<std::size_t>(Stream::kCount)>> _last;
+            std::uint64_t _received{0};
+        };
+
+        bool CheckOverflowCounted() {
+            const auto before = SI::SyntheticInputOverflowCount();
+            const auto warnings = spdlog::host::g_warnings.load();
+            constexpr std::size_t kExtra = 3;
+            for (std::size_t i = 0; i < kRingCapacity + kExtra; ++i)
+                SI::EnqueueSyntheticAttack(RE::ButtonEvent::Create(RE::INPUT_DEVICE::kMouse, kSynthEvent, 0, 1.f, 1.f));
+
+            std::size_t flushed = 0;
+            for (const auto* e = SI::FlushSyntheticInput(nullptr); e; e = e->next) ++flushed;
+            SI::RecycleSyntheticInput();
+
+            const auto dropped = SI::SyntheticInputOverflowCount() - before;
+            if (flushed != kRingCapacity || dropped != kExtra || spdlog::host::g_warnings.load() != warnings) {
+                std::fprintf(stderr, "synthetic_ring: full ring flushed %zu, dropped %llu; expected %zu and %zu\n",
+                             flushed, static_cast<unsigned long long>(dropped), kRingCapacity, kExtra);
+                return false;
+            }
+            return true;
+        }
+    }
+
+    int SyntheticRing(Args args) {
+        const auto producers = static_cast<std::size_t>(ArgOr(args, 0, 4));
+        const auto perProducer = ArgOr(args, 1, 250'000);
+        std::printf("synthetic_ring: producers=%zu events/producer=%llu\n", producers,
+                    static_cast<unsigned long long>(perProducer));
+
+        if (!CheckOverflowCounted()) return 1;
+        const auto overflowBefore = SI::SyntheticInputOverflowCount();
+
+        std::atomic<std::uint64_t> pushed{0};
+        std::atomic<std::uint64_t> consumed{0};
+        Consumer consumer(producers);
+        const auto t0 = std::chrono::steady_clock::now();
+
+        std::vector<std::jthread> threads;
+        threads.reserve(producers);
+        for (std::size_t i = 0; i < producers; ++i)
+            threads.emplace_back([i, perProducer, &pushed, &consumed] { Produce(i, perProducer, pushed, consumed); });
+
+        const auto total = producers * perProducer;
+        bool ok = true;
+        while (ok && consumer.Received() < total) {
+            const auto before = consumer.Received();
+            ok = consumer.Drain();
+            consumed.store(consumer.Received(), std::memory_order_relaxed);
+            if (consumer.Received() == before) std::this_thread::yield();
+            if (SI::SyntheticInputOverflowCount() != overflowBefore) {
+                std::fprintf(stderr, "synthetic_ring: ring overflowed below its in-flight limit\n");
+                ok = false;
+            }
+        }
+        if (!ok) consumed.store(~0uLL >> 1, std::memory_order_relaxed);
+        threads.clear();
+
+        const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        for (const auto pool : {SI::SyntheticPool::Dispatch, SI::SyntheticPool::Retained}) {
+            const auto stats = SI::GetSyntheticPoolStats(pool);
+            const auto* name = pool == SI::SyntheticPool::Retained ? "retained" : "dispatch";
+            std::printf("synthetic_ring: %s pool hits=%llu misses=%llu outstanding=%u\n", name,
+                        static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses),
+                        stats.outstanding);
+            if (ok && stats.outstanding != 0) {
+                std::fprintf(stderr, "synthetic_ring: %u %s event(s) never recycled\n", stats.outstanding, name);
+                ok = false;
+            }
+        }
+        std::printf("synthetic_ring: received=%llu in %.3fs, %.0f events/s\n",
+                    static_cast<unsigned long long>(consumer.Received()), secs,
+                    static_cast<double>(consumer.Received()) / secs);
+        return ok ? 0 : 1;
+    }
+}
@@ -0,0 +1,37 @@
+#include <array>
+#include <cstdio>
+#include <span>
+#include <string_view>
+
+#include "HostTests.h"
+
+namespace {
+    struct Case {
+        std::string_view name;
+        int (*run)(IntegratedMagic::HostTests::Args);
+    };
+
+    constexpr std::array kCases{
+        Case{"hand_machine", IntegratedMagic::HostTests::HandMachineCase},
+        Case{"input_fuzz", IntegratedMagic::HostTests::InputFuzz},
+        Case{"input_replay", IntegratedMagic::HostTests::InputReplay},
+        Case{"slot_edges", IntegratedMagic::HostTests::SlotEdges},
+        Case{"synthetic_ring", IntegratedMagic::HostTests::SyntheticRing},
+    };
+}
+
+int main(int argc, char** argv) {
+    const std::span<char* const> args(argv, static_cast<std::size_t>(argc));
+    if (args.size() < 2) {
+        int failed = 0;
+        for (const auto& c : kCases) failed += c.run({}) != 0;
+        return failed;
+    }
+    for (const auto& c : kCases) {
+        if (c.name == args[1]) return c.run(args.subspan(2));
+    }
+    std::fprintf(stderr, "unknown case '%s'; available:", args[1]);
+    for (const auto& c : kCases) std::fprintf(stderr, " %.*s", static_cast<int>(c.name.size()), c.name.data());
+    std::fprintf(stderr, "\n");
+    return 2;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <filesystem>
+
+namespace IntegratedMagic {
+    inline const std::filesystem::path& GetThisDllDir() {
+        static const std::filesystem::path cached = std::filesystem::temp_directory_path();
+        return cached;
+    }
+}
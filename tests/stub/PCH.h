@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace RE {
+    using FormID = std::uint32_t;
+
+    enum class INPUT_DEVICE : std::uint32_t {
+        kNone = static_cast<std::uint32_t>(-1),
+        kKeyboard = 0,
+        kMouse,
+        kGamepad,
+        kVirtualKeyboard,
+        kTotal
+    };
+
+    class BSFixedString {
+    public:
+        BSFixedString() = default;
+        BSFixedString(const char* s) : _s(s ? s : "") {}
+        BSFixedString(std::string_view s) : _s(s) {}
+        BSFixedString(const std::string& s) : _s(s) {}
+
+        [[nodiscard]] const char* c_str() const noexcept { return _s.c_str(); }
+        [[nodiscard]] bool empty() const noexcept { return _s.empty(); }
+
+        friend bool operator==(const BSFixedString&, const BSFixedString&) = default;
+        friend bool operator==(const BSFixedString& a, std::string_view b) { return a._s == b; }
+
+    private:
+        std::string _s;
+    };
+
+    enum class INPUT_EVENT_TYPE : std::uint32_t {
+        kButton = 0,
+        kMouseMove,
+        kChar,
+        kThumbstick,
+        kDeviceConnect,
+        kKinect,
+        kNone
+    };
+
+    class TESForm;
+    class ButtonEvent;
+
+    class InputEvent {
+    public:
+        virtual ~InputEvent() = default;
+
+        [[nodiscard]] INPUT_DEVICE GetDevice() const noexcept { return device; }
+        [[nodiscard]] const ButtonEvent* AsButtonEvent() const noexcept;
+
+        INPUT_DEVICE device{INPUT_DEVICE::kNone};
+        INPUT_EVENT_TYPE eventType{INPUT_EVENT_TYPE::kNone};
+        InputEvent* next{nullptr};
+    };
+
+    class IDEvent : public InputEvent {
+    public:
+        [[nodiscard]] const BSFixedString& QUserEvent() const noexcept { return userEvent; }
+        [[nodiscard]] std::uint32_t GetIDCode() const noexcept { return idCode; }
+
+        BSFixedString userEvent;
+        std::uint32_t idCode{0};
+    };
+
+    class ButtonEvent : public IDEvent {
+    public:
+        // Defined by the host test target. Like the game's, the event is released with destroy_at and RE::free.
+        static ButtonEvent* Create(INPUT_DEVICE a_device, const BSFixedString& a_userEvent, std::uint32_t a_idCode,
+                                   float a_value, float a_heldDownSecs);
+
+        [[nodiscard]] float Value() const noexcept { return value; }
+        [[nodiscard]] float HeldDuration() const noexcept { return heldDownSecs; }
+        [[nodiscard]] bool IsDown() const noexcept { return value > 0.f && heldDownSecs == 0.f; }
+        [[nodiscard]] bool IsUp() const noexcept { return value == 0.f && heldDownSecs > 0.f; }
+
+        float value{0.f};
+        float heldDownSecs{0.f};
+    };
+
+    class MouseMoveEvent : public IDEvent {
+    public:
+        std::int32_t mouseInputX{0};
+        std::int32_t mouseInputY{0};
+    };
+
+    class ThumbstickEvent : public IDEvent {
+    public:
+        [[nodiscard]] bool IsLeft() const noexcept { return idCode == 0x0B; }
+
+        float xValue{0.f};
+        float yValue{0.f};
+    };
+
+    class BSWin32GamepadDevice {
+    public:
+        enum class Key : std::uint32_t {
+            kUp = 0x0001,
+            kDown = 0x0002,
+            kLeft = 0x0004,
+            kRight = 0x0008,
+            kStart = 0x0010,
+            kBack = 0x0020,
+            kLeftThumb = 0x0040,
+            kRightThumb = 0x0080,
+            kLeftShoulder = 0x0100,
+            kRightShoulder = 0x0200,
+            kA = 0x1000,
+            kB = 0x2000,
+            kX = 0x4000,
+            kY = 0x8000,
+            kLeftTrigger = 0x0009,
+            kRightTrigger = 0x000A,
+        };
+    };
+
+    inline const ButtonEvent* InputEvent::AsButtonEvent() const noexcept {
+        return eventType == INPUT_EVENT_TYPE::kButton ? static_cast<const ButtonEvent*>(this) : nullptr;
+    }
+
+    inline void free(void* a_ptr) noexcept { std::free(a_ptr); }
+}
+
+namespace spdlog {
+    namespace host {
+        inline std::atomic<std::uint64_t> g_warnings{0};
+        inline std::atomic<bool> g_verbose{false};
+
+        template <class... Args>
+        void Write(const char* level, std::format_string<Args...> fmt, Args&&... args) {
+            const auto line = std::vformat(fmt.get(), std::make_format_args(args...));
+            std::fprintf(stderr, "[%s] %s\n", level, line.c_str());
+        }
+    }
+
+    template <class... Args>
+    void info(std::format_string<Args...> fmt, Args&&... args) {
+        if (host::g_verbose.load(std::memory_order_relaxed)) host::Write("info", fmt, std::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    void warn(std::format_string<Args...> fmt, Args&&... args) {
+        host::g_warnings.fetch_add(1, std::memory_order_relaxed);
+        host::Write("warn", fmt, std::forward<Args>(args)...);
+    }
+
+    template <class... Args>
+    void error(std::format_string<Args...> fmt, Args&&... args) {
+        host::g_warnings.fetch_add(1, std::memory_order_relaxed);
+        host::Write("error", fmt, std::forward<Args>(args)...);
+    }
+}
+
+using namespace std::literals;
+
+#define DEBUG
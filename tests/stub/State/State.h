@@ -0,0 +1,18 @@
+#pragma once
+
+namespace IntegratedMagic {
+    class MagicState {
+    public:
+        static MagicState& Get() {
+            static MagicState s;
+            return s;
+        }
+
+        void PreEquipSlot(int slot) { _preEquipSlot = slot; }
+        void CancelPreEquip() { _preEquipSlot = -1; }
+        int PreEquippedSlot() const noexcept { return _preEquipSlot; }
+
+    private:
+        int _preEquipSlot{-1};
+    };
+}
@@ -0,0 +1,22 @@
+#include <cstdio>
+#include <filesystem>
+
+#include "Diagnostics/FlightRecorder.h"
+
+// Turns an IntegratedMagic_FlightRecorder.bin dump into the timeline the plugin writes next to it.
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::fprintf(stderr, "usage: flightdecode <dump.bin> [timeline.txt]\n");
+        return 2;
+    }
+    const std::filesystem::path dump = argv[1];
+    auto timeline = (argc == 3) ? std::filesystem::path(argv[2]) : dump;
+    if (argc == 2) timeline.replace_extension(".txt");
+
+    if (!IntegratedMagic::FlightRecorder::Decode(dump, timeline)) {
+        std::fprintf(stderr, "flightdecode: could not decode %s\n", dump.string().c_str());
+        return 1;
+    }
+    std::printf("%s\n", timeline.string().c_str());
+    return 0;
+}